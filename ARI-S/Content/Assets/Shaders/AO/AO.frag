@@ -3,9 +3,10 @@
 out vec4 fragColor;
 in vec2 texCoords;
 
-layout (binding = 0) uniform sampler2D gPos;
-layout (binding = 1) uniform sampler2D gNorm;
-layout (binding = 2) uniform sampler2D gDepth;
+layout (binding = 0) uniform sampler2D gNorm;
+layout (binding = 1) uniform sampler2D gDepth;
+
+uniform mat4 invViewProj;
 
 uniform float aoScale;
 uniform float aoContrast;
@@ -17,6 +18,24 @@ uniform int vHeight;
 
 const float PI = 3.14159265359f;
 
+vec3 DecodeNormal(vec2 e)
+{
+	e = e * 2.0f - 1.0f;
+	vec3 n = vec3(e, 1.0f - abs(e.x) - abs(e.y));
+	
+	float t = max(-n.z, 0.0f);
+	n.x += n.x >= 0.0f ? -t : t;
+	n.y += n.y >= 0.0f ? -t : t;
+	
+	return normalize(n);
+}
+
+vec3 WorldPosFromDepth(vec2 uv, float depth)
+{
+	vec4 world = invViewProj * vec4(vec3(uv, depth) * 2.0f - 1.0f, 1.0f);
+	return world.xyz / world.w;
+}
+
 int Heaviside(float val)
 {
 	return val <= 0 ? 0 : 1;
@@ -39,7 +58,7 @@ float CalculateAO(vec2 coords, vec2 floatCoords, vec3 pos, vec3 norm, float dept
 		vec2 read = vec2(cos(theta), sin(theta)) * h;
 		vec2 readFrom = floatCoords + read;
 		
-		vec3 pI = texture(gPos, readFrom).rgb;
+		vec3 pI = WorldPosFromDepth(readFrom, texture(gDepth, readFrom).r);
 		
 		// ----
 		
@@ -66,9 +85,9 @@ void main()
 	vec2 uv = vec2(gl_FragCoord.x / vWidth, 
 					gl_FragCoord.y / vHeight);
 	
-	vec3 fragPos = texture(gPos, uv).rgb;
-	vec3 norm = texture(gNorm, uv).rgb;
 	float depth = texture(gDepth, uv).r;
+	vec3 fragPos = WorldPosFromDepth(uv, depth);
+	vec3 norm = DecodeNormal(texture(gNorm, uv).rg);
 	
 	float occlusion = CalculateAO(coords, uv, fragPos, norm, depth);
 	float finalAO = max(0.0f, pow(1 - (aoScale * occlusion), aoContrast));
@@ -1,15 +1,14 @@
 #version 430 core
-layout (location = 0) out vec3 gPos;
-layout (location = 1) out vec3 gNorm;
-layout (location = 2) out vec3 gAlbedo;
-layout (location = 3) out vec2 gMetRough;
-layout (location = 4) out float entID;
-layout (location = 5) out float gDepth;
+// Position isn't stored; the lighting passes rebuild it from the depth buffer
+layout (location = 0) out vec2 gNorm;
+layout (location = 1) out vec4 gAlbedo;
+layout (location = 2) out vec2 gMetRough;
+layout (location = 3) out uint entID;
 
 in vec3 outPos;
 in vec3 outNorm;
 in vec2 outTexCoord;
-in float vEntityID;
+flat in uint vEntityID;
 in vec4 viewPos;
 
 uniform int metRoughCombine;
@@ -26,12 +25,27 @@ uniform sampler2D metalRoughTex1;
 uniform sampler2D metalTex1;
 uniform sampler2D roughTex1;
 
+// Octahedral normal, remapped to [0, 1] for the RG16 unorm target
+vec2 EncodeNormal(vec3 n)
+{
+	n /= abs(n.x) + abs(n.y) + abs(n.z);
+	
+	if (n.z < 0.0f)
+	{
+		vec2 signs = vec2(n.x >= 0.0f ? 1.0f : -1.0f, n.y >= 0.0f ? 1.0f : -1.0f);
+		n.xy = (1.0f - abs(n.yx)) * signs;
+	}
+	
+	return n.xy * 0.5f + 0.5f;
+}
+
 void main()
 {
-	gPos = outPos;
-	gNorm = normalize(outNorm);
+	gNorm = EncodeNormal(normalize(outNorm));
 	//gUVs = outTexCoord;
-	gAlbedo = texture(diffTex1, outTexCoord).rgb;
+	
+	// sRGB target, encoded by GL_FRAMEBUFFER_SRGB on write
+	gAlbedo = vec4(texture(diffTex1, outTexCoord).rgb, 1.0f);
 	
 	if (controllable == 1)
 	{
@@ -56,6 +70,4 @@ void main()
 	
 	//gSpecular = texture(specTex, outTexCoord).rrr;
 	entID = vEntityID;
-	
-	gDepth = gl_FragCoord.z;
 }
\ No newline at end of file
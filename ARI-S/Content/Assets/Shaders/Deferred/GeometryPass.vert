@@ -3,12 +3,15 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormals;
 layout (location = 2) in vec2 aTexCoords;
-layout (location = 3) in float aEntityID;
+
+// per-instance data (instanced path only)
+layout (location = 7) in mat4 aInstanceModel;
+layout (location = 11) in uint aInstanceID;
 
 out vec3 outPos;
 out vec3 outNorm;
 out vec2 outTexCoord;
-out float vEntityID;
+flat out uint vEntityID;
 
 out vec4 viewPos;
 
@@ -16,12 +19,17 @@ uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
+uniform bool instanced;
+uniform int entityID;
+
 void main()
 {
-	vec4 worldPos = model * vec4(aPos, 1.0f);
+	mat4 modelMat = instanced ? aInstanceModel : model;
+
+	vec4 worldPos = modelMat * vec4(aPos, 1.0f);
 	outPos = worldPos.xyz;
 	
-	mat3 normalMat = transpose(inverse(mat3(model)));
+	mat3 normalMat = transpose(inverse(mat3(modelMat)));
 	outNorm = normalMat * aNormals;
 	
 	outTexCoord = aTexCoords;
@@ -29,5 +37,5 @@ void main()
 	gl_Position = projection * view * worldPos;
 	viewPos = view * vec4(aPos, 1.0f);
 	
-	vEntityID = aEntityID;
+	vEntityID = instanced ? aInstanceID : uint(entityID);
 }
\ No newline at end of file
@@ -5,10 +5,34 @@ out vec4 fragColor;
 in vec3 worldPos;
 
 uniform samplerCube environmentMap;
+uniform bool displayIrradiance;
+
+layout(std140, binding = 5) uniform SphereHarmonics
+{
+  vec4 shColor[9];
+};
+
+const float PI = 3.14159265359f;
+
+// Same evaluation as the lighting pass
+vec3 EvaluateIrradianceSH(vec3 N)
+{
+	vec3 irr = shColor[0].rgb * 0.282094792f
+	         + shColor[1].rgb * 0.488602512f * N.y
+	         + shColor[2].rgb * 0.488602512f * N.z
+	         + shColor[3].rgb * 0.488602512f * N.x
+	         + shColor[4].rgb * 1.092548431f * N.x * N.y
+	         + shColor[5].rgb * 1.092548431f * N.y * N.z
+	         + shColor[6].rgb * 0.315391565f * (3.0f * N.z * N.z - 1.0f)
+	         + shColor[7].rgb * 1.092548431f * N.x * N.z
+	         + shColor[8].rgb * 0.546274215f * (N.x * N.x - N.y * N.y);
+	
+	return max(irr, vec3(0.0f)) / PI;
+}
 
 void main()
 {
-	vec3 color = texture(environmentMap, worldPos).rgb;
+	vec3 color = displayIrradiance ? EvaluateIrradianceSH(normalize(worldPos)) : texture(environmentMap, worldPos).rgb;
 	float e = 1.0f;
 	
 	//color = (e * color) / (e * color + vec3(1.0f));
@@ -240,7 +240,7 @@ vec3 LightCalc()
 
 	vec3 fragPos = texture(gPos, fragUV).rgb;
 	vec3 norm = texture(gNorm, fragUV).rgb;
-	vec3 diff = pow(texture(gAlbedo, fragUV).rgb, vec3(2.2f));
+	vec3 diff = texture(gAlbedo, fragUV).rgb; // sRGB textures decode to linear on sampling
 	float metal = texture(gMetRough, fragUV).r;
 	float rough = texture(gMetRough, fragUV).g;
 	float spec = texture(gDepth, fragUV).r;
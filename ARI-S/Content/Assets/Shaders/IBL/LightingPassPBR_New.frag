@@ -1,17 +1,24 @@
 layout (location = 0) out vec4 fragColor;
-layout (location = 1) out float entityID;
+layout (location = 1) out uint entityID;
 
-layout (binding = 0) uniform sampler2D gPos;
-layout (binding = 1) uniform sampler2D gNorm;
-layout (binding = 2) uniform sampler2D gAlbedo;
-layout (binding = 3) uniform sampler2D gMetRough;
-layout (binding = 4) uniform sampler2D gEntityID;
-layout (binding = 5) uniform sampler2D gDepth;
+layout (binding = 0) uniform sampler2D gNorm;
+layout (binding = 1) uniform sampler2D gAlbedo;
+layout (binding = 2) uniform sampler2D gMetRough;
+layout (binding = 3) uniform usampler2D gEntityID;
+layout (binding = 4) uniform sampler2D gDepth;
 
-uniform sampler2D uShadowMap;
-uniform mat4 worldToLightMat;
+// world position is rebuilt from gDepth
+uniform mat4 invViewProj;
+
+// Cascaded shadows (see ShadowCascades); one moments layer per cascade
+const int MaxCascades = 4;
+
+uniform sampler2DArray uShadowMap;
+uniform mat4 worldToLightMat[MaxCascades];
+uniform vec4 cascadeSplits; // view depth where each cascade ends
+uniform int cascadeCount;
+uniform bool showCascades;
 
-uniform samplerCube irradianceMap;
 uniform samplerCube filteredMap;
 uniform sampler2D brdfTable;
 
@@ -24,6 +31,116 @@ uniform vec3 viewPos;
 uniform int vWidth;
 uniform int vHeight;
 
+// Clustered point lights (see LightClusters; the grid constants must match)
+const uvec3 ClusterGrid = uvec3(16u, 9u, 24u);
+const uint MaxLightsPerCluster = 128u;
+
+struct PointLight
+{
+	vec4 posRange;
+	vec4 colorIntensity;
+};
+
+layout(std430, binding = 0) readonly buffer Lights
+{
+	PointLight lights[];
+};
+
+layout(std430, binding = 2) readonly buffer Counts
+{
+	uint lightCounts[];
+};
+
+layout(std430, binding = 3) readonly buffer Indices
+{
+	uint lightIndices[];
+};
+
+uniform bool useClusteredLights;
+uniform vec4 clusterSlices; // x = scale, y = bias (of log depth)
+
+uniform vec2 cameraPlanes; // near, far
+
+// ----------------------------------------------
+// G-BUFFER--------------------------------------
+vec3 DecodeNormal(vec2 e)
+{
+	e = e * 2.0f - 1.0f;
+	vec3 n = vec3(e, 1.0f - abs(e.x) - abs(e.y));
+	
+	float t = max(-n.z, 0.0f);
+	n.x += n.x >= 0.0f ? -t : t;
+	n.y += n.y >= 0.0f ? -t : t;
+	
+	return normalize(n);
+}
+
+vec3 WorldPosFromDepth(vec2 uv, float depth)
+{
+	vec4 world = invViewProj * vec4(vec3(uv, depth) * 2.0f - 1.0f, 1.0f);
+	return world.xyz / world.w;
+}
+
+float ViewDepth(float depth)
+{
+	float zNear = cameraPlanes.x;
+	float zFar = cameraPlanes.y;
+	
+	float ndcZ = depth * 2.0f - 1.0f;
+	return (2.0f * zNear * zFar) / (zFar + zNear - ndcZ * (zFar - zNear));
+}
+
+// ----------------------------------------------
+// CLUSTERED LIGHTS------------------------------
+uint ClusterIndex(vec2 uv, float viewDepth)
+{
+	uint slice = uint(max(log(viewDepth) * clusterSlices.x + clusterSlices.y, 0.0f));
+	uvec2 tile = uvec2(uv * vec2(ClusterGrid.xy));
+	
+	uvec3 cluster = min(uvec3(tile, slice), ClusterGrid - 1u);
+	return cluster.x + cluster.y * ClusterGrid.x + cluster.z * ClusterGrid.x * ClusterGrid.y;
+}
+
+// Same BRDF and falloff as the light volumes (LocalLightPBR.frag)
+vec3 PointLights(uint cluster, vec3 fragPos, vec3 N, vec3 V, vec3 albedo, float metal, float rough, vec3 F0)
+{
+	vec3 Lo = vec3(0.0f);
+	
+	uint count = lightCounts[cluster];
+	uint slot = cluster * MaxLightsPerCluster;
+	
+	for (uint i = 0u; i < count; ++i)
+	{
+		PointLight light = lights[lightIndices[slot + i]];
+		
+		vec3 toLight = light.posRange.xyz - fragPos;
+		float dist = length(toLight);
+		float range = light.posRange.w;
+		
+		if (dist > range)
+		{
+			continue;
+		}
+		
+		vec3 L = toLight / dist;
+		vec3 H = normalize(V + L);
+		
+		float att = (1.0f / (dist * dist)) - (1.0f / (range * range));
+		vec3 radiance = light.colorIntensity.rgb * att;
+		
+		float NDF = DistributionGGX(N, H, rough);
+		float G = GeometrySmith(N, V, L, rough);
+		vec3 F = FresnelSchlick(max(dot(H, V), 0.0f), F0);
+		
+		vec3 spec = (NDF * G * F) / (4.0f * max(dot(N, V), 0.0f) * max(dot(N, L), 0.0f) + 0.0001f);
+		vec3 kD = (vec3(1.0f) - F) * (1.0f - metal);
+		
+		Lo += (kD * albedo / PI + spec) * radiance * max(dot(N, L), 0.0f);
+	}
+	
+	return Lo;
+}
+
 // ----------------------------------------------
 // SHADOWS---------------------------------------
 vec2 Quadratic(float a, float b, float c)
@@ -78,9 +195,9 @@ vec3 Cholesky(float m11, float m12, float m13, float m22, float m23, float m33,
 	return vec3(c1, c2, c3);
 }
 
-float Shadow(vec4 v, float bias)
+float Shadow(vec4 v, int cascade, float bias)
 {
-	vec4 lightDepth = texture(uShadowMap, v.xy);
+	vec4 lightDepth = texture(uShadowMap, vec3(v.xy, float(cascade)));
 
 	vec4 b_ = (1.0f - bias) * lightDepth + bias * vec4(0.5f);
 	float pixelDepth = v.z;
@@ -126,7 +243,6 @@ uniform bool useOcclusion;
 uniform bool useDiffuse;
 uniform bool useToneMapping;
 
-uniform bool useSH;
 uniform bool useOldPBRMethod;
 
 uniform samplerCube envMap;
@@ -144,31 +260,21 @@ layout(std140, binding = 5) uniform SphereHarmonics
 
 // -----------------------------------------------------------------------------------------
 
-float EvaluateBasisFunction(vec3 N, int idx)
+// Irradiance from the 9 convolved SH coefficients (ordered l * (l + 1) + m)
+vec3 EvaluateIrradianceSH(vec3 N)
 {
-	switch (idx)
-	{
-	case 0:
-		return 0.5f * sqrt(1.0f / PI);
-	case 1:
-		return (0.5f * sqrt(3.0f / PI)) * N.y;
-	case 2:
-		return (0.5f * sqrt(3.0f / PI)) * N.z;
-	case 3:
-		return (0.5f * sqrt(3.0f / PI)) * N.x;
-	case 4:
-		return (0.5f * sqrt(15.0f / PI)) * N.x * N.y;
-	case 5:
-		return (0.5f * sqrt(15.0f / PI)) * N.y * N.z;
-	case 6:
-		return (0.25f * sqrt(5.0f / PI)) * (3.0f * N.z * N.z - 1.0f);
-	case 7:
-		return (0.5f * sqrt(15.0f / PI)) * N.x * N.z;
-	case 8:
-		return (0.25f * sqrt(15.0f / PI)) * (N.x * N.x - N.y * N.y);
-	}
-	
-    return 0.0f;
+	vec3 irr = shColor[0].rgb * 0.282094792f
+	         + shColor[1].rgb * 0.488602512f * N.y
+	         + shColor[2].rgb * 0.488602512f * N.z
+	         + shColor[3].rgb * 0.488602512f * N.x
+	         + shColor[4].rgb * 1.092548431f * N.x * N.y
+	         + shColor[5].rgb * 1.092548431f * N.y * N.z
+	         + shColor[6].rgb * 0.315391565f * (3.0f * N.z * N.z - 1.0f)
+	         + shColor[7].rgb * 1.092548431f * N.x * N.z
+	         + shColor[8].rgb * 0.546274215f * (N.x * N.x - N.y * N.y);
+	
+	// scaled by 1 / PI, the same scale the old convolved irradiance cubemap had
+	return max(irr, vec3(0.0f)) / PI;
 }
 
 vec3 MonteCarloApprox(vec3 N, vec3 V, vec3 R, vec3 A, vec3 B, float roughness, vec3 f0)
@@ -223,10 +329,12 @@ vec3 LightCalc()
 {
 	vec2 fragUV = vec2(gl_FragCoord.x / vWidth, gl_FragCoord.y / vHeight);
 
-	vec3 fragPos = texture(gPos, fragUV).rgb;
-	vec3 norm = texture(gNorm, fragUV).rgb;
+	float depth = texture(gDepth, fragUV).r;
+	float viewDepth = ViewDepth(depth);
+	vec3 fragPos = WorldPosFromDepth(fragUV, depth);
+	vec3 norm = DecodeNormal(texture(gNorm, fragUV).rg);
 	
-	vec3 albedo = pow(texture(gAlbedo, fragUV).rgb, vec3(2.2f));
+	vec3 albedo = texture(gAlbedo, fragUV).rgb; // sRGB textures decode to linear on sampling
 	float metal = texture(gMetRough, fragUV).r;
 	float rough = texture(gMetRough, fragUV).g;
 	
@@ -259,7 +367,7 @@ vec3 LightCalc()
 	vec3 loSpec = numerator / denominator;
 	
 	// diffuse
-	vec3 irr = texture(irradianceMap, N).rgb;
+	vec3 irr = EvaluateIrradianceSH(N);
 	
 	vec3 diff = (albedo / PI);
 	
@@ -281,14 +389,26 @@ vec3 LightCalc()
 		finalSpec = MonteCarloApprox(norm, V, R, A, B, rough, F0);
 	}
 	
-	vec4 shadowCoord = worldToLightMat * vec4(fragPos, 1.0f);
-	vec4 blur = texture(uShadowMap, shadowCoord.xy);
-  
-	float shadow = Shadow(shadowCoord, 1.0f * pow(10, -3));
+	// first cascade whose slice reaches this pixel; past the last one is unshadowed
+	int cascade = 0;
+	while (cascade < cascadeCount && viewDepth > cascadeSplits[cascade])
+	{
+		++cascade;
+	}
+	
+	float shadowValue = 1.0f;
 	
-	float currDepth = shadowCoord.z;
-	float maximum = float(currDepth - 1.0f * pow(10, -3) <= blur.x);
-	float shadowValue = max(1.0f  - shadow, maximum);
+	if (cascade < cascadeCount)
+	{
+		vec4 shadowCoord = worldToLightMat[cascade] * vec4(fragPos, 1.0f);
+		vec4 blur = texture(uShadowMap, vec3(shadowCoord.xy, float(cascade)));
+	  
+		float shadow = Shadow(shadowCoord, cascade, 1.0f * pow(10, -3));
+		
+		float currDepth = shadowCoord.z;
+		float maximum = float(currDepth - 1.0f * pow(10, -3) <= blur.x);
+		shadowValue = max(1.0f  - shadow, maximum);
+	}
 
 	 if (!useSpecular)
 		finalSpec = vec3(0.0f);
@@ -301,6 +421,19 @@ vec3 LightCalc()
 	vec3 ambient = (kD * irr * (albedo / PI) + finalSpec) * ao;
 	Lo = ((shadowValue * diff) + loSpec) * radiance * max(dot(N, L), 0.0f);
 	
+	// local lights are accumulated here, before tone mapping, instead of blended on top
+	if (useClusteredLights && depth < 1.0f)
+	{
+		ambient += PointLights(ClusterIndex(fragUV, viewDepth), fragPos, N, V, albedo, metal, rough, F0);
+	}
+	
+	if (showCascades && depth < 1.0f)
+	{
+		const vec3 tints[MaxCascades + 1] = vec3[](vec3(1.0f, 0.3f, 0.3f), vec3(0.3f, 1.0f, 0.3f),
+			vec3(0.3f, 0.3f, 1.0f), vec3(1.0f, 1.0f, 0.3f), vec3(1.0f));
+		ambient *= tints[cascade];
+	}
+	
 	return ambient;
 }
 
@@ -318,5 +451,9 @@ void main()
 	}
 	
 	fragColor = vec4(color, 1.0f);
-	entityID = texture(gEntityID, uv).r;
+	
+	// ~0u (nothing) passes through as is; the gBuffer keeps the window size while the
+	// scene viewport resizes, so map through fragUV like the other gBuffer reads
+	ivec2 idSize = textureSize(gEntityID, 0);
+	entityID = texelFetch(gEntityID, min(ivec2(fragUV * vec2(idSize)), idSize - 1), 0).r;
 }
\ No newline at end of file
@@ -3,10 +3,12 @@ out vec4 fragColor;
 in vec3 fragPos;
 in vec3 fragNorm;
 
-layout (binding = 0) uniform sampler2D gPos;
-layout (binding = 1) uniform sampler2D gNorm;
-layout (binding = 2) uniform sampler2D gAlbedo;
-layout (binding = 3) uniform sampler2D gMetRough;
+layout (binding = 0) uniform sampler2D gNorm;
+layout (binding = 1) uniform sampler2D gAlbedo;
+layout (binding = 2) uniform sampler2D gMetRough;
+layout (binding = 4) uniform sampler2D gDepth;
+
+uniform mat4 invViewProj;
 
 uniform vec3 pos;
 uniform vec4 color;
@@ -19,15 +21,34 @@ uniform float intensity;
 uniform int vWidth;
 uniform int vHeight;
 
+vec3 DecodeNormal(vec2 e)
+{
+	e = e * 2.0f - 1.0f;
+	vec3 n = vec3(e, 1.0f - abs(e.x) - abs(e.y));
+	
+	float t = max(-n.z, 0.0f);
+	n.x += n.x >= 0.0f ? -t : t;
+	n.y += n.y >= 0.0f ? -t : t;
+	
+	return normalize(n);
+}
+
+vec3 WorldPosFromDepth(vec2 uv)
+{
+	float depth = texture(gDepth, uv).r;
+	vec4 world = invViewProj * vec4(vec3(uv, depth) * 2.0f - 1.0f, 1.0f);
+	return world.xyz / world.w;
+}
+
 vec3 LightCalc()
 {
 	vec2 fragUV = vec2(gl_FragCoord.x / vWidth, gl_FragCoord.y / vHeight);
 	
-	vec3 gFragPos = texture(gPos, fragUV).rgb;
-	vec3 N = texture(gNorm, fragUV).rgb;
+	vec3 gFragPos = WorldPosFromDepth(fragUV);
+	vec3 N = DecodeNormal(texture(gNorm, fragUV).rg);
 	vec3 albedo = texture(gAlbedo, fragUV).rgb;
-	float rough = texture(gMetRough, fragUV).r;
-    float metal = texture(gMetRough, fragUV).g;
+	float metal = texture(gMetRough, fragUV).r;
+	float rough = texture(gMetRough, fragUV).g;
 	
 	vec3 F0 = vec3(0.04f);
 	F0 = mix(F0, albedo, metal);
@@ -85,7 +106,7 @@ void main()
 	vec2 fragUV = vec2(gl_FragCoord.x / vWidth, 
 	gl_FragCoord.y / vHeight);
 
-	vec3 gFragPos = texture(gPos, fragUV).rgb;
+	vec3 gFragPos = WorldPosFromDepth(fragUV);
 	vec3 L = pos - gFragPos;
 	float dist = length(L);
 	
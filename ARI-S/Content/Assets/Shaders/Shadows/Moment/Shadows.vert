@@ -4,14 +4,21 @@ layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormals;
 layout (location = 2) in vec2 aTexCoords;
 
+// per-instance data (instanced path only)
+layout (location = 7) in mat4 aInstanceModel;
+
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
+uniform bool instanced;
+
 out vec4 shadowPos;
 
 void main()
 {
-	gl_Position = projection * view * model * vec4(aPos, 1.0f);
+	mat4 modelMat = instanced ? aInstanceModel : model;
+
+	gl_Position = projection * view * modelMat * vec4(aPos, 1.0f);
 	shadowPos = gl_Position;
 }
\ No newline at end of file
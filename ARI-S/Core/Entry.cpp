@@ -4,6 +4,8 @@
 
 #include "Shader.h"
 #include "ModelBuilder.h"
+#include "AssetLoader.h"
+#include "TextureCache.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
@@ -17,7 +19,9 @@ int main()
 
 	// Application MUST be built first before the model table
 	ARIS::Application app{ 1600, 900 };
+	ARIS::TextureCache textures;
 	ARIS::ModelBuilder mb;
+	ARIS::AssetLoader loader;
 	
 	std::cout << "Hello, Hello World!" << std::endl;
 	
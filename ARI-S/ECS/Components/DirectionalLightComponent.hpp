@@ -34,7 +34,7 @@ namespace ARIS
 			//std::cout << res.first << " " << res.second << std::endl;
 			m_Shader.Activate();
 			m_Shader.SetData<T2>(res.first, res.second);
-			glUseProgram(0);
+			RenderState::UseProgram(0);
 		}
 
 		// https://stackoverflow.com/questions/38370986/how-to-pass-variadic-amount-of-stdpair-with-different-2nd-types-to-a-functio
@@ -46,7 +46,7 @@ namespace ARIS
 			//std::cout << res.first << " " << res.second << std::endl;
 			m_Shader.Activate();
 			m_Shader.SetData<T2>(res.first, res.second);
-			glUseProgram(0);
+			RenderState::UseProgram(0);
 
 			UpdateShader(args...);
 		}
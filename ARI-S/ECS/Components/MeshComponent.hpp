@@ -2,6 +2,7 @@
 #define MESH_HPP
 
 #include <vector>
+#include <memory>
 #include <glm.hpp>
 
 #include <glad/glad.h>
@@ -11,6 +12,7 @@
 #include "Texture.h"
 
 #include "Model.h"
+#include "ModelBuilder.h"
 #include "Shader.h"
 
 namespace ARIS
@@ -21,59 +23,116 @@ namespace ARIS
 		MeshComponent() = default;
 
 		MeshComponent(const Model& model)
+			: m_Model(std::make_unique<Model>(model))
 		{
-			*m_Model = model;
 		}
 
 		void operator=(const Model& model)
 		{
-			*m_Model = model;
+			m_Model = std::make_unique<Model>(model);
 		}
 
-		void SetEntityID(uint64_t entityID)
+		// Recompute the world-space bounds of this instance's meshes.
+		// Only needed when the transform or the model changed; returns false without a model.
+		bool Update(const glm::mat4& modelMat)
 		{
-			int id = static_cast<int>(entityID);
-			m_Model->InitializeID(id);
+			if (!m_Model)
+				return false;
+
+			const std::vector<Mesh>& meshes = m_Model->GetMeshes();
+			m_WorldBounds.resize(meshes.size());
+
+			for (unsigned i = 0; i < meshes.size(); ++i)
+			{
+				m_WorldBounds[i] = meshes[i].GetWorldBounds(modelMat);
+			}
+
+			return true;
 		}
 
-		void Update(glm::mat4 modelMat)
+		// Union of every mesh's world bounds
+		BoundingBox GetEntityBounds() const
 		{
-			if (!m_Model)
-				return;
+			if (m_WorldBounds.empty())
+				return BoundingBox();
 
-			m_Model->Update(modelMat);
+			BoundingBox result = m_WorldBounds[0];
+			for (const BoundingBox& b : m_WorldBounds)
+			{
+				result = BoundingBox::Merge(result, b);
+			}
+
+			return result;
 		}
 
+		// other - shader to draw with instead of the component's own (nullptr = default)
 		void Draw(glm::mat4 model, glm::mat4 view, glm::mat4 proj, 
-			Shader other = Shader(), bool useDefault = true, int entityID = -1)
+			Shader* other = nullptr, int entityID = -1)
 		{
 			if (!m_Model)
 				return;
 
-			Shader shaderInUse = useDefault ? m_Shader : other;
+			// by reference: shaders carry their uniform table, so avoid copying them per draw
+			Shader& shaderInUse = other ? *other : m_Shader;
 			shaderInUse.Activate();
 
-			if (useDefault)
+			shaderInUse.SetMat4("model", model);
+			shaderInUse.SetMat4("view", view);
+			shaderInUse.SetMat4("projection", proj);
+
+			m_Model->Draw(shaderInUse, entityID, m_Overrides);
+
+			if (ModelBuilder::Get().m_DisplayBoxes)
 			{
-				m_Shader.SetMat4("model", model);
-				m_Shader.SetMat4("view", view);
-				m_Shader.SetMat4("projection", proj);
+				DrawBoundingBoxes();
 			}
-			else
+		}
+
+		void DrawBoundingBoxes()
+		{
+			for (const BoundingBox& b : m_WorldBounds)
 			{
-				other.SetMat4("model", model);
-				other.SetMat4("view", view);
-				other.SetMat4("projection", proj);
+				Mesh::DrawBoundingBox(b);
+			}
+		}
+
+		// Per-instance material override (a TextureCache handle); nullptr clears the slot
+		void SetTexture(aiTextureType type, std::shared_ptr<Texture> tex)
+		{
+			switch (type)
+			{
+			case aiTextureType_DIFFUSE:
+				m_DiffuseTex = tex;
+				break;
+			case aiTextureType_NORMALS:
+				m_NormalTex = tex;
+				break;
+			case aiTextureType_METALNESS:
+				m_MetallicTex = tex;
+				break;
+			case aiTextureType_DIFFUSE_ROUGHNESS:
+				m_RoughnessTex = tex;
+				break;
+			case aiTextureType_UNKNOWN:
+				m_MetalRoughTex = tex;
+				break;
+			default:
+				return;
 			}
 
-			m_Model->Draw(shaderInUse, entityID);
+			m_Overrides.clear();
+			for (const std::shared_ptr<Texture>& t : { m_DiffuseTex, m_NormalTex, m_MetallicTex, m_RoughnessTex, m_MetalRoughTex })
+			{
+				if (t)
+					m_Overrides.push_back(t.get());
+			}
 		}
 
-		Texture* GetDiffuseTex() { return m_DiffuseTex; }
-		Texture* GetNormalTex() { return m_NormalTex; }
-		Texture* GetMetallicTex() { return m_MetallicTex; }
-		Texture* GetRoughnessTex() { return m_RoughnessTex; }
-		Texture* GetMetalRough() { return m_MetalRoughTex; }
+		Texture* GetDiffuseTex() { return m_DiffuseTex.get(); }
+		Texture* GetNormalTex() { return m_NormalTex.get(); }
+		Texture* GetMetallicTex() { return m_MetallicTex.get(); }
+		Texture* GetRoughnessTex() { return m_RoughnessTex.get(); }
+		Texture* GetMetalRough() { return m_MetalRoughTex.get(); }
 
 		std::string GetName() const { return m_Model->GetName(); }
 		std::string GetPath() const { return m_Model->GetPath(); }
@@ -81,26 +140,43 @@ namespace ARIS
 		void SetName(std::string s) { m_Model->SetName(s); }
 		void SetPath(std::string s) { m_Model->SetPath(s); }
 
+		Model* GetModel() const { return m_Model.get(); }
+
+		// Takes ownership; the previous model (and its texture handles) is released
+		void SetModel(Model* model) { m_Model.reset(model); }
+		const std::vector<BoundingBox>& GetWorldBounds() const { return m_WorldBounds; }
+		const std::vector<Texture*>& GetOverrides() const { return m_Overrides; }
+
+		int GetBVHProxy() const { return m_BVHProxy; }
+		void SetBVHProxy(int proxy) { m_BVHProxy = proxy; }
+
 		bool& GetControllableMetRough() { return m_ControllableMetalRoughness; }
 
 		float& GetMetalness() { return m_Metalness; }
 		float& GetRoughness() { return m_Roughness; }
 
 	private:
-		Model* m_Model;
+		// per-instance copy; the mesh resources and textures behind it are shared
+		std::unique_ptr<Model> m_Model;
 		Shader m_Shader;
 
-		Texture* m_DiffuseTex;
-		Texture* m_NormalTex;
-		Texture* m_MetallicTex;
-		Texture* m_RoughnessTex;
-		Texture* m_MetalRoughTex;
+		std::shared_ptr<Texture> m_DiffuseTex;
+		std::shared_ptr<Texture> m_NormalTex;
+		std::shared_ptr<Texture> m_MetallicTex;
+		std::shared_ptr<Texture> m_RoughnessTex;
+		std::shared_ptr<Texture> m_MetalRoughTex;
+
+		std::vector<Texture*> m_Overrides;
+		std::vector<BoundingBox> m_WorldBounds;
+
+		// leaf in the scene's BVH (-1 = not inserted)
+		int m_BVHProxy = -1;
 
 		glm::vec4 m_Ambient, m_Albedo, m_Specular;
 
-		bool m_ControllableMetalRoughness;
-		float m_Metalness;
-		float m_Roughness;
+		bool m_ControllableMetalRoughness = false;
+		float m_Metalness = 0.0f;
+		float m_Roughness = 0.0f;
 
 		friend class SceneSerializer;
 		friend class HierarchyPanel;
@@ -22,34 +22,25 @@ namespace ARIS
 			, m_Intensity(1.0f)
 			, m_Range(10.0f)
 		{
-			m_Light = ModelBuilder::Get().CreateSphere(1.0f, 16);
-			m_Shader = std::make_shared<Shader>(true, "IBL/LocalLightPBR.vert", "IBL/LocalLightPBR.frag", nullptr, "IBL/FormulasIBL.gh");
+			// every point light draws the same volume with the same program, so
+			// they're built once instead of per light
+			static Model* s_Sphere = ModelBuilder::Get().CreateSphere(1.0f, 16);
+			static std::shared_ptr<Shader> s_Shader = std::make_shared<Shader>(true, 
+				"IBL/LocalLightPBR.vert", "IBL/LocalLightPBR.frag", nullptr, "IBL/FormulasIBL.gh");
+
+			m_Light = s_Sphere;
+			m_Shader = s_Shader;
 		}
 
 		PointLightComponent(const PointLightComponent& other) = default;
 
-		template <typename T1, typename T2>
-		void UpdateShader(T1 input1, T2 input2)
+		// Set (name, value) pairs on the light's shader with one program bind
+		template <typename... Args>
+		void UpdateShader(Args... args)
 		{
-			std::pair<T1, T2> res{ input1, input2 };
-			//std::cout << res.first << " " << res.second << std::endl;
 			m_Shader->Activate();
-			m_Shader->SetData<T2>(res.first, res.second);
-			glUseProgram(0);
-		}
-
-		// https://stackoverflow.com/questions/38370986/how-to-pass-variadic-amount-of-stdpair-with-different-2nd-types-to-a-functio
-		template <typename T1, typename T2, typename... Args>
-		void UpdateShader(T1 input1, T2 input2, Args... args)
-		{
-			std::pair<T1, T2> res{ input1, input2 };
-
-			//std::cout << res.first << " " << res.second << std::endl;
-			m_Shader->Activate();
-			m_Shader->SetData<T2>(res.first, res.second);
-			glUseProgram(0);
-
-			UpdateShader(args...);
+			SetUniforms(args...);
+			RenderState::UseProgram(0);
 		}
 
 		void Draw(glm::vec3 position, glm::mat4 model, glm::mat4 view, glm::mat4 projection)
@@ -59,11 +50,18 @@ namespace ARIS
 			m_Shader->SetMat4("model", model);
 			m_Shader->SetMat4("view", view);
 			m_Shader->SetMat4("projection", projection);
+			m_Shader->SetMat4("invViewProj", glm::inverse(projection * view));
 		
 			// render the PBR effect on objects
 			m_Light->Draw(*m_Shader.get());
 
-			// render the actual light (debug)
+			DrawMarker(position);
+		}
+
+		// Debug sphere at the light (and its range with bounding boxes on);
+		// all that's drawn per light when lighting is clustered
+		void DrawMarker(glm::vec3 position)
+		{
 			dd::sphere(glm::value_ptr(position), glm::value_ptr(m_Color), 0.1f);
 
 			if (ModelBuilder::Get().m_DisplayBoxes)
@@ -82,7 +80,25 @@ namespace ARIS
 
 		float GetRange() const { return m_Range; }
 		float GetIntensity() const { return m_Intensity; }
+
+		void SetColor(const glm::vec4& color) { m_Color = color; }
+		void SetRange(float range) { m_Range = range; }
+		void SetIntensity(float intensity) { m_Intensity = intensity; }
 	private:
+		template <typename T1, typename T2>
+		void SetUniforms(T1 input1, T2 input2)
+		{
+			m_Shader->SetData<T2>(input1, input2);
+		}
+
+		// https://stackoverflow.com/questions/38370986/how-to-pass-variadic-amount-of-stdpair-with-different-2nd-types-to-a-functio
+		template <typename T1, typename T2, typename... Args>
+		void SetUniforms(T1 input1, T2 input2, Args... args)
+		{
+			m_Shader->SetData<T2>(input1, input2);
+			SetUniforms(args...);
+		}
+
 		Model* m_Light;
 		std::shared_ptr<Shader> m_Shader;
 		glm::vec4 m_Color = glm::vec4(1.0f);
@@ -0,0 +1,25 @@
+#ifndef RELATIONSHIP_HPP
+#define RELATIONSHIP_HPP
+
+#include "entt.hpp"
+
+namespace ARIS
+{
+	// Parent/child links stored as an intrusive sibling list, so walking
+	// the hierarchy needs no per-node allocations. Maintained by
+	// Scene::SetParent; don't edit the links directly.
+	struct RelationshipComponent
+	{
+		entt::entity s_Parent = entt::null;
+		entt::entity s_FirstChild = entt::null;
+		entt::entity s_PrevSibling = entt::null;
+		entt::entity s_NextSibling = entt::null;
+
+		size_t s_ChildCount = 0;
+
+		RelationshipComponent() = default;
+		RelationshipComponent(const RelationshipComponent&) = default;
+	};
+}
+
+#endif
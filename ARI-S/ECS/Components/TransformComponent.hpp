@@ -24,17 +24,34 @@ namespace ARIS
 		glm::vec3 Up() const { return glm::rotate(GetOrientation(), glm::vec3(0.0f, 1.0f, 0.0f)); }
 		glm::vec3 Right() const { return glm::rotate(GetOrientation(), glm::vec3(1.0f, 0.0f, 0.0f)); }
 
-		void Translate(glm::vec3 v) { m_Translation = v; }
-		void Rotate(glm::vec3 v) { m_Rotation = v; }
-		void Scale(glm::vec3 v) { m_Scale = v; }
+		void Translate(glm::vec3 v) { if (v != m_Translation) { m_Translation = v; m_Dirty = true; } }
+		void Rotate(glm::vec3 v) { if (v != m_Rotation) { m_Rotation = v; m_Dirty = true; } }
+		void Scale(glm::vec3 v) { if (v != m_Scale) { m_Scale = v; m_Dirty = true; } }
 
-		glm::mat4 GetTransform() const { return m_TransformMatrix; }
+		// Flag the local matrix for a rebuild (for code that writes the members directly)
+		void MarkDirty() { m_Dirty = true; }
+		bool IsDirty() const { return m_Dirty; }
 
-		void Update()
+		// World matrix (parent world * local), valid after the scene's transform update
+		const glm::mat4& GetTransform() const { return m_TransformMatrix; }
+		const glm::mat4& GetLocalTransform() const { return m_LocalMatrix; }
+
+		glm::vec3 GetWorldTranslation() const { return glm::vec3(m_TransformMatrix[3]); }
+
+		// Rebuild the local matrix if it's dirty and recompose the world matrix.
+		// Called by Scene::UpdateTransforms, parents before children.
+		void Update(const glm::mat4& parentWorld = glm::mat4(1.0f))
 		{
-			m_TransformMatrix = glm::translate(glm::mat4(1.0f), m_Translation)
-				* glm::toMat4(glm::quat(m_Rotation))
-				* glm::scale(glm::mat4(1.0f), m_Scale);
+			if (m_Dirty)
+			{
+				m_LocalMatrix = glm::translate(glm::mat4(1.0f), m_Translation)
+					* glm::toMat4(glm::quat(m_Rotation))
+					* glm::scale(glm::mat4(1.0f), m_Scale);
+
+				m_Dirty = false;
+			}
+
+			m_TransformMatrix = parentWorld * m_LocalMatrix;
 		}
 
 	private:
@@ -42,8 +59,11 @@ namespace ARIS
 		glm::vec3 m_Rotation = { 0.0f, 0.0f, 0.0f };
 		glm::vec3 m_Scale = { 1.0f, 1.0f, 1.0f };
 
+		glm::mat4 m_LocalMatrix = glm::mat4(1.0f);
 		glm::mat4 m_TransformMatrix = glm::mat4(1.0f);
 
+		bool m_Dirty = true;
+
 		friend class SceneSerializer;
 		friend class HierarchyPanel;
 		friend class Editor;
@@ -2,6 +2,7 @@
 #include "MeshComponent.hpp"
 #include "PointLightComponent.hpp"
 #include "DirectionalLightComponent.hpp"
+#include "RelationshipComponent.hpp"
 
 #include "UUID.hpp"
 
@@ -10,6 +10,10 @@
 #include "Application.h"
 
 #include "SceneSerializer.h"
+#include "AssetLoader.h"
+#include "ModelBuilder.h"
+#include "TextureCache.h"
+#include "Compression/TextureCompressor.h"
 
 #include "FileDialogs.h"
 
@@ -70,6 +74,7 @@ namespace ARIS
 		m_HierarchyPanel.SetContext(m_ActiveScene);
 
 		m_EditorCamera = EditorCamera(30.0f, 1.778f, 1.0f, 100.0f);
+		m_PickReadback.Generate();
 
 		//m_Framebuffer = new Framebuffer(w, h, GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 		//m_Framebuffer->Bind();
@@ -83,6 +88,8 @@ namespace ARIS
 
 	void Editor::OnDetach()
 	{
+		m_PickReadback.Cleanup();
+
 		ImGui_ImplOpenGL3_Shutdown();
 		ImGui_ImplGlfw_Shutdown();
 		ImGui::DestroyContext();
@@ -102,6 +109,17 @@ namespace ARIS
 		//m_Framebuffer->ClearAttachment(1, -1);
 		//m_Framebuffer->Unbind();
 
+		// finish background loads within a slice of the frame
+		AssetLoader::Get().ProcessUploads(4.0f);
+
+		// once a newly opened scene has everything, drop the models and textures only the old one used
+		if (m_EvictTextures && AssetLoader::Get().GetPendingCount() == 0)
+		{
+			ModelBuilder::Get().ReleaseUnused();
+			TextureCache::Get().EvictUnused();
+			m_EvictTextures = false;
+		}
+
 		m_EditorCamera.OnUpdate(dt);
 		DebugWrapper::GetInstance().Update(m_EditorCamera);
 
@@ -121,14 +139,25 @@ namespace ARIS
 		if (mouseX >= 0 && mouseY >= 0 &&
 			mouseX < static_cast<int>(vpSize.x) && mouseY < static_cast<int>(vpSize.y))
 		{
-			int pixel = m_ActiveScene->GetSceneFBO()->ReadPixel(1, mouseX, mouseY);
-			if (pixel == -1)
+			m_MouseNDC = glm::vec2(mx / vpSize.x, my / vpSize.y) * 2.0f - 1.0f;
+
+			// Hover comes from the entity ID buffer, read back a frame or two late
+			m_PickReadback.Request(*m_ActiveScene->GetSceneFBO(), 1, mouseX, mouseY);
+		}
+
+		uint32_t pixel;
+		if (m_PickReadback.Poll(pixel))
+		{
+			entt::entity hovered = static_cast<entt::entity>(pixel);
+
+			// the read may predate a deletion or a scene switch
+			if (pixel == 0xFFFFFFFFu || !m_ActiveScene->IsValid(hovered))
 			{
 				m_HoveredEntity = Entity();
 			}
 			else
 			{
-				m_HoveredEntity = Entity((entt::entity)pixel, m_ActiveScene.get());
+				m_HoveredEntity = Entity(hovered, m_ActiveScene.get());
 			}
 		}
 	}
@@ -234,8 +263,8 @@ namespace ARIS
 			{
 				ImGui::Text("Displaying Buffer");
 				ImGui::SameLine();
-				const char* fbos[] = { "SceneFBO", "GPosition", "GNormals", "GAlbedo", 
-					"GAMR", "EntityID", "GDepth", "ShadowMap", "ShadowBlur", "AoMap", "AoBlurX", "AoBlurXY"};
+				const char* fbos[] = { "SceneFBO", "GNormals", "GAlbedo", 
+					"GAMR", "GDepth", "AoMap", "AoBlurX", "AoBlurXY"};
 				static const char* currItem = m_DisplayBuffer.c_str();
 				if (ImGui::BeginCombo("##fbo combo", currItem))
 				{
@@ -257,10 +286,80 @@ namespace ARIS
 				}
 
 				ImGui::Checkbox("Display Debug Shapes", &ModelBuilder::Get().m_DisplayBoxes);
+				ImGui::Checkbox("Use Mesh Cache", &ModelBuilder::Get().m_UseMeshCache);
+
+				if (ImGui::MenuItem("Benchmark Model Import"))
+				{
+					m_ImportBenchmark = ModelBuilder::Get().BenchmarkImport({
+						"Content\\Assets\\Models\\Sponza\\sponza.obj",
+						"Content\\Assets\\Models\\Cerberus\\Cerberus_LP.FBX",
+						"Content\\Assets\\Models\\DamagedHelmet\\DamagedHelmet.gltf" });
+				}
+				for (const ModelBuilder::ImportTiming& t : m_ImportBenchmark)
+				{
+					ImGui::Text("%s", std::filesystem::path(t.s_Path).filename().string().c_str());
+					ImGui::Text("  Assimp: %.1f ms, Cache: %.1f ms", t.s_AssimpMs, t.s_CacheMs);
+				}
+
+				ImGui::Separator();
+
+				// affects textures loaded from here on
+				ImGui::Checkbox("Compress Textures (BC)", &TextureCompressor::m_Enabled);
+				ImGui::Checkbox("Fast Albedo (BC1/BC3)", &TextureCompressor::m_FastColor);
+
+				if (ImGui::MenuItem("Check BC Round Trip"))
+				{
+					m_RoundTrips.clear();
+					for (const char* path : {
+						"Content\\Assets\\Models\\DamagedHelmet\\Default_albedo.jpg",
+						"Content\\Assets\\Models\\DamagedHelmet\\Default_normal.jpg",
+						"Content\\Assets\\Models\\DamagedHelmet\\Default_metalRoughness.jpg" })
+					{
+						m_RoundTrips.push_back({ path, TextureCompressor::CheckRoundTrip(path) });
+					}
+				}
+				for (const auto& [path, results] : m_RoundTrips)
+				{
+					ImGui::Text("%s", std::filesystem::path(path).filename().string().c_str());
+					for (const BlockCompressor::RoundTrip& r : results)
+					{
+						ImGui::Text("  BC%u: RMSE %.2f, PSNR %.1f dB, encode %.1f ms", static_cast<uint32_t>(r.s_Format), 
+							r.s_RMSE, r.s_PSNR, r.s_EncodeMs);
+					}
+				}
+
+				TextureCache::Stats tc = TextureCache::Get().GetStats();
+				ImGui::Text("Texture Cache: %u textures, %.1f MB", tc.s_Entries, tc.s_ResidentBytes / (1024.0f * 1024.0f));
+				ImGui::Text("  As RGB(A)16F: %.1f MB", tc.s_Legacy16FBytes / (1024.0f * 1024.0f));
+				ImGui::Text("  Hits: %u, Misses: %u, Evicted: %u", tc.s_Hits, tc.s_Misses, tc.s_Evictions);
+				if (ImGui::MenuItem("Evict Unused Textures"))
+				{
+					TextureCache::Get().EvictUnused();
+				}
+
+				TextureCache& cache = TextureCache::Get();
+				ImGui::Checkbox("Stream Texture Mips", &cache.m_Streaming);
+
+				int budgetMB = static_cast<int>(cache.m_StreamingBudget >> 20);
+				if (ImGui::SliderInt("Texture Budget (MB)", &budgetMB, 32, 4096))
+				{
+					cache.m_StreamingBudget = static_cast<size_t>(budgetMB) << 20;
+				}
+				ImGui::SliderFloat("Mip Bias", &cache.m_StreamingBias, -2.0f, 3.0f);
+
+				ImGui::Text("  Streamed: %u textures, %.1f / %.1f MB resident", tc.s_Streamed,
+					tc.s_StreamedBytes / (1024.0f * 1024.0f), tc.s_StreamedFullBytes / (1024.0f * 1024.0f));
+				ImGui::Text("  Levels uploaded: %u (last frame), dropped: %u", tc.s_LevelUploads, tc.s_LevelEvictions);
 
 				ImGui::EndMenu();
 			}
 
+			unsigned loading = AssetLoader::Get().GetPendingCount();
+			if (loading > 0)
+			{
+				ImGui::Text("Loading %u assets...", loading);
+			}
+
 			ImGui::EndMenuBar();
 		}
 		ImGui::End();
@@ -343,13 +442,17 @@ namespace ARIS
 
 			if (ImGuizmo::IsUsing())
 			{
+				// the gizmo works in world space; bring it back under the parent
+				glm::mat4 parentWorld = tc.GetTransform() * glm::inverse(tc.GetLocalTransform());
+
 				glm::vec3 tra, rot, sc;
-				Math::Decompose(tr, tra, rot, sc);
+				Math::Decompose(glm::inverse(parentWorld) * tr, tra, rot, sc);
 
 				glm::vec3 deltaRot = rot - tc.m_Rotation;
 				tc.m_Translation = tra;
 				tc.m_Rotation += deltaRot;
 				tc.m_Scale = sc;
+				tc.MarkDirty();
 			}
 
 		}
@@ -476,7 +579,10 @@ namespace ARIS
 		{
 			if (m_ViewportHovered && !ImGuizmo::IsOver() && !InputPoll::IsKeyPressed(KeyTags::LeftAlt))
 			{
-				m_HierarchyPanel.SetSelectedEntity(m_HoveredEntity);
+				// Clicks raycast the BVH on the CPU so selection is exact for this frame,
+				// rather than taking the slightly stale hover readback
+				entt::entity picked = m_ActiveScene->PickEntity(m_EditorCamera, m_MouseNDC);
+				m_HierarchyPanel.SetSelectedEntity(picked == entt::null ? Entity() : Entity(picked, m_ActiveScene.get()));
 			}
 		}
 
@@ -509,6 +615,8 @@ namespace ARIS
 
 		SceneSerializer s(m_ActiveScene);
 		s.Deserialize(path.string());
+
+		m_EvictTextures = true;
 	}
 
 	void Editor::SaveSceneAs()
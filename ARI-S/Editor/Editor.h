@@ -9,6 +9,7 @@
 #include "ContentBrowser.h"
 
 #include "Cameras/EditorCamera.h"
+#include "Compression/BlockCompressor.h"
 
 #include <glm.hpp>
 
@@ -56,6 +57,15 @@ namespace ARIS
 
 		Entity m_HoveredEntity;
 
+		PixelReadback m_PickReadback;
+		glm::vec2 m_MouseNDC = glm::vec2(0.0f);
+
+		std::vector<ModelBuilder::ImportTiming> m_ImportBenchmark;
+		std::vector<std::pair<std::string, std::vector<BlockCompressor::RoundTrip>>> m_RoundTrips;
+
+		// evict unused textures once the scene just opened has finished loading
+		bool m_EvictTextures = false;
+
 		bool m_BlockEvents = true;
 
 		bool m_ViewportFocused = false, m_ViewportHovered = false;
@@ -2,6 +2,8 @@
 
 #include "HierarchyPanel.h"
 #include "ModelBuilder.h"
+#include "AssetLoader.h"
+#include "TextureCache.h"
 
 #include <imgui.h>
 #include <imgui_internal.h>
@@ -167,12 +169,23 @@ namespace ARIS
 
 		if (m_Context)
 		{
+			// Children are drawn under their parents
 			m_Context->m_Registry.each([&](auto entityID)
 				{
 					Entity e{ entityID, m_Context.get() };
-					DrawEntityNode(e);
+					if (!m_Context->GetParent(e))
+					{
+						DrawEntityNode(e);
+					}
 				});
 
+			// Reparent after the tree is drawn so the sibling lists aren't edited mid-walk
+			if (m_Reparent)
+			{
+				m_Context->SetParent(m_ReparentChild, m_ReparentTarget);
+				m_Reparent = false;
+			}
+
 			if (ImGui::IsMouseDown(0) && ImGui::IsWindowHovered())
 			{
 				m_SelectionContext = {};
@@ -221,17 +234,53 @@ namespace ARIS
 	{
 		auto& tag = e.GetComponent<TagComponent>().s_Tag;
 
+		const RelationshipComponent* rel = e.HasComponent<RelationshipComponent>() ? 
+			&e.GetComponent<RelationshipComponent>() : nullptr;
+		bool hasChildren = rel && rel->s_FirstChild != entt::null;
+
 		ImGuiTreeNodeFlags flags = ((m_SelectionContext == e) ? ImGuiTreeNodeFlags_Selected : 0) | ImGuiTreeNodeFlags_OpenOnArrow;
 		flags |= ImGuiTreeNodeFlags_SpanAvailWidth;
+		if (!hasChildren)
+		{
+			flags |= ImGuiTreeNodeFlags_Leaf;
+		}
+
 		bool opened = ImGui::TreeNodeEx((void*)(uint64_t)(uint32_t)e, flags, tag.c_str());
 		if (ImGui::IsItemClicked())
 		{
 			m_SelectionContext = e;
 		}
 
+		// Drag an entity onto another to parent it
+		if (ImGui::BeginDragDropSource())
+		{
+			entt::entity handle = e;
+			ImGui::SetDragDropPayload("HIERARCHY_ENTITY", &handle, sizeof(entt::entity));
+			ImGui::Text("%s", tag.c_str());
+			ImGui::EndDragDropSource();
+		}
+
+		if (ImGui::BeginDragDropTarget())
+		{
+			if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload("HIERARCHY_ENTITY"))
+			{
+				m_ReparentChild = { *(const entt::entity*)payload->Data, m_Context.get() };
+				m_ReparentTarget = e;
+				m_Reparent = true;
+			}
+			ImGui::EndDragDropTarget();
+		}
+
 		bool deleted = false;
 		if (ImGui::BeginPopupContextItem())
 		{
+			if (rel && rel->s_Parent != entt::null && ImGui::MenuItem("Unparent"))
+			{
+				m_ReparentChild = e;
+				m_ReparentTarget = {};
+				m_Reparent = true;
+			}
+
 			if (ImGui::MenuItem("Delete Entity"))
 			{
 				deleted = true;
@@ -241,12 +290,17 @@ namespace ARIS
 
 		if (opened)
 		{
-			//ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_SpanAvailWidth;
-			//bool opened = ImGui::TreeNodeEx((void*)9817239, flags, tag.c_str());
-			//if (opened)
-			//{
-			//	ImGui::TreePop();
-			//}
+			if (hasChildren)
+			{
+				for (entt::entity child = rel->s_FirstChild; child != entt::null;)
+				{
+					// grab the next sibling first; the child may delete itself
+					entt::entity next = m_Context->m_Registry.get<RelationshipComponent>(child).s_NextSibling;
+					DrawEntityNode({ child, m_Context.get() });
+					child = next;
+				}
+			}
+
 			ImGui::TreePop();
 		}
 
@@ -294,14 +348,18 @@ namespace ARIS
 
 		DrawComponent<TransformComponent>("Transform", e, [](auto& comp)
 		{
-			DrawVec3Control("Translation", comp.m_Translation);
-			glm::vec3 rot = glm::degrees(comp.m_Rotation);
+			glm::vec3 tra = comp.m_Translation, rot = glm::degrees(comp.m_Rotation), sc = comp.m_Scale;
+
+			DrawVec3Control("Translation", tra);
 			DrawVec3Control("Rotation", rot);
-			comp.m_Rotation = glm::radians(rot);
-			DrawVec3Control("Scale", comp.m_Scale, 1.0f);
+			DrawVec3Control("Scale", sc, 1.0f);
+
+			comp.Translate(tra);
+			comp.Rotate(glm::radians(rot));
+			comp.Scale(sc);
 		});
 
-		DrawComponent<MeshComponent>("Model", e, [](auto& comp)
+		DrawComponent<MeshComponent>("Model", e, [this, e](auto& comp) mutable
 		{
 			//Model* currItem = &comp.m_Model;
 			//if (ImGui::BeginCombo("##custom combo", currItem->GetName().c_str()))
@@ -332,7 +390,11 @@ namespace ARIS
 				{
 					const wchar_t* path = (const wchar_t*)payload->Data;
 					std::filesystem::path modelPath = std::filesystem::path(s_AssetPath) / path;
-					comp.m_Model = ModelBuilder::Get().LoadModel(modelPath.string());
+					// the current model stays up until the new one has loaded
+					Scene* scene = m_Context.get();
+					entt::entity handle = e;
+					AssetLoader::Get().LoadModel(modelPath.string(), scene,
+						[scene, handle](Model* model) { scene->AssignModel(handle, model); });
 				}
 				ImGui::EndDragDropTarget();
 			}
@@ -354,15 +416,11 @@ namespace ARIS
 				{
 					const wchar_t* path = (const wchar_t*)payload->Data;
 					std::filesystem::path texPath = std::filesystem::path(s_AssetPath) / path;
-					Texture* tex = new Texture(texPath.string(), GL_LINEAR, GL_REPEAT, false, aiTextureType_DIFFUSE);
+					std::shared_ptr<Texture> tex = TextureCache::Get().Acquire(texPath.string(), aiTextureType_DIFFUSE);
 
 					if (tex->m_IsLoaded)
 					{
-						for (Mesh& m : comp.m_Model->m_Meshes)
-						{
-							m.m_Textures.push_back(*tex);
-						}
-						comp.m_DiffuseTex = tex;
+						comp.SetTexture(aiTextureType_DIFFUSE, tex);
 					}
 				}
 				ImGui::EndDragDropTarget();
@@ -386,15 +444,11 @@ namespace ARIS
 				{
 					const wchar_t* path = (const wchar_t*)payload->Data;
 					std::filesystem::path texPath = std::filesystem::path(s_AssetPath) / path;
-					Texture* tex = new Texture(texPath.string(), GL_LINEAR, GL_REPEAT, false, aiTextureType_NORMALS);
+					std::shared_ptr<Texture> tex = TextureCache::Get().Acquire(texPath.string(), aiTextureType_NORMALS);
 
 					if (tex->m_IsLoaded)
 					{
-						for (Mesh& m : comp.m_Model->m_Meshes)
-						{
-							m.m_Textures.push_back(*tex);
-						}
-						comp.m_NormalTex = tex;
+						comp.SetTexture(aiTextureType_NORMALS, tex);
 					}
 				}
 				ImGui::EndDragDropTarget();
@@ -435,15 +489,11 @@ namespace ARIS
 					{
 						const wchar_t* path = (const wchar_t*)payload->Data;
 						std::filesystem::path texPath = std::filesystem::path(s_AssetPath) / path;
-						Texture* tex = new Texture(texPath.string(), GL_LINEAR, GL_REPEAT, false, aiTextureType_METALNESS);
+						std::shared_ptr<Texture> tex = TextureCache::Get().Acquire(texPath.string(), aiTextureType_METALNESS);
 
 						if (tex->m_IsLoaded)
 						{
-							for (Mesh& m : comp.m_Model->m_Meshes)
-							{
-								m.m_Textures.push_back(*tex);
-							}
-							comp.m_MetallicTex = tex;
+							comp.SetTexture(aiTextureType_METALNESS, tex);
 						}
 					}
 					ImGui::EndDragDropTarget();
@@ -467,15 +517,11 @@ namespace ARIS
 					{
 						const wchar_t* path = (const wchar_t*)payload->Data;
 						std::filesystem::path texPath = std::filesystem::path(s_AssetPath) / path;
-						Texture* tex = new Texture(texPath.string(), GL_LINEAR, GL_REPEAT, false, aiTextureType_DIFFUSE_ROUGHNESS);
+						std::shared_ptr<Texture> tex = TextureCache::Get().Acquire(texPath.string(), aiTextureType_DIFFUSE_ROUGHNESS);
 
 						if (tex->m_IsLoaded)
 						{
-							for (Mesh& m : comp.m_Model->m_Meshes)
-							{
-								m.m_Textures.push_back(*tex);
-							}
-							comp.m_RoughnessTex = tex;
+							comp.SetTexture(aiTextureType_DIFFUSE_ROUGHNESS, tex);
 						}
 					}
 					ImGui::EndDragDropTarget();
@@ -497,15 +543,11 @@ namespace ARIS
 					{
 						const wchar_t* path = (const wchar_t*)payload->Data;
 						std::filesystem::path texPath = std::filesystem::path(s_AssetPath) / path;
-						Texture* tex = new Texture(texPath.string(), GL_LINEAR, GL_REPEAT, false, aiTextureType_UNKNOWN);
+						std::shared_ptr<Texture> tex = TextureCache::Get().Acquire(texPath.string(), aiTextureType_UNKNOWN);
 
 						if (tex->m_IsLoaded)
 						{
-							for (Mesh& m : comp.m_Model->m_Meshes)
-							{
-								m.m_Textures.push_back(*tex);
-							}
-							comp.m_MetalRoughTex = tex;
+							comp.SetTexture(aiTextureType_UNKNOWN, tex);
 						}
 					}
 					ImGui::EndDragDropTarget();
@@ -29,6 +29,10 @@ namespace ARIS
 	private:
 		std::shared_ptr<Scene> m_Context;
 		Entity m_SelectionContext;
+
+		// deferred drag-and-drop reparent (null target = unparent)
+		Entity m_ReparentChild, m_ReparentTarget;
+		bool m_Reparent = false;
 	};
 }
 
@@ -0,0 +1,213 @@
+#include <arpch.h>
+#include "AssetLoader.h"
+#include "TextureCache.h"
+#include "Timer.h"
+
+namespace ARIS
+{
+	AssetLoader* AssetLoader::m_Instance = nullptr;
+
+	AssetLoader::AssetLoader(unsigned workers)
+	{
+		m_Instance = this;
+
+		if (workers == 0)
+		{
+			workers = std::max(1u, std::thread::hardware_concurrency() - 1);
+		}
+
+		for (unsigned i = 0; i < workers; ++i)
+		{
+			m_Workers.emplace_back(&AssetLoader::WorkerLoop, this);
+		}
+	}
+
+	AssetLoader::~AssetLoader()
+	{
+		{
+			std::lock_guard<std::mutex> jobLock(m_JobMutex);
+			std::lock_guard<std::mutex> uploadLock(m_UploadMutex);
+			m_Stopping = true;
+		}
+
+		m_JobReady.notify_all();
+		m_UploadSpace.notify_all();
+
+		for (std::thread& t : m_Workers)
+		{
+			t.join();
+		}
+	}
+
+	void AssetLoader::LoadModel(const std::string& path, const void* owner, ModelCallback onLoaded)
+	{
+		if (Model* existing = ModelBuilder::Get().FindModel(path))
+		{
+			onLoaded(existing);
+			return;
+		}
+
+		m_ModelRequests[path].push_back({ owner, onLoaded });
+
+		if (!m_ModelsInFlight.insert(path).second)
+			return;
+
+		++m_Pending;
+		bool useCache = ModelBuilder::Get().m_UseMeshCache;
+
+		PushJob([this, path, useCache]()
+		{
+			auto data = std::make_shared<ModelData>();
+			ModelBuilder::ImportModel(path, *data, useCache, true);
+
+			PushUpload([this, data]() { FinishModel(*data); });
+		});
+	}
+
+	void AssetLoader::LoadTexture(const std::string& path, aiTextureType type, const void* owner, TextureCallback onLoaded)
+	{
+		if (TextureCache::Get().IsResident(path, type))
+		{
+			onLoaded(TextureCache::Get().Acquire(path, type));
+			return;
+		}
+
+		TextureKey key = { path, type };
+
+		m_TextureRequests[key].push_back({ owner, onLoaded });
+
+		if (!m_TexturesInFlight.insert(key).second)
+			return;
+
+		++m_Pending;
+
+		PushJob([this, key]()
+		{
+			ImageData image = Texture::ReadImage(key.s_Path, key.s_Type);
+
+			PushUpload([this, key, image]() { FinishTexture(key, image); });
+		});
+	}
+
+	void AssetLoader::Cancel(const void* owner)
+	{
+		// the import itself still finishes (and stays in flight); only the callbacks are dropped
+		auto drop = [owner](auto& table)
+		{
+			for (auto it = table.begin(); it != table.end();)
+			{
+				auto& requests = it->second;
+				requests.erase(std::remove_if(requests.begin(), requests.end(),
+					[owner](const auto& r) { return r.s_Owner == owner; }), requests.end());
+
+				it = requests.empty() ? table.erase(it) : std::next(it);
+			}
+		};
+
+		drop(m_ModelRequests);
+		drop(m_TextureRequests);
+	}
+
+	void AssetLoader::ProcessUploads(float budgetMs)
+	{
+		Timer timer;
+
+		do
+		{
+			std::function<void()> upload;
+			{
+				std::lock_guard<std::mutex> lock(m_UploadMutex);
+				if (m_Uploads.empty())
+					return;
+
+				upload = std::move(m_Uploads.front());
+				m_Uploads.pop_front();
+			}
+			m_UploadSpace.notify_one();
+
+			upload();
+			--m_Pending;
+
+		} while (timer.ElapsedMillis() < budgetMs);
+	}
+
+	void AssetLoader::WorkerLoop()
+	{
+		while (true)
+		{
+			std::function<void()> job;
+			{
+				std::unique_lock<std::mutex> lock(m_JobMutex);
+				m_JobReady.wait(lock, [this]() { return m_Stopping || !m_Jobs.empty(); });
+
+				if (m_Stopping)
+					return;
+
+				job = std::move(m_Jobs.front());
+				m_Jobs.pop_front();
+			}
+
+			job();
+		}
+	}
+
+	void AssetLoader::PushJob(std::function<void()> job)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_JobMutex);
+			m_Jobs.push_back(std::move(job));
+		}
+		m_JobReady.notify_one();
+	}
+
+	void AssetLoader::PushUpload(std::function<void()> upload)
+	{
+		std::unique_lock<std::mutex> lock(m_UploadMutex);
+		m_UploadSpace.wait(lock, [this]() { return m_Stopping || m_Uploads.size() < m_MaxUploads; });
+
+		if (m_Stopping)
+			return;
+
+		m_Uploads.push_back(std::move(upload));
+	}
+
+	void AssetLoader::FinishModel(const ModelData& data)
+	{
+		m_ModelsInFlight.erase(data.s_Path);
+
+		std::vector<Request<ModelCallback>> requests;
+		auto it = m_ModelRequests.find(data.s_Path);
+		if (it != m_ModelRequests.end())
+		{
+			requests = std::move(it->second);
+			m_ModelRequests.erase(it);
+		}
+
+		// built (and added to the table) even if every requester is gone, so the work isn't wasted
+		Model* model = ModelBuilder::Get().AddModel(data);
+
+		for (Request<ModelCallback>& r : requests)
+		{
+			r.s_Callback(new Model(*model));
+		}
+	}
+
+	void AssetLoader::FinishTexture(const TextureKey& key, const ImageData& image)
+	{
+		m_TexturesInFlight.erase(key);
+
+		// nobody is left to hold the handle, so an upload would only be evicted again
+		auto it = m_TextureRequests.find(key);
+		if (it == m_TextureRequests.end())
+			return;
+
+		std::vector<Request<TextureCallback>> requests = std::move(it->second);
+		m_TextureRequests.erase(it);
+
+		// the first Acquire uploads the decoded image, the rest are cache hits
+		for (Request<TextureCallback>& r : requests)
+		{
+			r.s_Callback(TextureCache::Get().Acquire(key.s_Path, key.s_Type, GL_LINEAR, GL_REPEAT, false, &image));
+		}
+	}
+}
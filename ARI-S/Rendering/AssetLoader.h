@@ -0,0 +1,100 @@
+#ifndef ASSETLOADER_H
+#define ASSETLOADER_H
+
+#include "ModelBuilder.h"
+#include "Texture.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <atomic>
+
+namespace ARIS
+{
+	// Background asset pipeline. Worker threads do the file I/O, Assimp import
+	// and image decoding; the results wait in a bounded queue until the GL thread
+	// uploads them in ProcessUploads() under a per-frame time budget. Callbacks
+	// run on the GL thread once the asset exists.
+	class AssetLoader
+	{
+	public:
+		using ModelCallback = std::function<void(Model*)>;
+		using TextureCallback = std::function<void(std::shared_ptr<Texture>)>;
+
+		// workers - 0 picks one less than the hardware thread count
+		AssetLoader(unsigned workers = 0);
+		~AssetLoader();
+
+		inline static AssetLoader& Get() { return *m_Instance; }
+
+		// owner - tag for Cancel(); onLoaded receives a model the caller owns,
+		// or a TextureCache handle (resident textures call back immediately)
+		void LoadModel(const std::string& path, const void* owner, ModelCallback onLoaded);
+		void LoadTexture(const std::string& path, aiTextureType type, const void* owner, TextureCallback onLoaded);
+
+		// Drop every pending callback registered by owner (e.g. a scene being destroyed)
+		void Cancel(const void* owner);
+
+		// GL thread: upload finished assets until budgetMs is spent (at least one per call)
+		void ProcessUploads(float budgetMs);
+
+		unsigned GetPendingCount() const { return m_Pending; }
+
+	private:
+		template <typename T>
+		struct Request
+		{
+			const void* s_Owner;
+			T s_Callback;
+		};
+
+		struct TextureKey
+		{
+			std::string s_Path;
+			aiTextureType s_Type;
+
+			bool operator==(const TextureKey& other) const { return s_Path == other.s_Path && s_Type == other.s_Type; }
+		};
+
+		struct TextureKeyHash
+		{
+			size_t operator()(const TextureKey& k) const { return std::hash<std::string>{}(k.s_Path) ^ k.s_Type; }
+		};
+
+		void WorkerLoop();
+
+		void PushJob(std::function<void()> job);
+		// Blocks the worker while the upload queue is full
+		void PushUpload(std::function<void()> upload);
+
+		void FinishModel(const ModelData& data);
+		void FinishTexture(const TextureKey& key, const ImageData& image);
+
+		std::vector<std::thread> m_Workers;
+
+		std::deque<std::function<void()>> m_Jobs;
+		std::mutex m_JobMutex;
+		std::condition_variable m_JobReady;
+
+		std::deque<std::function<void()>> m_Uploads;
+		std::mutex m_UploadMutex;
+		std::condition_variable m_UploadSpace;
+		size_t m_MaxUploads = 16;
+
+		bool m_Stopping = false;
+		std::atomic<unsigned> m_Pending = 0;
+
+		// GL thread only; one import per path no matter how many requests. In-flight
+		// state is kept apart from the callbacks so a request made after Cancel()
+		// joins the running import instead of starting a second one
+		std::unordered_map<std::string, std::vector<Request<ModelCallback>>> m_ModelRequests;
+		std::unordered_map<TextureKey, std::vector<Request<TextureCallback>>, TextureKeyHash> m_TextureRequests;
+		std::unordered_set<std::string> m_ModelsInFlight;
+		std::unordered_set<TextureKey, TextureKeyHash> m_TexturesInFlight;
+
+		static AssetLoader* m_Instance;
+	};
+}
+
+#endif
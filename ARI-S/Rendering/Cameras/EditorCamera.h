@@ -33,6 +33,9 @@ namespace ARIS
 		glm::quat GetOrientation() const;
 
 		float GetPitch() const { return m_Pitch; }
+
+		float GetNearClip() const { return m_Near; }
+		float GetFarClip() const { return m_Far; }
 		float GetYaw() const { return m_Yaw; }
 
 	private:
@@ -0,0 +1,862 @@
+#include <arpch.h>
+#include "BlockCompressor.h"
+
+#include "Timer.h"
+
+#include <cmath>
+#include <cstring>
+#include <cfloat>
+#include <climits>
+
+namespace ARIS
+{
+	namespace
+	{
+		// Principal axis of a block's texels (channels 0..n-1) by power iteration
+		void PrincipalAxis(const float texels[16][4], int channels, float mean[4], float axis[4])
+		{
+			for (int c = 0; c < 4; ++c)
+			{
+				mean[c] = 0.0f;
+				axis[c] = c < channels ? 1.0f : 0.0f;
+			}
+
+			for (int i = 0; i < 16; ++i)
+			{
+				for (int c = 0; c < channels; ++c)
+				{
+					mean[c] += texels[i][c] / 16.0f;
+				}
+			}
+
+			float cov[4][4] = {};
+			for (int i = 0; i < 16; ++i)
+			{
+				for (int a = 0; a < channels; ++a)
+				{
+					for (int b = 0; b < channels; ++b)
+					{
+						cov[a][b] += (texels[i][a] - mean[a]) * (texels[i][b] - mean[b]);
+					}
+				}
+			}
+
+			for (int iter = 0; iter < 8; ++iter)
+			{
+				float next[4] = {};
+				float length = 0.0f;
+				for (int a = 0; a < channels; ++a)
+				{
+					for (int b = 0; b < channels; ++b)
+					{
+						next[a] += cov[a][b] * axis[b];
+					}
+					length += next[a] * next[a];
+				}
+
+				// flat block; any axis will do
+				if (length < 1e-8f)
+					return;
+
+				length = std::sqrt(length);
+				for (int a = 0; a < channels; ++a)
+				{
+					axis[a] = next[a] / length;
+				}
+			}
+		}
+
+		// Texels with the lowest and highest projection onto the principal axis
+		void AxisExtremes(const float texels[16][4], int channels, float lo[4], float hi[4])
+		{
+			float mean[4], axis[4];
+			PrincipalAxis(texels, channels, mean, axis);
+
+			float minP = FLT_MAX, maxP = -FLT_MAX;
+			int minI = 0, maxI = 0;
+			for (int i = 0; i < 16; ++i)
+			{
+				float p = 0.0f;
+				for (int c = 0; c < channels; ++c)
+				{
+					p += (texels[i][c] - mean[c]) * axis[c];
+				}
+
+				if (p < minP) { minP = p; minI = i; }
+				if (p > maxP) { maxP = p; maxI = i; }
+			}
+
+			for (int c = 0; c < 4; ++c)
+			{
+				lo[c] = texels[minI][c];
+				hi[c] = texels[maxI][c];
+			}
+		}
+
+		void LoadBlock(const uint8_t* block, float texels[16][4])
+		{
+			for (int i = 0; i < 16; ++i)
+			{
+				for (int c = 0; c < 4; ++c)
+				{
+					texels[i][c] = block[i * 4 + c];
+				}
+			}
+		}
+
+		uint16_t To565(const float c[3])
+		{
+			int r = std::clamp(static_cast<int>(std::lround(c[0] * 31.0f / 255.0f)), 0, 31);
+			int g = std::clamp(static_cast<int>(std::lround(c[1] * 63.0f / 255.0f)), 0, 63);
+			int b = std::clamp(static_cast<int>(std::lround(c[2] * 31.0f / 255.0f)), 0, 31);
+			return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+		}
+
+		void From565(uint16_t v, float c[3])
+		{
+			int r = (v >> 11) & 31, g = (v >> 5) & 63, b = v & 31;
+			c[0] = static_cast<float>((r << 3) | (r >> 2));
+			c[1] = static_cast<float>((g << 2) | (g >> 4));
+			c[2] = static_cast<float>((b << 3) | (b >> 2));
+		}
+
+		// One channel as a BC4 block (also the alpha of BC3 and both halves of BC5)
+		void EncodeChannel(const uint8_t* block, int channel, uint8_t* out)
+		{
+			int lo = 255, hi = 0;
+			for (int i = 0; i < 16; ++i)
+			{
+				lo = std::min<int>(lo, block[i * 4 + channel]);
+				hi = std::max<int>(hi, block[i * 4 + channel]);
+			}
+
+			out[0] = static_cast<uint8_t>(hi);
+			out[1] = static_cast<uint8_t>(lo);
+
+			// hi > lo selects the 8-value palette; equal endpoints just use index 0
+			int palette[8] = { hi, lo };
+			for (int i = 2; i < 8; ++i)
+			{
+				palette[i] = ((8 - i) * hi + (i - 1) * lo) / 7;
+			}
+
+			uint64_t bits = 0;
+			for (int i = 0; i < 16 && hi != lo; ++i)
+			{
+				int v = block[i * 4 + channel];
+				int best = 0, bestErr = INT_MAX;
+				for (int p = 0; p < 8; ++p)
+				{
+					int err = std::abs(palette[p] - v);
+					if (err < bestErr) { bestErr = err; best = p; }
+				}
+
+				bits |= static_cast<uint64_t>(best) << (3 * i);
+			}
+
+			for (int b = 0; b < 6; ++b)
+			{
+				out[2 + b] = static_cast<uint8_t>(bits >> (8 * b));
+			}
+		}
+
+		// LSB-first bit packing for BC7
+		class BitWriter
+		{
+		public:
+			BitWriter(uint8_t* out)
+				: m_Out(out)
+			{
+				std::memset(m_Out, 0, 16);
+			}
+
+			void Write(uint32_t value, int bits)
+			{
+				for (int i = 0; i < bits; ++i, ++m_Pos)
+				{
+					if (value & (1u << i))
+						m_Out[m_Pos >> 3] |= static_cast<uint8_t>(1u << (m_Pos & 7));
+				}
+			}
+
+		private:
+			uint8_t* m_Out;
+			int m_Pos = 0;
+		};
+
+		const int BC7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+		struct BC7Endpoints
+		{
+			int s_Color[2][4]; // 7-bit
+			int s_PBit[2];
+
+			int Value(int e, int c) const { return (s_Color[e][c] << 1) | s_PBit[e]; }
+		};
+
+		// Quantize an endpoint to 7 bits + shared p-bit, picking the p-bit with the lower error
+		void QuantizeBC7(const float e[4], int color[4], int& pbit)
+		{
+			float bestErr = FLT_MAX;
+			for (int p = 0; p < 2; ++p)
+			{
+				int q[4];
+				float err = 0.0f;
+				for (int c = 0; c < 4; ++c)
+				{
+					q[c] = std::clamp(static_cast<int>(std::lround((e[c] - p) / 2.0f)), 0, 127);
+					float d = static_cast<float>((q[c] << 1) | p) - e[c];
+					err += d * d;
+				}
+
+				if (err < bestErr)
+				{
+					bestErr = err;
+					pbit = p;
+					std::memcpy(color, q, sizeof(q));
+				}
+			}
+		}
+
+		float AssignBC7(const float texels[16][4], const BC7Endpoints& ep, int indices[16])
+		{
+			float palette[16][4];
+			for (int i = 0; i < 16; ++i)
+			{
+				for (int c = 0; c < 4; ++c)
+				{
+					palette[i][c] = static_cast<float>(((64 - BC7Weights[i]) * ep.Value(0, c) + BC7Weights[i] * ep.Value(1, c) + 32) >> 6);
+				}
+			}
+
+			float total = 0.0f;
+			for (int t = 0; t < 16; ++t)
+			{
+				float bestErr = FLT_MAX;
+				for (int i = 0; i < 16; ++i)
+				{
+					float err = 0.0f;
+					for (int c = 0; c < 4; ++c)
+					{
+						float d = palette[i][c] - texels[t][c];
+						err += d * d;
+					}
+
+					if (err < bestErr) { bestErr = err; indices[t] = i; }
+				}
+				total += bestErr;
+			}
+
+			return total;
+		}
+
+		// Least-squares endpoints for fixed indices
+		bool RefitBC7(const float texels[16][4], const int indices[16], float lo[4], float hi[4])
+		{
+			float a = 0.0f, b = 0.0f, c = 0.0f;
+			float x0[4] = {}, x1[4] = {};
+			for (int t = 0; t < 16; ++t)
+			{
+				float w = BC7Weights[indices[t]] / 64.0f;
+				a += (1.0f - w) * (1.0f - w);
+				b += (1.0f - w) * w;
+				c += w * w;
+				for (int ch = 0; ch < 4; ++ch)
+				{
+					x0[ch] += (1.0f - w) * texels[t][ch];
+					x1[ch] += w * texels[t][ch];
+				}
+			}
+
+			float det = a * c - b * b;
+			if (std::fabs(det) < 1e-6f)
+				return false;
+
+			for (int ch = 0; ch < 4; ++ch)
+			{
+				lo[ch] = std::clamp((c * x0[ch] - b * x1[ch]) / det, 0.0f, 255.0f);
+				hi[ch] = std::clamp((a * x1[ch] - b * x0[ch]) / det, 0.0f, 255.0f);
+			}
+
+			return true;
+		}
+
+		// Spec BC4 palette: 8 values if e0 > e1, otherwise 6 plus 0 and 255
+		void DecodeChannel(const uint8_t* in, int channel, uint8_t* block)
+		{
+			int e0 = in[0], e1 = in[1];
+
+			int palette[8] = { e0, e1 };
+			if (e0 > e1)
+			{
+				for (int i = 2; i < 8; ++i)
+				{
+					palette[i] = ((8 - i) * e0 + (i - 1) * e1 + 3) / 7;
+				}
+			}
+			else
+			{
+				for (int i = 2; i < 6; ++i)
+				{
+					palette[i] = ((6 - i) * e0 + (i - 1) * e1 + 2) / 5;
+				}
+				palette[6] = 0;
+				palette[7] = 255;
+			}
+
+			uint64_t bits = 0;
+			for (int b = 0; b < 6; ++b)
+			{
+				bits |= static_cast<uint64_t>(in[2 + b]) << (8 * b);
+			}
+
+			for (int i = 0; i < 16; ++i)
+			{
+				block[i * 4 + channel] = static_cast<uint8_t>(palette[(bits >> (3 * i)) & 7]);
+			}
+		}
+
+		// BC1 colour; BC3's colour half always uses the four-colour palette
+		void DecodeColor(const uint8_t* in, bool allowTransparent, uint8_t* block)
+		{
+			uint16_t c0 = static_cast<uint16_t>(in[0] | (in[1] << 8));
+			uint16_t c1 = static_cast<uint16_t>(in[2] | (in[3] << 8));
+
+			float palette[4][4];
+			From565(c0, palette[0]);
+			From565(c1, palette[1]);
+			palette[0][3] = palette[1][3] = 255.0f;
+
+			bool fourColor = c0 > c1 || !allowTransparent;
+			for (int c = 0; c < 3; ++c)
+			{
+				if (fourColor)
+				{
+					palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+					palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+				}
+				else
+				{
+					palette[2][c] = (palette[0][c] + palette[1][c]) / 2.0f;
+					palette[3][c] = 0.0f;
+				}
+			}
+			palette[2][3] = 255.0f;
+			palette[3][3] = fourColor ? 255.0f : 0.0f;
+
+			uint32_t indices = in[4] | (in[5] << 8) | (in[6] << 16) | (static_cast<uint32_t>(in[7]) << 24);
+			for (int i = 0; i < 16; ++i)
+			{
+				const float* p = palette[(indices >> (2 * i)) & 3];
+				for (int c = 0; c < 4; ++c)
+				{
+					block[i * 4 + c] = static_cast<uint8_t>(std::lround(p[c]));
+				}
+			}
+		}
+
+		// LSB-first bit reading for BC7
+		class BitReader
+		{
+		public:
+			BitReader(const uint8_t* in)
+				: m_In(in)
+			{
+			}
+
+			uint32_t Read(int bits)
+			{
+				uint32_t value = 0;
+				for (int i = 0; i < bits; ++i, ++m_Pos)
+				{
+					value |= static_cast<uint32_t>((m_In[m_Pos >> 3] >> (m_Pos & 7)) & 1) << i;
+				}
+
+				return value;
+			}
+
+		private:
+			const uint8_t* m_In;
+			int m_Pos = 0;
+		};
+
+		float SRGBToLinear(float v)
+		{
+			return v <= 0.04045f ? v / 12.92f : std::pow((v + 0.055f) / 1.055f, 2.4f);
+		}
+
+		float LinearToSRGB(float v)
+		{
+			return v <= 0.0031308f ? v * 12.92f : 1.055f * std::pow(v, 1.0f / 2.4f) - 0.055f;
+		}
+
+		const float* SRGBTable()
+		{
+			static const std::vector<float> table = []
+			{
+				std::vector<float> t(256);
+				for (int i = 0; i < 256; ++i)
+				{
+					t[i] = SRGBToLinear(i / 255.0f);
+				}
+				return t;
+			}();
+
+			return table.data();
+		}
+	}
+
+	size_t BlockCompressor::GetBlockBytes(Format format)
+	{
+		return format == Format::BC1 || format == Format::BC4 ? 8 : 16;
+	}
+
+	size_t BlockCompressor::GetLevelSize(Format format, int width, int height)
+	{
+		size_t blocksX = (std::max(width, 1) + 3) / 4;
+		size_t blocksY = (std::max(height, 1) + 3) / 4;
+		return blocksX * blocksY * GetBlockBytes(format);
+	}
+
+	std::vector<uint8_t> BlockCompressor::Compress(const uint8_t* rgba, int width, int height, Format format)
+	{
+		int blocksX = (width + 3) / 4;
+		int blocksY = (height + 3) / 4;
+		size_t blockBytes = GetBlockBytes(format);
+
+		std::vector<uint8_t> out(GetLevelSize(format, width, height));
+
+		#pragma omp parallel for schedule(dynamic)
+		for (int by = 0; by < blocksY; ++by)
+		{
+			uint8_t block[64];
+			for (int bx = 0; bx < blocksX; ++bx)
+			{
+				for (int y = 0; y < 4; ++y)
+				{
+					int sy = std::min(by * 4 + y, height - 1);
+					for (int x = 0; x < 4; ++x)
+					{
+						int sx = std::min(bx * 4 + x, width - 1);
+						std::memcpy(&block[(y * 4 + x) * 4], &rgba[(static_cast<size_t>(sy) * width + sx) * 4], 4);
+					}
+				}
+
+				uint8_t* dst = &out[(static_cast<size_t>(by) * blocksX + bx) * blockBytes];
+				switch (format)
+				{
+				case Format::BC1:
+					EncodeBC1(block, dst);
+					break;
+				case Format::BC3:
+					EncodeBC3(block, dst);
+					break;
+				case Format::BC4:
+					EncodeBC4(block, dst);
+					break;
+				case Format::BC5:
+					EncodeBC5(block, dst);
+					break;
+				case Format::BC7:
+					EncodeBC7(block, dst);
+					break;
+				}
+			}
+		}
+
+		return out;
+	}
+
+	std::vector<uint8_t> BlockCompressor::Downsample(const uint8_t* rgba, int width, int height, bool srgb, bool normals)
+	{
+		int nw = std::max(1, width / 2);
+		int nh = std::max(1, height / 2);
+
+		std::vector<uint8_t> out(static_cast<size_t>(nw) * nh * 4);
+
+		const float* toLinear = SRGBTable();
+
+		#pragma omp parallel for
+		for (int y = 0; y < nh; ++y)
+		{
+			for (int x = 0; x < nw; ++x)
+			{
+				const uint8_t* src[4] = {
+					&rgba[(static_cast<size_t>(std::min(2 * y, height - 1)) * width + std::min(2 * x, width - 1)) * 4],
+					&rgba[(static_cast<size_t>(std::min(2 * y, height - 1)) * width + std::min(2 * x + 1, width - 1)) * 4],
+					&rgba[(static_cast<size_t>(std::min(2 * y + 1, height - 1)) * width + std::min(2 * x, width - 1)) * 4],
+					&rgba[(static_cast<size_t>(std::min(2 * y + 1, height - 1)) * width + std::min(2 * x + 1, width - 1)) * 4]
+				};
+
+				uint8_t* dst = &out[(static_cast<size_t>(y) * nw + x) * 4];
+
+				float sum[4] = {};
+				for (const uint8_t* s : src)
+				{
+					if (normals)
+					{
+						float nx = s[0] / 127.5f - 1.0f;
+						float ny = s[1] / 127.5f - 1.0f;
+						sum[0] += nx;
+						sum[1] += ny;
+						sum[2] += std::sqrt(std::max(0.0f, 1.0f - nx * nx - ny * ny));
+					}
+					else
+					{
+						for (int c = 0; c < 3; ++c)
+						{
+							sum[c] += srgb ? toLinear[s[c]] : s[c] / 255.0f;
+						}
+					}
+					sum[3] += s[3] / 255.0f;
+				}
+
+				if (normals)
+				{
+					float length = std::sqrt(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+					for (int c = 0; c < 3; ++c)
+					{
+						float n = length > 0.0f ? sum[c] / length : (c == 2 ? 1.0f : 0.0f);
+						dst[c] = static_cast<uint8_t>(std::clamp(std::lround((n * 0.5f + 0.5f) * 255.0f), 0L, 255L));
+					}
+				}
+				else
+				{
+					for (int c = 0; c < 3; ++c)
+					{
+						float v = sum[c] * 0.25f;
+						v = srgb ? LinearToSRGB(v) : v;
+						dst[c] = static_cast<uint8_t>(std::clamp(std::lround(v * 255.0f), 0L, 255L));
+					}
+				}
+				dst[3] = static_cast<uint8_t>(std::clamp(std::lround(sum[3] * 0.25f * 255.0f), 0L, 255L));
+			}
+		}
+
+		return out;
+	}
+
+	std::vector<uint8_t> BlockCompressor::ExpandToRGBA(const uint8_t* pixels, int width, int height, int channels, bool greyToRGB)
+	{
+		size_t count = static_cast<size_t>(width) * height;
+		std::vector<uint8_t> out(count * 4);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			const uint8_t* s = &pixels[i * channels];
+			uint8_t* d = &out[i * 4];
+
+			if (channels <= 2)
+			{
+				d[0] = s[0];
+				d[1] = greyToRGB ? s[0] : (channels == 2 ? s[1] : 0);
+				d[2] = greyToRGB ? s[0] : 0;
+				d[3] = channels == 2 && greyToRGB ? s[1] : 255;
+			}
+			else
+			{
+				d[0] = s[0];
+				d[1] = s[1];
+				d[2] = s[2];
+				d[3] = channels == 4 ? s[3] : 255;
+			}
+		}
+
+		return out;
+	}
+
+	void BlockCompressor::EncodeBC1(const uint8_t* block, uint8_t* out)
+	{
+		float texels[16][4];
+		LoadBlock(block, texels);
+
+		float lo[4], hi[4];
+		AxisExtremes(texels, 3, lo, hi);
+
+		uint16_t c0 = To565(hi);
+		uint16_t c1 = To565(lo);
+
+		// c0 > c1 selects the opaque four-colour palette
+		if (c0 < c1)
+			std::swap(c0, c1);
+
+		float palette[4][3];
+		From565(c0, palette[0]);
+		From565(c1, palette[1]);
+		for (int c = 0; c < 3; ++c)
+		{
+			palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+			palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+		}
+
+		uint32_t indices = 0;
+		for (int i = 0; i < 16 && c0 != c1; ++i)
+		{
+			int best = 0;
+			float bestErr = FLT_MAX;
+			for (int p = 0; p < 4; ++p)
+			{
+				float err = 0.0f;
+				for (int c = 0; c < 3; ++c)
+				{
+					float d = palette[p][c] - texels[i][c];
+					err += d * d;
+				}
+
+				if (err < bestErr) { bestErr = err; best = p; }
+			}
+
+			indices |= static_cast<uint32_t>(best) << (2 * i);
+		}
+
+		out[0] = static_cast<uint8_t>(c0);
+		out[1] = static_cast<uint8_t>(c0 >> 8);
+		out[2] = static_cast<uint8_t>(c1);
+		out[3] = static_cast<uint8_t>(c1 >> 8);
+		for (int b = 0; b < 4; ++b)
+		{
+			out[4 + b] = static_cast<uint8_t>(indices >> (8 * b));
+		}
+	}
+
+	void BlockCompressor::EncodeBC3(const uint8_t* block, uint8_t* out)
+	{
+		EncodeChannel(block, 3, out);
+		EncodeBC1(block, out + 8);
+	}
+
+	void BlockCompressor::EncodeBC4(const uint8_t* block, uint8_t* out)
+	{
+		EncodeChannel(block, 0, out);
+	}
+
+	void BlockCompressor::EncodeBC5(const uint8_t* block, uint8_t* out)
+	{
+		EncodeChannel(block, 0, out);
+		EncodeChannel(block, 1, out + 8);
+	}
+
+	void BlockCompressor::EncodeBC7(const uint8_t* block, uint8_t* out)
+	{
+		float texels[16][4];
+		LoadBlock(block, texels);
+
+		float lo[4], hi[4];
+		AxisExtremes(texels, 4, lo, hi);
+
+		BC7Endpoints best;
+		int bestIndices[16];
+		QuantizeBC7(lo, best.s_Color[0], best.s_PBit[0]);
+		QuantizeBC7(hi, best.s_Color[1], best.s_PBit[1]);
+		float bestErr = AssignBC7(texels, best, bestIndices);
+
+		// a couple of least-squares passes usually pull the endpoints in noticeably
+		for (int iter = 0; iter < 2 && bestErr > 0.0f; ++iter)
+		{
+			if (!RefitBC7(texels, bestIndices, lo, hi))
+				break;
+
+			BC7Endpoints ep;
+			int indices[16];
+			QuantizeBC7(lo, ep.s_Color[0], ep.s_PBit[0]);
+			QuantizeBC7(hi, ep.s_Color[1], ep.s_PBit[1]);
+			float err = AssignBC7(texels, ep, indices);
+
+			if (err >= bestErr)
+				break;
+
+			best = ep;
+			bestErr = err;
+			std::memcpy(bestIndices, indices, sizeof(indices));
+		}
+
+		// the first index is stored without its top bit, so it must be < 8
+		if (bestIndices[0] >= 8)
+		{
+			std::swap(best.s_Color[0], best.s_Color[1]);
+			std::swap(best.s_PBit[0], best.s_PBit[1]);
+			for (int& i : bestIndices)
+			{
+				i = 15 - i;
+			}
+		}
+
+		BitWriter bits(out);
+		bits.Write(1u << 6, 7); // mode 6
+
+		for (int c = 0; c < 4; ++c)
+		{
+			bits.Write(best.s_Color[0][c], 7);
+			bits.Write(best.s_Color[1][c], 7);
+		}
+
+		bits.Write(best.s_PBit[0], 1);
+		bits.Write(best.s_PBit[1], 1);
+
+		bits.Write(bestIndices[0], 3);
+		for (int i = 1; i < 16; ++i)
+		{
+			bits.Write(bestIndices[i], 4);
+		}
+	}
+
+	void BlockCompressor::DecodeBC1(const uint8_t* in, uint8_t* block)
+	{
+		DecodeColor(in, true, block);
+	}
+
+	void BlockCompressor::DecodeBC3(const uint8_t* in, uint8_t* block)
+	{
+		DecodeColor(in + 8, false, block);
+		DecodeChannel(in, 3, block);
+	}
+
+	void BlockCompressor::DecodeBC4(const uint8_t* in, uint8_t* block)
+	{
+		for (int i = 0; i < 16; ++i)
+		{
+			block[i * 4 + 1] = block[i * 4 + 2] = 0;
+			block[i * 4 + 3] = 255;
+		}
+
+		DecodeChannel(in, 0, block);
+	}
+
+	void BlockCompressor::DecodeBC5(const uint8_t* in, uint8_t* block)
+	{
+		for (int i = 0; i < 16; ++i)
+		{
+			block[i * 4 + 2] = 0;
+			block[i * 4 + 3] = 255;
+		}
+
+		DecodeChannel(in, 0, block);
+		DecodeChannel(in + 8, 1, block);
+	}
+
+	void BlockCompressor::DecodeBC7(const uint8_t* in, uint8_t* block)
+	{
+		std::memset(block, 0, 64);
+
+		BitReader bits(in);
+
+		// the mode is the position of the first set bit
+		int mode = 0;
+		while (mode < 8 && bits.Read(1) == 0)
+		{
+			++mode;
+		}
+
+		if (mode != 6)
+			return;
+
+		int endpoints[2][4];
+		for (int c = 0; c < 4; ++c)
+		{
+			endpoints[0][c] = bits.Read(7);
+			endpoints[1][c] = bits.Read(7);
+		}
+
+		for (int e = 0; e < 2; ++e)
+		{
+			int pbit = bits.Read(1);
+			for (int c = 0; c < 4; ++c)
+			{
+				endpoints[e][c] = (endpoints[e][c] << 1) | pbit;
+			}
+		}
+
+		for (int i = 0; i < 16; ++i)
+		{
+			int w = BC7Weights[bits.Read(i == 0 ? 3 : 4)];
+			for (int c = 0; c < 4; ++c)
+			{
+				block[i * 4 + c] = static_cast<uint8_t>(((64 - w) * endpoints[0][c] + w * endpoints[1][c] + 32) >> 6);
+			}
+		}
+	}
+
+	std::vector<uint8_t> BlockCompressor::Decompress(const uint8_t* data, int width, int height, Format format)
+	{
+		int blocksX = (width + 3) / 4;
+		int blocksY = (height + 3) / 4;
+		size_t blockBytes = GetBlockBytes(format);
+
+		std::vector<uint8_t> out(static_cast<size_t>(width) * height * 4);
+
+		#pragma omp parallel for
+		for (int by = 0; by < blocksY; ++by)
+		{
+			uint8_t block[64];
+			for (int bx = 0; bx < blocksX; ++bx)
+			{
+				const uint8_t* src = &data[(static_cast<size_t>(by) * blocksX + bx) * blockBytes];
+				switch (format)
+				{
+				case Format::BC1:
+					DecodeBC1(src, block);
+					break;
+				case Format::BC3:
+					DecodeBC3(src, block);
+					break;
+				case Format::BC4:
+					DecodeBC4(src, block);
+					break;
+				case Format::BC5:
+					DecodeBC5(src, block);
+					break;
+				case Format::BC7:
+					DecodeBC7(src, block);
+					break;
+				}
+
+				// drop the texels that only pad out edge blocks
+				for (int y = 0; y < 4 && by * 4 + y < height; ++y)
+				{
+					for (int x = 0; x < 4 && bx * 4 + x < width; ++x)
+					{
+						size_t dst = (static_cast<size_t>(by * 4 + y) * width + bx * 4 + x) * 4;
+						std::memcpy(&out[dst], &block[(y * 4 + x) * 4], 4);
+					}
+				}
+			}
+		}
+
+		return out;
+	}
+
+	std::vector<BlockCompressor::RoundTrip> BlockCompressor::CheckRoundTrip(const uint8_t* rgba, int width, int height)
+	{
+		// channels each format stores (BC1 is treated as opaque RGB)
+		const std::pair<Format, int> formats[] = {
+			{ Format::BC1, 3 }, { Format::BC3, 4 }, { Format::BC4, 1 }, { Format::BC5, 2 }, { Format::BC7, 4 } };
+
+		std::vector<RoundTrip> results;
+		for (const auto& [format, channels] : formats)
+		{
+			Timer timer;
+			std::vector<uint8_t> blocks = Compress(rgba, width, height, format);
+			float encodeMs = timer.ElapsedMillis();
+
+			std::vector<uint8_t> decoded = Decompress(blocks.data(), width, height, format);
+
+			double sum = 0.0;
+			for (size_t i = 0; i < decoded.size(); i += 4)
+			{
+				for (int c = 0; c < channels; ++c)
+				{
+					double d = static_cast<double>(decoded[i + c]) - rgba[i + c];
+					sum += d * d;
+				}
+			}
+
+			size_t samples = std::max<size_t>(static_cast<size_t>(width) * height * channels, 1);
+			float rmse = static_cast<float>(std::sqrt(sum / samples));
+			float psnr = rmse > 0.0f ? 20.0f * std::log10(255.0f / rmse) : 99.0f;
+
+			results.push_back({ format, rmse, psnr, encodeMs });
+		}
+
+		return results;
+	}
+}
@@ -0,0 +1,73 @@
+#ifndef BLOCKCOMPRESSOR_H
+#define BLOCKCOMPRESSOR_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace ARIS
+{
+	// CPU encoder for the BCn block formats. Pure CPU (no GL), operating on
+	// tightly packed RGBA8 images; each 4x4 block is encoded independently.
+	//   BC1 - RGB, 4 bpp
+	//   BC3 - RGB + interpolated alpha, 8 bpp
+	//   BC4 - one channel (R), 4 bpp
+	//   BC5 - two channels (R, G), 8 bpp
+	//   BC7 - RGBA, 8 bpp (mode 6 only: one subset, 7.7.7.7 + p-bit endpoints, 4-bit indices)
+	class BlockCompressor
+	{
+	public:
+		enum class Format : uint32_t
+		{
+			BC1 = 1,
+			BC3 = 3,
+			BC4 = 4,
+			BC5 = 5,
+			BC7 = 7
+		};
+
+		static size_t GetBlockBytes(Format format);
+		static size_t GetLevelSize(Format format, int width, int height);
+
+		// Encode a whole image (edge blocks clamp to the last row/column)
+		static std::vector<uint8_t> Compress(const uint8_t* rgba, int width, int height, Format format);
+
+		// Next mip level (half size, 2x2 box filter). srgb averages in linear space;
+		// normals averages unit vectors rebuilt from R/G and renormalises them.
+		static std::vector<uint8_t> Downsample(const uint8_t* rgba, int width, int height, bool srgb, bool normals);
+
+		// Expand 1-4 channel pixels to RGBA8; grey sources fill RGB when greyToRGB is set
+		static std::vector<uint8_t> ExpandToRGBA(const uint8_t* pixels, int width, int height, int channels, bool greyToRGB);
+
+		// block - 16 RGBA8 texels, row-major
+		static void EncodeBC1(const uint8_t* block, uint8_t* out);
+		static void EncodeBC3(const uint8_t* block, uint8_t* out);
+		static void EncodeBC4(const uint8_t* block, uint8_t* out);
+		static void EncodeBC5(const uint8_t* block, uint8_t* out);
+		static void EncodeBC7(const uint8_t* block, uint8_t* out);
+
+		// Reference decoders (format spec, independent of the encoders' palettes);
+		// out - 16 RGBA8 texels. BC7 only decodes mode 6, other modes come out as 0.
+		static void DecodeBC1(const uint8_t* in, uint8_t* block);
+		static void DecodeBC3(const uint8_t* in, uint8_t* block);
+		static void DecodeBC4(const uint8_t* in, uint8_t* block);
+		static void DecodeBC5(const uint8_t* in, uint8_t* block);
+		static void DecodeBC7(const uint8_t* in, uint8_t* block);
+
+		// Decode a whole level back to tightly packed RGBA8
+		static std::vector<uint8_t> Decompress(const uint8_t* data, int width, int height, Format format);
+
+		struct RoundTrip
+		{
+			Format s_Format;
+			float s_RMSE;     // over the channels the format stores, in 8-bit steps
+			float s_PSNR;     // dB
+			float s_EncodeMs;
+		};
+
+		// Encode and decode an image in every format and measure the error (CPU only)
+		static std::vector<RoundTrip> CheckRoundTrip(const uint8_t* rgba, int width, int height);
+	};
+}
+
+#endif
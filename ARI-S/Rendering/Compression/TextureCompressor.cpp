@@ -0,0 +1,316 @@
+#include <arpch.h>
+#include "TextureCompressor.h"
+#include "MappedFile.h"
+
+#include <cstring>
+#include <mutex>
+
+namespace ARIS
+{
+	bool TextureCompressor::m_Enabled = true;
+	bool TextureCompressor::m_FastColor = false;
+
+	namespace
+	{
+		constexpr uint32_t CacheMagic = 0x58545241; // "ARTX" in file byte order
+
+		struct CacheHeader
+		{
+			uint32_t s_Magic;
+			uint32_t s_Version;
+			uint64_t s_SourceHash;
+			uint32_t s_Format;
+			uint32_t s_SRGB;
+			uint32_t s_FastColor;
+			uint32_t s_Width;
+			uint32_t s_Height;
+			uint32_t s_Levels;
+			uint32_t s_Channels;
+		};
+
+		enum class Role
+		{
+			None,
+			Color,
+			Data,
+			Normal,
+			Packed
+		};
+
+		Role GetRole(aiTextureType type)
+		{
+			if (Texture::IsColorData(type))
+				return Role::Color;
+
+			switch (type)
+			{
+			case aiTextureType_METALNESS:
+			case aiTextureType_DIFFUSE_ROUGHNESS:
+			case aiTextureType_AMBIENT_OCCLUSION:
+			case aiTextureType_LIGHTMAP:
+			case aiTextureType_SPECULAR:
+			case aiTextureType_HEIGHT:
+				return Role::Data;
+			case aiTextureType_NORMALS:
+				return Role::Normal;
+			case aiTextureType_UNKNOWN:
+				return Role::Packed;
+			default:
+				return Role::None;
+			}
+		}
+
+		GLenum GetGLFormat(BlockCompressor::Format format, bool srgb)
+		{
+			switch (format)
+			{
+			case BlockCompressor::Format::BC1:
+				return srgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+			case BlockCompressor::Format::BC3:
+				return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+			case BlockCompressor::Format::BC4:
+				return GL_COMPRESSED_RED_RGTC1;
+			case BlockCompressor::Format::BC5:
+				return GL_COMPRESSED_RG_RGTC2;
+			case BlockCompressor::Format::BC7:
+				return srgb ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM : GL_COMPRESSED_RGBA_BPTC_UNORM;
+			}
+
+			return 0;
+		}
+
+		// concurrent imports can reference the same image
+		std::mutex s_WriteMutex;
+	}
+
+	std::string TextureCompressor::GetCachePath(const std::string& path, aiTextureType type)
+	{
+		const char* role = "";
+		switch (GetRole(type))
+		{
+		case Role::Color:
+			role = "color";
+			break;
+		case Role::Data:
+			role = "data";
+			break;
+		case Role::Normal:
+			role = "normal";
+			break;
+		default:
+			role = "packed";
+			break;
+		}
+
+		return path + "." + role + ".aristex";
+	}
+
+	unsigned TextureCompressor::GetBitsPerTexel(GLenum format)
+	{
+		switch (format)
+		{
+		case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RED_RGTC1:
+			return 4;
+		case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+		case GL_COMPRESSED_RG_RGTC2:
+		case GL_COMPRESSED_RGBA_BPTC_UNORM:
+		case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+			return 8;
+		default:
+			return 0;
+		}
+	}
+
+	bool TextureCompressor::Load(const std::string& path, aiTextureType type, ImageData& image)
+	{
+		if (!m_Enabled || GetRole(type) == Role::None)
+			return false;
+
+		uint64_t hash = MappedFile::HashContents(path);
+		if (hash == 0)
+			return false;
+
+		return ReadCache(path, type, hash, image) || Build(path, type, hash, image);
+	}
+
+	std::vector<BlockCompressor::RoundTrip> TextureCompressor::CheckRoundTrip(const std::string& path)
+	{
+		ImageData source = Texture::Decode(path);
+		if (!source.s_Pixels || source.s_HDR)
+			return {};
+
+		std::vector<uint8_t> rgba = BlockCompressor::ExpandToRGBA(static_cast<const uint8_t*>(source.s_Pixels.get()),
+			source.s_Width, source.s_Height, source.s_Channels, true);
+
+		return BlockCompressor::CheckRoundTrip(rgba.data(), source.s_Width, source.s_Height);
+	}
+
+	bool TextureCompressor::Build(const std::string& path, aiTextureType type, uint64_t hash, ImageData& image)
+	{
+		ImageData source = Texture::Decode(path);
+		if (!source.s_Pixels)
+			return false;
+
+		Role role = GetRole(type);
+		bool srgb = role == Role::Color;
+		bool normals = role == Role::Normal;
+
+		int width = source.s_Width, height = source.s_Height;
+		std::vector<uint8_t> rgba = BlockCompressor::ExpandToRGBA(static_cast<const uint8_t*>(source.s_Pixels.get()), 
+			width, height, source.s_Channels, role == Role::Color || role == Role::Packed);
+
+		// the decoded source isn't needed past this point
+		source.s_Pixels.reset();
+
+		BlockCompressor::Format format = BlockCompressor::Format::BC7;
+		if (role == Role::Data)
+		{
+			format = BlockCompressor::Format::BC4;
+		}
+		else if (normals)
+		{
+			format = BlockCompressor::Format::BC5;
+		}
+		else if (role == Role::Color && m_FastColor)
+		{
+			bool opaque = true;
+			for (size_t i = 3; i < rgba.size() && opaque; i += 4)
+			{
+				opaque = rgba[i] == 255;
+			}
+
+			format = opaque ? BlockCompressor::Format::BC1 : BlockCompressor::Format::BC3;
+		}
+
+		// whole chain down to 1x1, matching the level count Texture allocates
+		std::vector<std::vector<uint8_t>> levels;
+		for (int w = width, h = height; ; w = std::max(1, w / 2), h = std::max(1, h / 2))
+		{
+			levels.push_back(BlockCompressor::Compress(rgba.data(), w, h, format));
+
+			if (w == 1 && h == 1)
+				break;
+
+			rgba = BlockCompressor::Downsample(rgba.data(), w, h, srgb, normals);
+		}
+
+		size_t total = 0;
+		for (const auto& level : levels)
+		{
+			total += level.size();
+		}
+
+		auto storage = std::make_shared<std::vector<uint8_t>>();
+		storage->reserve(total);
+
+		image = ImageData();
+		image.s_Width = width;
+		image.s_Height = height;
+		image.s_Channels = source.s_Channels;
+		image.s_CompressedFormat = GetGLFormat(format, srgb);
+
+		for (const auto& level : levels)
+		{
+			image.s_Levels.push_back({ storage->data() + storage->size(), level.size() });
+			storage->insert(storage->end(), level.begin(), level.end());
+		}
+
+		image.s_Pixels = std::shared_ptr<void>(storage, storage->data());
+
+		WriteCache(path, type, hash, format, image);
+
+		return true;
+	}
+
+	bool TextureCompressor::ReadCache(const std::string& path, aiTextureType type, uint64_t hash, ImageData& image)
+	{
+		auto file = std::make_shared<MappedFile>(GetCachePath(path, type));
+		if (!file->IsOpen() || file->GetSize() < sizeof(CacheHeader))
+			return false;
+
+		const uint8_t* data = file->GetData();
+		size_t size = file->GetSize();
+
+		CacheHeader header;
+		std::memcpy(&header, data, sizeof(header));
+
+		bool fast = GetRole(type) == Role::Color && m_FastColor;
+		if (header.s_Magic != CacheMagic || header.s_Version != Version || header.s_SourceHash != hash ||
+			header.s_FastColor != static_cast<uint32_t>(fast) || header.s_Width == 0 || header.s_Height == 0)
+		{
+			return false;
+		}
+
+		BlockCompressor::Format format = static_cast<BlockCompressor::Format>(header.s_Format);
+
+		ImageData result;
+		result.s_Width = header.s_Width;
+		result.s_Height = header.s_Height;
+		result.s_Channels = header.s_Channels;
+		result.s_CompressedFormat = GetGLFormat(format, header.s_SRGB != 0);
+
+		if (result.s_CompressedFormat == 0)
+			return false;
+
+		// validate every level before handing anything out
+		size_t offset = sizeof(CacheHeader);
+		int w = result.s_Width, h = result.s_Height;
+		for (uint32_t l = 0; l < header.s_Levels; ++l)
+		{
+			uint64_t levelSize = 0;
+			if (size - offset < sizeof(levelSize))
+				return false;
+
+			std::memcpy(&levelSize, data + offset, sizeof(levelSize));
+			offset += sizeof(levelSize);
+
+			if (levelSize != BlockCompressor::GetLevelSize(format, w, h) || size - offset < levelSize)
+				return false;
+
+			result.s_Levels.push_back({ data + offset, static_cast<size_t>(levelSize) });
+			offset += static_cast<size_t>(levelSize);
+
+			w = std::max(1, w / 2);
+			h = std::max(1, h / 2);
+		}
+
+		if (result.s_Levels.empty())
+			return false;
+
+		result.s_Pixels = std::shared_ptr<void>(file, const_cast<uint8_t*>(data));
+		image = std::move(result);
+
+		return true;
+	}
+
+	void TextureCompressor::WriteCache(const std::string& path, aiTextureType type, uint64_t hash, 
+		BlockCompressor::Format format, const ImageData& image)
+	{
+		std::lock_guard<std::mutex> lock(s_WriteMutex);
+
+		std::ofstream out(GetCachePath(path, type), std::ios::binary | std::ios::trunc);
+		if (!out)
+		{
+			std::cout << "TEXTURE CACHE ERROR: Could not write " << GetCachePath(path, type) << std::endl;
+			return;
+		}
+
+		bool srgb = GetRole(type) == Role::Color;
+		bool fast = srgb && m_FastColor;
+
+		CacheHeader header = { CacheMagic, Version, hash, static_cast<uint32_t>(format), srgb, fast,
+			static_cast<uint32_t>(image.s_Width), static_cast<uint32_t>(image.s_Height), 
+			static_cast<uint32_t>(image.s_Levels.size()), static_cast<uint32_t>(image.s_Channels) };
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+		for (const auto& [levelData, levelSize] : image.s_Levels)
+		{
+			uint64_t size = levelSize;
+			out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+			out.write(reinterpret_cast<const char*>(levelData), levelSize);
+		}
+	}
+}
@@ -0,0 +1,69 @@
+#ifndef TEXTURECOMPRESSOR_H
+#define TEXTURECOMPRESSOR_H
+
+#include "Texture.h"
+#include "Compression/BlockCompressor.h"
+
+#include <string>
+#include <cstdint>
+
+// S3TC isn't in the core profile loader; the values are fixed by EXT_texture_compression_s3tc
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
+namespace ARIS
+{
+	// Offline BCn pipeline for file textures. A source image is decoded once,
+	// given a full mip chain and block-compressed by its role:
+	//   colour (diffuse / base colour / emissive) - BC7 sRGB (or BC1/BC3 with fast colour)
+	//   single-channel data (metal, roughness, AO, ...) - BC4
+	//   normal maps - BC5 (XY; Z is rebuilt in the shader)
+	//   packed glTF metal/roughness - BC7 linear
+	// The result is stored next to the source as "<image>.<role>.aristex" and
+	// reused on later loads as long as its version and source hash still match.
+	class TextureCompressor
+	{
+	public:
+		// Bump whenever the container layout or the encoder output changes
+		static constexpr uint32_t Version = 1;
+
+		// Fill image with a compressed mip chain for path, building the cache if needed.
+		// Returns false for images that stay uncompressed (HDR, untyped) or can't be read.
+		// No GL calls, so it's safe on worker threads.
+		static bool Load(const std::string& path, aiTextureType type, ImageData& image);
+
+		static std::string GetCachePath(const std::string& path, aiTextureType type);
+
+		// Storage cost of a GL compressed format (0 if it isn't one of ours)
+		static unsigned GetBitsPerTexel(GLenum format);
+
+		// Encode/decode round trip of a source image's top level in every format
+		// (see BlockCompressor::CheckRoundTrip); empty if it can't be read
+		static std::vector<BlockCompressor::RoundTrip> CheckRoundTrip(const std::string& path);
+
+		static bool m_Enabled;
+
+		// BC1 (opaque) / BC3 (alpha) for colour maps instead of BC7: faster to
+		// encode, half the size without alpha, noticeably blockier
+		static bool m_FastColor;
+
+	private:
+		static bool Build(const std::string& path, aiTextureType type, uint64_t hash, ImageData& image);
+
+		static bool ReadCache(const std::string& path, aiTextureType type, uint64_t hash, ImageData& image);
+		static void WriteCache(const std::string& path, aiTextureType type, uint64_t hash, 
+			BlockCompressor::Format format, const ImageData& image);
+	};
+}
+
+#endif
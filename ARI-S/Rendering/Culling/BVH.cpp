@@ -0,0 +1,508 @@
+#include <arpch.h>
+#include "BVH.h"
+
+#include <algorithm>
+#include <cfloat>
+
+namespace ARIS
+{
+	// Number of centroid bins used by the SAH rebuild
+	static constexpr int s_SAHBins = 12;
+
+	int BVH::AllocateNode()
+	{
+		if (!m_FreeNodes.empty())
+		{
+			int node = m_FreeNodes.back();
+			m_FreeNodes.pop_back();
+			m_Nodes[node] = Node();
+			return node;
+		}
+
+		m_Nodes.push_back(Node());
+		return static_cast<int>(m_Nodes.size()) - 1;
+	}
+
+	void BVH::FreeNode(int node)
+	{
+		m_Nodes[node] = Node();
+		m_FreeNodes.push_back(node);
+	}
+
+	int BVH::Insert(const BoundingBox& box, uint32_t data)
+	{
+		int leaf = AllocateNode();
+		m_Nodes[leaf].s_Box = box;
+		m_Nodes[leaf].s_Data = data;
+
+		InsertLeaf(leaf);
+		++m_LeafCount;
+
+		return leaf;
+	}
+
+	void BVH::Remove(int proxy)
+	{
+		if (proxy == Null)
+			return;
+
+		RemoveLeaf(proxy);
+		FreeNode(proxy);
+		--m_LeafCount;
+	}
+
+	void BVH::Update(int proxy, const BoundingBox& box)
+	{
+		if (proxy == Null)
+			return;
+
+		m_Nodes[proxy].s_Box = box;
+		RefitAncestors(m_Nodes[proxy].s_Parent);
+
+		++m_RefitCount;
+	}
+
+	void BVH::Clear()
+	{
+		m_Nodes.clear();
+		m_FreeNodes.clear();
+		m_Root = Null;
+		m_LeafCount = 0;
+		m_RefitCount = 0;
+	}
+
+	void BVH::InsertLeaf(int leaf)
+	{
+		if (m_Root == Null)
+		{
+			m_Root = leaf;
+			m_Nodes[leaf].s_Parent = Null;
+			return;
+		}
+
+		// Walk down towards the sibling that grows the tree's surface area the least
+		const BoundingBox leafBox = m_Nodes[leaf].s_Box;
+		int index = m_Root;
+
+		while (!m_Nodes[index].IsLeaf())
+		{
+			const Node& n = m_Nodes[index];
+
+			float area = n.s_Box.SurfaceArea();
+			float combined = BoundingBox::Merge(n.s_Box, leafBox).SurfaceArea();
+
+			// cost of pairing the leaf with this node directly
+			float cost = 2.0f * combined;
+
+			// minimum cost pushed down to the children
+			float inherited = 2.0f * (combined - area);
+
+			auto childCost = [&](int child)
+			{
+				const Node& c = m_Nodes[child];
+				float merged = BoundingBox::Merge(c.s_Box, leafBox).SurfaceArea();
+				return c.IsLeaf() ? merged + inherited : (merged - c.s_Box.SurfaceArea()) + inherited;
+			};
+
+			float costLeft = childCost(n.s_Left);
+			float costRight = childCost(n.s_Right);
+
+			if (cost < costLeft && cost < costRight)
+				break;
+
+			index = costLeft < costRight ? n.s_Left : n.s_Right;
+		}
+
+		int sibling = index;
+		int oldParent = m_Nodes[sibling].s_Parent;
+
+		int newParent = AllocateNode();
+		m_Nodes[newParent].s_Parent = oldParent;
+		m_Nodes[newParent].s_Box = BoundingBox::Merge(leafBox, m_Nodes[sibling].s_Box);
+		m_Nodes[newParent].s_Left = sibling;
+		m_Nodes[newParent].s_Right = leaf;
+
+		if (oldParent != Null)
+		{
+			if (m_Nodes[oldParent].s_Left == sibling)
+				m_Nodes[oldParent].s_Left = newParent;
+			else
+				m_Nodes[oldParent].s_Right = newParent;
+		}
+		else
+		{
+			m_Root = newParent;
+		}
+
+		m_Nodes[sibling].s_Parent = newParent;
+		m_Nodes[leaf].s_Parent = newParent;
+
+		RefitAncestors(oldParent);
+	}
+
+	void BVH::RemoveLeaf(int leaf)
+	{
+		if (leaf == m_Root)
+		{
+			m_Root = Null;
+			return;
+		}
+
+		int parent = m_Nodes[leaf].s_Parent;
+		int grandParent = m_Nodes[parent].s_Parent;
+		int sibling = m_Nodes[parent].s_Left == leaf ? m_Nodes[parent].s_Right : m_Nodes[parent].s_Left;
+
+		// the sibling takes the parent's place
+		if (grandParent != Null)
+		{
+			if (m_Nodes[grandParent].s_Left == parent)
+				m_Nodes[grandParent].s_Left = sibling;
+			else
+				m_Nodes[grandParent].s_Right = sibling;
+
+			m_Nodes[sibling].s_Parent = grandParent;
+			FreeNode(parent);
+
+			RefitAncestors(grandParent);
+		}
+		else
+		{
+			m_Root = sibling;
+			m_Nodes[sibling].s_Parent = Null;
+			FreeNode(parent);
+		}
+
+		m_Nodes[leaf].s_Parent = Null;
+	}
+
+	void BVH::RefitAncestors(int node)
+	{
+		while (node != Null)
+		{
+			Node& n = m_Nodes[node];
+			n.s_Box = BoundingBox::Merge(m_Nodes[n.s_Left].s_Box, m_Nodes[n.s_Right].s_Box);
+			node = n.s_Parent;
+		}
+	}
+
+	void BVH::Rebuild()
+	{
+		if (m_Root == Null)
+			return;
+
+		// Gather the leaves and release every internal node
+		std::vector<int> leaves;
+		leaves.reserve(m_LeafCount);
+
+		std::vector<int> stack;
+		stack.push_back(m_Root);
+
+		while (!stack.empty())
+		{
+			int node = stack.back();
+			stack.pop_back();
+
+			if (m_Nodes[node].IsLeaf())
+			{
+				leaves.push_back(node);
+				continue;
+			}
+
+			stack.push_back(m_Nodes[node].s_Left);
+			stack.push_back(m_Nodes[node].s_Right);
+			FreeNode(node);
+		}
+
+		m_Root = BuildRange(leaves, 0, static_cast<int>(leaves.size()));
+		m_Nodes[m_Root].s_Parent = Null;
+
+		m_RefitCount = 0;
+	}
+
+	int BVH::BuildRange(std::vector<int>& leaves, int begin, int end)
+	{
+		int count = end - begin;
+		if (count == 1)
+			return leaves[begin];
+
+		BoundingBox centroids{ glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX) };
+		for (int i = begin; i < end; ++i)
+		{
+			glm::vec3 c = m_Nodes[leaves[i]].s_Box.Center();
+			centroids.s_Min = glm::min(centroids.s_Min, c);
+			centroids.s_Max = glm::max(centroids.s_Max, c);
+		}
+
+		glm::vec3 extent = centroids.s_Max - centroids.s_Min;
+		int axis = 0;
+		if (extent.y > extent[axis]) axis = 1;
+		if (extent.z > extent[axis]) axis = 2;
+
+		int mid = begin + count / 2;
+
+		if (extent[axis] > 1e-6f)
+		{
+			// Bin the centroids along the widest axis and pick the cheapest split
+			struct Bin
+			{
+				BoundingBox s_Box{ glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX) };
+				int s_Count = 0;
+			} bins[s_SAHBins];
+
+			float scale = s_SAHBins / extent[axis];
+			auto binIndex = [&](int leaf)
+			{
+				int b = static_cast<int>((m_Nodes[leaf].s_Box.Center()[axis] - centroids.s_Min[axis]) * scale);
+				return std::min(b, s_SAHBins - 1);
+			};
+
+			for (int i = begin; i < end; ++i)
+			{
+				Bin& b = bins[binIndex(leaves[i])];
+				b.s_Box = BoundingBox::Merge(b.s_Box, m_Nodes[leaves[i]].s_Box);
+				++b.s_Count;
+			}
+
+			// areas/counts of everything left of split i, swept from both ends
+			float leftArea[s_SAHBins - 1], rightArea[s_SAHBins - 1];
+			int leftCount[s_SAHBins - 1], rightCount[s_SAHBins - 1];
+
+			BoundingBox box{ glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX) };
+			int sum = 0;
+			for (int i = 0; i < s_SAHBins - 1; ++i)
+			{
+				box = BoundingBox::Merge(box, bins[i].s_Box);
+				sum += bins[i].s_Count;
+				leftArea[i] = sum ? box.SurfaceArea() : 0.0f;
+				leftCount[i] = sum;
+			}
+
+			box = BoundingBox{ glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX) };
+			sum = 0;
+			for (int i = s_SAHBins - 1; i > 0; --i)
+			{
+				box = BoundingBox::Merge(box, bins[i].s_Box);
+				sum += bins[i].s_Count;
+				rightArea[i - 1] = sum ? box.SurfaceArea() : 0.0f;
+				rightCount[i - 1] = sum;
+			}
+
+			int bestSplit = -1;
+			float bestCost = FLT_MAX;
+			for (int i = 0; i < s_SAHBins - 1; ++i)
+			{
+				if (leftCount[i] == 0 || rightCount[i] == 0)
+					continue;
+
+				float cost = leftArea[i] * leftCount[i] + rightArea[i] * rightCount[i];
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestSplit = i;
+				}
+			}
+
+			if (bestSplit >= 0)
+			{
+				auto it = std::partition(leaves.begin() + begin, leaves.begin() + end,
+					[&](int leaf) { return binIndex(leaf) <= bestSplit; });
+				mid = static_cast<int>(it - leaves.begin());
+			}
+		}
+
+		// degenerate split (coincident centroids): fall back to the median
+		if (mid == begin || mid == end)
+		{
+			mid = begin + count / 2;
+			std::nth_element(leaves.begin() + begin, leaves.begin() + mid, leaves.begin() + end,
+				[&](int a, int b) { return m_Nodes[a].s_Box.Center()[axis] < m_Nodes[b].s_Box.Center()[axis]; });
+		}
+
+		int left = BuildRange(leaves, begin, mid);
+		int right = BuildRange(leaves, mid, end);
+
+		int node = AllocateNode();
+		m_Nodes[node].s_Left = left;
+		m_Nodes[node].s_Right = right;
+		m_Nodes[node].s_Box = BoundingBox::Merge(m_Nodes[left].s_Box, m_Nodes[right].s_Box);
+		m_Nodes[left].s_Parent = node;
+		m_Nodes[right].s_Parent = node;
+
+		return node;
+	}
+
+	void BVH::QueryFrustum(const Frustum& f, std::vector<uint32_t>& out) const
+	{
+		if (m_Root == Null)
+			return;
+
+		// (node, already known to be fully inside)
+		std::vector<std::pair<int, bool>> stack;
+		stack.reserve(64);
+		stack.push_back({ m_Root, false });
+
+		while (!stack.empty())
+		{
+			auto [node, inside] = stack.back();
+			stack.pop_back();
+
+			const Node& n = m_Nodes[node];
+
+			if (!inside)
+			{
+				Frustum::Result r = f.Classify(n.s_Box);
+				if (r == Frustum::Result::Outside)
+					continue;
+
+				inside = (r == Frustum::Result::Inside);
+			}
+
+			if (n.IsLeaf())
+			{
+				out.push_back(n.s_Data);
+				continue;
+			}
+
+			stack.push_back({ n.s_Left, inside });
+			stack.push_back({ n.s_Right, inside });
+		}
+	}
+
+	void BVH::QuerySphere(const glm::vec3& center, float radius, std::vector<uint32_t>& out) const
+	{
+		if (m_Root == Null)
+			return;
+
+		std::vector<int> stack;
+		stack.reserve(64);
+		stack.push_back(m_Root);
+
+		float radiusSq = radius * radius;
+
+		while (!stack.empty())
+		{
+			const Node& n = m_Nodes[stack.back()];
+			stack.pop_back();
+
+			glm::vec3 closest = glm::clamp(center, n.s_Box.s_Min, n.s_Box.s_Max);
+			glm::vec3 d = closest - center;
+			if (glm::dot(d, d) > radiusSq)
+				continue;
+
+			if (n.IsLeaf())
+			{
+				out.push_back(n.s_Data);
+				continue;
+			}
+
+			stack.push_back(n.s_Left);
+			stack.push_back(n.s_Right);
+		}
+	}
+
+	void BVH::QueryRay(const glm::vec3& origin, const glm::vec3& dir, float maxDist,
+		std::vector<std::pair<float, uint32_t>>& out) const
+	{
+		if (m_Root == Null)
+			return;
+
+		glm::vec3 invDir = 1.0f / dir;
+
+		// slab test; returns the entry distance or -1 on a miss
+		auto entry = [&](const BoundingBox& b)
+		{
+			glm::vec3 t0 = (b.s_Min - origin) * invDir;
+			glm::vec3 t1 = (b.s_Max - origin) * invDir;
+			glm::vec3 tMin = glm::min(t0, t1);
+			glm::vec3 tMax = glm::max(t0, t1);
+
+			float tNear = glm::max(glm::max(tMin.x, tMin.y), glm::max(tMin.z, 0.0f));
+			float tFar = glm::min(glm::min(tMax.x, tMax.y), glm::min(tMax.z, maxDist));
+
+			return tNear <= tFar ? tNear : -1.0f;
+		};
+
+		std::vector<int> stack;
+		stack.reserve(64);
+		stack.push_back(m_Root);
+
+		while (!stack.empty())
+		{
+			const Node& n = m_Nodes[stack.back()];
+			stack.pop_back();
+
+			float t = entry(n.s_Box);
+			if (t < 0.0f)
+				continue;
+
+			if (n.IsLeaf())
+			{
+				out.push_back({ t, n.s_Data });
+				continue;
+			}
+
+			stack.push_back(n.s_Left);
+			stack.push_back(n.s_Right);
+		}
+
+		std::sort(out.begin(), out.end(),
+			[](const std::pair<float, uint32_t>& a, const std::pair<float, uint32_t>& b) { return a.first < b.first; });
+	}
+
+	int BVH::GetHeight() const
+	{
+		if (m_Root == Null)
+			return 0;
+
+		int height = 0;
+
+		std::vector<std::pair<int, int>> stack;
+		stack.push_back({ m_Root, 1 });
+
+		while (!stack.empty())
+		{
+			auto [node, depth] = stack.back();
+			stack.pop_back();
+
+			height = std::max(height, depth);
+
+			if (!m_Nodes[node].IsLeaf())
+			{
+				stack.push_back({ m_Nodes[node].s_Left, depth + 1 });
+				stack.push_back({ m_Nodes[node].s_Right, depth + 1 });
+			}
+		}
+
+		return height;
+	}
+
+	float BVH::GetCost() const
+	{
+		if (m_Root == Null || m_Nodes[m_Root].IsLeaf())
+			return 0.0f;
+
+		float rootArea = m_Nodes[m_Root].s_Box.SurfaceArea();
+		if (rootArea <= 0.0f)
+			return 0.0f;
+
+		float total = 0.0f;
+
+		std::vector<int> stack;
+		stack.push_back(m_Root);
+
+		while (!stack.empty())
+		{
+			const Node& n = m_Nodes[stack.back()];
+			stack.pop_back();
+
+			if (n.IsLeaf())
+				continue;
+
+			total += n.s_Box.SurfaceArea();
+			stack.push_back(n.s_Left);
+			stack.push_back(n.s_Right);
+		}
+
+		return total / rootArea;
+	}
+}
@@ -0,0 +1,82 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include "MeshResource.h"
+#include "Frustum.hpp"
+
+#include <glm.hpp>
+#include <vector>
+#include <cstdint>
+
+namespace ARIS
+{
+	// Dynamic bounding volume hierarchy over world-space AABBs.
+	// Leaves are inserted incrementally (surface area heuristic), moved leaves
+	// only refit their ancestors, and Rebuild() restructures the whole tree with
+	// a binned SAH build once refits have degraded it. Leaf IDs (proxies) stay
+	// valid across rebuilds.
+	class BVH
+	{
+	public:
+		static constexpr int Null = -1;
+
+		int Insert(const BoundingBox& box, uint32_t data);
+		void Remove(int proxy);
+
+		// Refit a moved leaf and its ancestors (no restructuring)
+		void Update(int proxy, const BoundingBox& box);
+
+		void Rebuild();
+		void Clear();
+
+		void QueryFrustum(const Frustum& f, std::vector<uint32_t>& out) const;
+		void QuerySphere(const glm::vec3& center, float radius, std::vector<uint32_t>& out) const;
+
+		// Every leaf the ray enters within maxDist as (entry distance, data), nearest first
+		void QueryRay(const glm::vec3& origin, const glm::vec3& dir, float maxDist,
+			std::vector<std::pair<float, uint32_t>>& out) const;
+
+		uint32_t GetData(int proxy) const { return m_Nodes[proxy].s_Data; }
+		const BoundingBox& GetBounds(int proxy) const { return m_Nodes[proxy].s_Box; }
+
+		unsigned GetLeafCount() const { return m_LeafCount; }
+
+		// Bounds of everything in the tree (an empty box if there are no leaves)
+		BoundingBox GetRootBounds() const { return m_Root == Null ? BoundingBox() : m_Nodes[m_Root].s_Box; }
+		unsigned GetRefitCount() const { return m_RefitCount; }
+		int GetHeight() const;
+
+		// Sum of internal node areas relative to the root (lower is better)
+		float GetCost() const;
+
+	private:
+		struct Node
+		{
+			BoundingBox s_Box;
+			int s_Parent = Null;
+			int s_Left = Null;
+			int s_Right = Null;
+			uint32_t s_Data = 0;
+
+			bool IsLeaf() const { return s_Left == Null; }
+		};
+
+		int AllocateNode();
+		void FreeNode(int node);
+
+		void InsertLeaf(int leaf);
+		void RemoveLeaf(int leaf);
+		void RefitAncestors(int node);
+
+		int BuildRange(std::vector<int>& leaves, int begin, int end);
+
+		std::vector<Node> m_Nodes;
+		std::vector<int> m_FreeNodes;
+
+		int m_Root = Null;
+		unsigned m_LeafCount = 0;
+		unsigned m_RefitCount = 0;
+	};
+}
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef FRUSTUM_HPP
+#define FRUSTUM_HPP
+
+#include "MeshResource.h"
+
+#include <glm.hpp>
+
+namespace ARIS
+{
+	// Six world-space planes (ax + by + cz + d >= 0 is inside)
+	class Frustum
+	{
+	public:
+		enum Plane { Left = 0, Right, Bottom, Top, Near, Far, Count };
+
+		Frustum() = default;
+
+		// Extract the planes from a view-projection matrix (Gribb/Hartmann)
+		explicit Frustum(const glm::mat4& viewProj)
+		{
+			glm::vec4 row0 = glm::vec4(viewProj[0][0], viewProj[1][0], viewProj[2][0], viewProj[3][0]);
+			glm::vec4 row1 = glm::vec4(viewProj[0][1], viewProj[1][1], viewProj[2][1], viewProj[3][1]);
+			glm::vec4 row2 = glm::vec4(viewProj[0][2], viewProj[1][2], viewProj[2][2], viewProj[3][2]);
+			glm::vec4 row3 = glm::vec4(viewProj[0][3], viewProj[1][3], viewProj[2][3], viewProj[3][3]);
+
+			m_Planes[Left] = row3 + row0;
+			m_Planes[Right] = row3 - row0;
+			m_Planes[Bottom] = row3 + row1;
+			m_Planes[Top] = row3 - row1;
+			m_Planes[Near] = row3 + row2;
+			m_Planes[Far] = row3 - row2;
+
+			for (glm::vec4& p : m_Planes)
+			{
+				p /= glm::length(glm::vec3(p));
+			}
+		}
+
+		enum class Result { Outside, Intersecting, Inside };
+
+		// Like Intersects, but also reports boxes fully inside every plane
+		// (lets hierarchy queries accept whole subtrees without testing them)
+		Result Classify(const BoundingBox& b) const
+		{
+			Result res = Result::Inside;
+
+			for (const glm::vec4& p : m_Planes)
+			{
+				glm::vec3 n = glm::vec3(p);
+
+				glm::vec3 positive = glm::vec3(
+					p.x >= 0.0f ? b.s_Max.x : b.s_Min.x,
+					p.y >= 0.0f ? b.s_Max.y : b.s_Min.y,
+					p.z >= 0.0f ? b.s_Max.z : b.s_Min.z);
+
+				if (glm::dot(n, positive) + p.w < 0.0f)
+					return Result::Outside;
+
+				glm::vec3 negative = glm::vec3(
+					p.x >= 0.0f ? b.s_Min.x : b.s_Max.x,
+					p.y >= 0.0f ? b.s_Min.y : b.s_Max.y,
+					p.z >= 0.0f ? b.s_Min.z : b.s_Max.z);
+
+				if (glm::dot(n, negative) + p.w < 0.0f)
+					res = Result::Intersecting;
+			}
+
+			return res;
+		}
+
+		// Conservative test: only rejects boxes fully outside one plane
+		bool Intersects(const BoundingBox& b) const
+		{
+			for (const glm::vec4& p : m_Planes)
+			{
+				// corner furthest along the plane normal
+				glm::vec3 positive = glm::vec3(
+					p.x >= 0.0f ? b.s_Max.x : b.s_Min.x,
+					p.y >= 0.0f ? b.s_Max.y : b.s_Min.y,
+					p.z >= 0.0f ? b.s_Max.z : b.s_Min.z);
+
+				if (glm::dot(glm::vec3(p), positive) + p.w < 0.0f)
+					return false;
+			}
+
+			return true;
+		}
+
+		bool Intersects(const glm::vec3& center, float radius) const
+		{
+			for (const glm::vec4& p : m_Planes)
+			{
+				if (glm::dot(glm::vec3(p), center) + p.w < -radius)
+					return false;
+			}
+
+			return true;
+		}
+
+		const glm::vec4& GetPlane(Plane p) const { return m_Planes[p]; }
+
+	private:
+		glm::vec4 m_Planes[Count];
+	};
+}
+
+#endif
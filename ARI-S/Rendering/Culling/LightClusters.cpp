@@ -0,0 +1,74 @@
+#include <arpch.h>
+#include "LightClusters.h"
+
+#include <cmath>
+
+namespace ARIS
+{
+	// Lights per culling work group (matches local_size_x in LightCulling.cmpt)
+	static constexpr uint32_t s_CullGroupSize = 128;
+
+	static_assert(LightClusters::ClusterCount % s_CullGroupSize == 0,
+		"LightCulling.cmpt assumes whole work groups of clusters");
+
+	void LightClusters::Init()
+	{
+		ReloadShaders();
+
+		m_Lights = new StorageBuffer(LightsBinding, 64 * sizeof(ClusterLight));
+		m_Bounds = new StorageBuffer(BoundsBinding, ClusterCount * 2 * sizeof(glm::vec4));
+		m_Counts = new StorageBuffer(CountsBinding, ClusterCount * sizeof(uint32_t));
+		m_Indices = new StorageBuffer(IndicesBinding, ClusterCount * MaxLightsPerCluster * sizeof(uint32_t));
+	}
+
+	void LightClusters::ReloadShaders()
+	{
+		delete m_BoundsPass;
+		delete m_CullPass;
+
+		m_BoundsPass = new Shader(false, "Clustered/ClusterBounds.cmpt");
+		m_CullPass = new Shader(false, "Clustered/LightCulling.cmpt");
+
+		// force the bounds to be rebuilt with the new program
+		m_BoundsProjection = glm::mat4(0.0f);
+	}
+
+	void LightClusters::SetLights(const std::vector<ClusterLight>& lights)
+	{
+		m_LightCount = static_cast<uint32_t>(lights.size());
+
+		if (!lights.empty())
+		{
+			m_Lights->SetData(lights.data(), lights.size() * sizeof(ClusterLight));
+		}
+	}
+
+	void LightClusters::Cull(const glm::mat4& view, const glm::mat4& projection, float zNear, float zFar)
+	{
+		// The bounds are in view space, so they only depend on the projection
+		if (projection != m_BoundsProjection)
+		{
+			m_BoundsProjection = projection;
+
+			float logRatio = std::log(zFar / zNear);
+			m_SliceParams = glm::vec4(Slices / logRatio, -(Slices * std::log(zNear)) / logRatio, zNear, zFar);
+
+			m_BoundsPass->Activate();
+			m_BoundsPass->SetMat4("invProjection", glm::inverse(projection));
+			m_BoundsPass->SetFloat("zNear", zNear);
+			m_BoundsPass->SetFloat("zFar", zFar);
+
+			glDispatchCompute(1, 1, Slices);
+			glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+		}
+
+		m_CullPass->Activate();
+		m_CullPass->SetMat4("view", view);
+		m_CullPass->SetInt("lightCount", static_cast<int>(m_LightCount));
+
+		glDispatchCompute(ClusterCount / s_CullGroupSize, 1, 1);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+		RenderState::UseProgram(0);
+	}
+}
@@ -0,0 +1,65 @@
+#ifndef LIGHTCLUSTERS_H
+#define LIGHTCLUSTERS_H
+
+#include "StorageMemory.hpp"
+#include "Shader.h"
+
+#include <glm.hpp>
+#include <vector>
+#include <cstdint>
+
+namespace ARIS
+{
+	// A point light as the culling and lighting shaders read it (std430)
+	struct ClusterLight
+	{
+		glm::vec4 s_PosRange;       // xyz = world position, w = range
+		glm::vec4 s_ColorIntensity; // rgb = color, a = intensity
+	};
+
+	// Clustered light culling. The view frustum is split into a froxel grid
+	// (screen tiles x exponentially spaced depth slices); a compute pass writes
+	// the lights overlapping each cluster into that cluster's slot list, and the
+	// lighting pass only loops over the list of the cluster a pixel falls in.
+	// The grid constants are mirrored in Clustered/*.cmpt and the lighting pass.
+	class LightClusters
+	{
+	public:
+		static constexpr uint32_t TilesX = 16, TilesY = 9, Slices = 24;
+		static constexpr uint32_t ClusterCount = TilesX * TilesY * Slices;
+		static constexpr uint32_t MaxLightsPerCluster = 128;
+
+		// Shader storage binding points
+		enum Binding { LightsBinding = 0, BoundsBinding, CountsBinding, IndicesBinding };
+
+		void Init();
+		void ReloadShaders();
+
+		// Upload this frame's lights
+		void SetLights(const std::vector<ClusterLight>& lights);
+
+		// Rebuild the cluster bounds if the projection changed, then bin the lights
+		void Cull(const glm::mat4& view, const glm::mat4& projection, float zNear, float zFar);
+
+		// slice = log(viewDepth) * x + y; z/w = near/far for linearizing depth
+		glm::vec4 GetSliceParams() const { return m_SliceParams; }
+
+		uint32_t GetLightCount() const { return m_LightCount; }
+
+	private:
+		Shader* m_BoundsPass = nullptr, * m_CullPass = nullptr;
+
+		StorageBuffer* m_Lights = nullptr;
+		StorageBuffer* m_Bounds = nullptr;
+		StorageBuffer* m_Counts = nullptr;
+		StorageBuffer* m_Indices = nullptr;
+
+		uint32_t m_LightCount = 0;
+
+		// Projection the current bounds were built for
+		glm::mat4 m_BoundsProjection = glm::mat4(0.0f);
+		glm::vec4 m_SliceParams = glm::vec4(0.0f);
+	};
+}
+
+#endif
@@ -2,6 +2,7 @@
 
 #define DEBUG_DRAW_IMPLEMENTATION
 #include "DebugDraw.h"
+#include "RenderState.h"
 
 namespace ARIS
 {
@@ -56,54 +57,54 @@ namespace ARIS
 
 	void DebugInterface::drawPointList(const dd::DrawVertex* points, int count, bool depthEnabled)
 	{
-		glBindVertexArray(m_LineVAO);
-		glUseProgram(m_LineProgram);
+		RenderState::BindVertexArray(m_LineVAO);
+		RenderState::UseProgram(m_LineProgram);
 
 		glUniformMatrix4fv(m_LineProgramMatrixLoc, 1, GL_FALSE, glm::value_ptr(m_MatrixMVP));
 
 		if (depthEnabled)
 		{
-			glEnable(GL_DEPTH_TEST);
+			RenderState::Enable(GL_DEPTH_TEST);
 		}
 		else
 		{
-			glDisable(GL_DEPTH_TEST);
+			RenderState::Disable(GL_DEPTH_TEST);
 		}
 
-		glBindBuffer(GL_ARRAY_BUFFER, m_LineVBO);
+		RenderState::BindBuffer(GL_ARRAY_BUFFER, m_LineVBO);
 		glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(dd::DrawVertex), points);
 
 		glDrawArrays(GL_POINTS, 0, count);
 
-		glUseProgram(0);
-		glBindVertexArray(0);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		RenderState::UseProgram(0);
+		RenderState::BindVertexArray(0);
+		RenderState::BindBuffer(GL_ARRAY_BUFFER, 0);
 	}
 
 	void DebugInterface::drawLineList(const dd::DrawVertex* lines, int count, bool depthEnabled)
 	{
-		glBindVertexArray(m_LineVAO);
-		glUseProgram(m_LineProgram);
+		RenderState::BindVertexArray(m_LineVAO);
+		RenderState::UseProgram(m_LineProgram);
 
 		glUniformMatrix4fv(m_LineProgramMatrixLoc, 1, GL_FALSE, glm::value_ptr(m_MatrixMVP));
 
 		if (depthEnabled)
 		{
-			glEnable(GL_DEPTH_TEST);
+			RenderState::Enable(GL_DEPTH_TEST);
 		}
 		else
 		{
-			glDisable(GL_DEPTH_TEST);
+			RenderState::Disable(GL_DEPTH_TEST);
 		}
 
-		glBindBuffer(GL_ARRAY_BUFFER, m_LineVBO);
+		RenderState::BindBuffer(GL_ARRAY_BUFFER, m_LineVBO);
 		glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(dd::DrawVertex), lines);
 
 		glDrawArrays(GL_LINES, 0, count);
 
-		glUseProgram(0);
-		glBindVertexArray(0);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		RenderState::UseProgram(0);
+		RenderState::BindVertexArray(0);
+		RenderState::BindBuffer(GL_ARRAY_BUFFER, 0);
 	}
 
 	DebugInterface::DebugInterface()
@@ -115,10 +116,10 @@ namespace ARIS
 	{
 		std::printf("Debug initializing ...\n");
 
-		glEnable(GL_CULL_FACE);
-		glEnable(GL_DEPTH_TEST);
-		glDisable(GL_BLEND);
-		glEnable(GL_PROGRAM_POINT_SIZE);
+		RenderState::Enable(GL_CULL_FACE);
+		RenderState::Enable(GL_DEPTH_TEST);
+		RenderState::Disable(GL_BLEND);
+		RenderState::Enable(GL_PROGRAM_POINT_SIZE);
 
 		SetupShaders();
 		SetupVertexBuffers();
@@ -131,7 +132,9 @@ namespace ARIS
 		glDeleteProgram(m_LineProgram);
 
 		glDeleteVertexArrays(1, &m_LineVAO);
+		RenderState::OnVertexArrayDeleted(m_LineVAO);
 		glDeleteBuffers(1, &m_LineVBO);
+		RenderState::OnBufferDeleted(m_LineVBO);
 
 	}
 
@@ -165,8 +168,8 @@ namespace ARIS
 		glGenVertexArrays(1, &m_LineVAO);
 		glGenBuffers(1, &m_LineVBO);
 
-		glBindVertexArray(m_LineVAO);
-		glBindBuffer(GL_ARRAY_BUFFER, m_LineVBO);
+		RenderState::BindVertexArray(m_LineVAO);
+		RenderState::BindBuffer(GL_ARRAY_BUFFER, m_LineVBO);
 
 		// RenderInterface will never be called with a batch larger than
 		// DEBUG_DRAW_VERTEX_BUFFER_SIZE vertexes, so we can allocate the same amount here.
@@ -194,8 +197,8 @@ namespace ARIS
 			/* stride    = */ sizeof(dd::DrawVertex),
 			/* offset    = */ reinterpret_cast<void*>(offset));
 
-		glBindVertexArray(0);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		RenderState::BindVertexArray(0);
+		RenderState::BindBuffer(GL_ARRAY_BUFFER, 0);
 	}
 
 	void DebugInterface::CompileShader(const GLuint s)
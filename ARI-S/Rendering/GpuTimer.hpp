@@ -0,0 +1,58 @@
+#ifndef GPUTIMER_HPP
+#define GPUTIMER_HPP
+
+#include <glad/glad.h>
+
+namespace ARIS
+{
+	// GL_TIME_ELAPSED query around a block of GPU work. Two queries alternate
+	// so a frame only reads back the previous frame's result once it's ready,
+	// never stalling on the one just issued.
+	class GpuTimer
+	{
+	public:
+		void Begin()
+		{
+			if (!m_Queries[0])
+			{
+				glGenQueries(2, m_Queries);
+			}
+
+			glBeginQuery(GL_TIME_ELAPSED, m_Queries[m_Current]);
+		}
+
+		void End()
+		{
+			glEndQuery(GL_TIME_ELAPSED);
+			m_Issued[m_Current] = true;
+
+			m_Current ^= 1;
+
+			// the other query is the previous frame's
+			if (m_Issued[m_Current])
+			{
+				GLint available = 0;
+				glGetQueryObjectiv(m_Queries[m_Current], GL_QUERY_RESULT_AVAILABLE, &available);
+
+				if (available)
+				{
+					GLuint64 ns = 0;
+					glGetQueryObjectui64v(m_Queries[m_Current], GL_QUERY_RESULT, &ns);
+					m_Milliseconds = static_cast<float>(ns) * 1e-6f;
+				}
+			}
+		}
+
+		// Latest finished measurement (one or two frames old)
+		float GetMilliseconds() const { return m_Milliseconds; }
+
+	private:
+		GLuint m_Queries[2] = { 0, 0 };
+		bool m_Issued[2] = { false, false };
+		unsigned m_Current = 0;
+
+		float m_Milliseconds = 0.0f;
+	};
+}
+
+#endif
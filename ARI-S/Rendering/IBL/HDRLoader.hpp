@@ -9,6 +9,11 @@
 using namespace std;
 
 #include "rgbe.h"
+#include "MappedFile.h"
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 namespace ARIS
 {
@@ -19,33 +24,132 @@ namespace ARIS
         static void ReadHDR(const string inName, std::vector<float>& image,
             int& width, int& height)
         {
-            rgbe_header_info info;
-            char errbuf[100] = { 0 };
-
-            // Open file and read width and height from the header
-            FILE* fp = fopen(inName.c_str(), "rb");
-            if (!fp) {
-                printf("Can't open file: %s\n", inName.c_str());
+            if (!Decode(inName, image, width, height))
+            {
                 exit(-1);
             }
-            int rc = RGBE_ReadHeader(fp, &width, &height, &info, errbuf);
-            if (rc != RGBE_RETURN_SUCCESS) {
-                printf("RGBE read error: %s\n", errbuf);
-                exit(-1);
+
+            printf("Read %s (%dX%d)\n", inName.c_str(), width, height);
+        }
+
+        // Decode a whole .hdr file to RGB floats. The file is mapped, scanline
+        // offsets are located in one cheap pass, then the scanlines are
+        // un-RLE'd and converted in parallel. flip stores rows bottom-up (GL order).
+        static bool Decode(const std::string& path, std::vector<float>& image,
+            int& width, int& height, bool flip = false)
+        {
+            MappedFile file(path);
+            if (!file.IsOpen())
+            {
+                std::cout << "HDR ERROR: Can't open file: " << path << std::endl;
+                return false;
             }
 
-            // Allocate enough memory
-            image.resize(3 * width * height);
+            if (!Decode(file.GetData(), file.GetSize(), image, width, height, flip))
+            {
+                std::cout << "HDR ERROR: Unsupported or corrupt file: " << path << std::endl;
+                return false;
+            }
 
-            // Read the pixel data and close the file
-            rc = RGBE_ReadPixels_RLE(fp, &image[0], width, height, errbuf);
-            if (rc != RGBE_RETURN_SUCCESS) {
-                printf("RGBE read error: %s\n", errbuf);
-                exit(-1);
+            return true;
+        }
+
+        static bool Decode(const uint8_t* data, size_t size, std::vector<float>& image,
+            int& width, int& height, bool flip = false)
+        {
+            size_t pos = 0;
+            if (!ReadHeader(data, size, pos, width, height))
+                return false;
+
+            // where each scanline starts, and whether it's new-style RLE
+            std::vector<size_t> offsets(height);
+            std::vector<uint8_t> encoded(height);
+
+            bool flat = width < 8 || width > 0x7fff;
+            for (int y = 0; y < height; ++y)
+            {
+                offsets[y] = pos;
+
+                // once a scanline isn't RLE, the rest of the file is flat RGBE
+                if (!flat && (size - pos < 4 || data[pos] != 2 || data[pos + 1] != 2 || (data[pos + 2] & 0x80) ||
+                    ((data[pos + 2] << 8) | data[pos + 3]) != width))
+                {
+                    flat = true;
+                }
+
+                encoded[y] = !flat;
+                if (flat)
+                {
+                    pos += static_cast<size_t>(width) * 4;
+                    if (pos > size)
+                        return false;
+
+                    continue;
+                }
+
+                // skip the 4 channel planes without decoding them
+                pos += 4;
+                for (int c = 0; c < 4; ++c)
+                {
+                    for (int x = 0; x < width;)
+                    {
+                        if (pos >= size)
+                            return false;
+
+                        int count = data[pos];
+                        if (count > 128)
+                        {
+                            x += count - 128;
+                            pos += 2;
+                        }
+                        else
+                        {
+                            x += count;
+                            pos += 1 + count;
+                        }
+
+                        if (count == 0 || x > width)
+                            return false;
+                    }
+                }
+
+                if (pos > size)
+                    return false;
             }
-            fclose(fp);
 
-            printf("Read %s (%dX%d)\n", inName.c_str(), width, height);
+            image.resize(static_cast<size_t>(width) * height * 3);
+
+        #pragma omp parallel
+            {
+                // R, G, B and E planes of one scanline
+                std::vector<uint8_t> planes(static_cast<size_t>(width) * 4);
+
+        #pragma omp for schedule(static)
+                for (int y = 0; y < height; ++y)
+                {
+                    const uint8_t* src = data + offsets[y];
+                    float* dst = &image[static_cast<size_t>(flip ? height - 1 - y : y) * width * 3];
+
+                    if (encoded[y])
+                    {
+                        DecodePlanes(src + 4, width, planes.data());
+                    }
+                    else
+                    {
+                        for (int x = 0; x < width; ++x)
+                        {
+                            for (int c = 0; c < 4; ++c)
+                            {
+                                planes[c * width + x] = src[x * 4 + c];
+                            }
+                        }
+                    }
+
+                    ConvertScanline(planes.data(), width, dst);
+                }
+            }
+
+            return true;
         }
 
         // Write an HDR image in .hdr (RGBE) format.
@@ -73,6 +177,115 @@ namespace ARIS
 
             printf("Wrote %s (%dX%d)\n", outName.c_str(), width, height);
         }
+
+    private:
+        static bool ReadHeader(const uint8_t* data, size_t size, size_t& pos, int& width, int& height)
+        {
+            auto readLine = [&](std::string& line)
+            {
+                line.clear();
+                while (pos < size && data[pos] != '\n')
+                {
+                    line += static_cast<char>(data[pos++]);
+                }
+
+                return pos++ < size;
+            };
+
+            std::string line;
+            if (!readLine(line) || line.compare(0, 2, "#?") != 0)
+                return false;
+
+            // attributes up to the blank line; only RGBE pixels are supported
+            while (readLine(line) && !line.empty())
+            {
+                if (line.compare(0, 7, "FORMAT=") == 0 && line != "FORMAT=32-bit_rle_rgbe")
+                    return false;
+            }
+
+            // standard orientation only (top-down rows, left to right)
+            return readLine(line) && sscanf(line.c_str(), "-Y %d +X %d", &height, &width) == 2 &&
+                width > 0 && height > 0;
+        }
+
+        // Undo the per-channel run-length encoding of one scanline into planes
+        static void DecodePlanes(const uint8_t* src, int width, uint8_t* planes)
+        {
+            for (int c = 0; c < 4; ++c)
+            {
+                uint8_t* plane = planes + c * width;
+                for (int x = 0; x < width;)
+                {
+                    int count = *src++;
+                    if (count > 128)
+                    {
+                        count -= 128;
+                        memset(plane + x, *src++, count);
+                    }
+                    else
+                    {
+                        memcpy(plane + x, src, count);
+                        src += count;
+                    }
+                    x += count;
+                }
+            }
+        }
+
+        // RGBE -> float is mantissa * 2^(E - 136). 2^(E - 136) is built straight
+        // from its exponent bits (E - 9) instead of calling ldexp; E < 10 would be
+        // a denormal (or zero for E == 0) and is flushed to zero.
+        static void ConvertScanline(const uint8_t* planes, int width, float* dst)
+        {
+            const uint8_t* r = planes;
+            const uint8_t* g = planes + width;
+            const uint8_t* b = planes + width * 2;
+            const uint8_t* e = planes + width * 3;
+
+            int x = 0;
+        #if defined(_M_X64) || defined(__SSE2__)
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i bias = _mm_set1_epi32(9);
+
+            auto widen = [&zero](const uint8_t* p)
+            {
+                int bytes;
+                memcpy(&bytes, p, 4);
+                return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero), zero);
+            };
+
+            // 4 pixels at a time; each pixel's 4-wide store spills one float into the next
+            // pixel, so stop while a whole pixel still follows
+            for (; x + 5 <= width; x += 4)
+            {
+                __m128i exponent = _mm_max_epi16(_mm_sub_epi32(widen(e + x), bias), zero);
+                __m128 scale = _mm_castsi128_ps(_mm_slli_epi32(exponent, 23));
+
+                __m128 vr = _mm_mul_ps(_mm_cvtepi32_ps(widen(r + x)), scale);
+                __m128 vg = _mm_mul_ps(_mm_cvtepi32_ps(widen(g + x)), scale);
+                __m128 vb = _mm_mul_ps(_mm_cvtepi32_ps(widen(b + x)), scale);
+                __m128 va = _mm_setzero_ps();
+
+                _MM_TRANSPOSE4_PS(vr, vg, vb, va);
+
+                _mm_storeu_ps(dst + x * 3 + 0, vr);
+                _mm_storeu_ps(dst + x * 3 + 3, vg);
+                _mm_storeu_ps(dst + x * 3 + 6, vb);
+                _mm_storeu_ps(dst + x * 3 + 9, va);
+            }
+        #endif
+
+            for (; x < width; ++x)
+            {
+                uint32_t bits = e[x] > 9 ? static_cast<uint32_t>(e[x] - 9) << 23 : 0;
+                float scale;
+                memcpy(&scale, &bits, sizeof(scale));
+
+                dst[x * 3 + 0] = r[x] * scale;
+                dst[x * 3 + 1] = g[x] * scale;
+                dst[x * 3 + 2] = b[x] * scale;
+            }
+        }
     };
 }
 #endif
\ No newline at end of file
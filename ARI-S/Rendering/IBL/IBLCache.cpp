@@ -0,0 +1,128 @@
+#include <arpch.h>
+#include "IBLCache.h"
+#include "MappedFile.h"
+#include "RenderState.h"
+
+#include <cstring>
+
+namespace ARIS
+{
+	namespace
+	{
+		constexpr uint32_t CacheMagic = 0x42495241; // "ARIB" in file byte order
+
+		struct CacheHeader
+		{
+			uint32_t s_Magic;
+			uint32_t s_Version;
+			uint64_t s_SourceHash;
+			IBLSettings s_Settings;
+		};
+
+		// RGBA16F cubemap faces, RG16F lookup table
+		constexpr size_t CubeTexelBytes = 4 * sizeof(uint16_t);
+		constexpr size_t LUTTexelBytes = 2 * sizeof(uint16_t);
+
+		size_t FaceBytes(uint32_t size)
+		{
+			return static_cast<size_t>(size) * size * CubeTexelBytes;
+		}
+
+		size_t GetDataSize(const IBLSettings& settings)
+		{
+			size_t bytes = 0;
+			for (uint32_t level = 0; level < settings.s_PrefilterLevels; ++level)
+			{
+				bytes += 6 * FaceBytes(settings.s_PrefilterSize >> level);
+			}
+
+			return bytes + static_cast<size_t>(settings.s_BRDFSize) * settings.s_BRDFSize * LUTTexelBytes;
+		}
+	}
+
+	std::string IBLCache::GetCachePath(const std::string& hdrPath)
+	{
+		return hdrPath + ".arisibl";
+	}
+
+	bool IBLCache::Load(const std::string& hdrPath, const IBLSettings& settings,
+		Texture& prefiltered, Texture& brdf)
+	{
+		MappedFile file(GetCachePath(hdrPath));
+		if (!file.IsOpen() || file.GetSize() < sizeof(CacheHeader))
+		{
+			return false;
+		}
+
+		// the settings are all 4-byte fields, so a byte compare is exact
+		const CacheHeader* header = reinterpret_cast<const CacheHeader*>(file.GetData());
+		if (header->s_Magic != CacheMagic || header->s_Version != Version ||
+			std::memcmp(&header->s_Settings, &settings, sizeof(IBLSettings)) != 0 ||
+			file.GetSize() != sizeof(CacheHeader) + GetDataSize(settings) ||
+			header->s_SourceHash != MappedFile::HashContents(hdrPath))
+		{
+			return false;
+		}
+
+		const uint8_t* data = file.GetData() + sizeof(CacheHeader);
+
+		RenderState::BindTexture(GL_TEXTURE_CUBE_MAP, prefiltered.m_ID);
+		for (uint32_t level = 0; level < settings.s_PrefilterLevels; ++level)
+		{
+			uint32_t size = settings.s_PrefilterSize >> level;
+			for (unsigned i = 0; i < 6; ++i)
+			{
+				glTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, level, 0, 0, size, size,
+					GL_RGBA, GL_HALF_FLOAT, data);
+				data += FaceBytes(size);
+			}
+		}
+
+		RenderState::BindTexture(GL_TEXTURE_2D, brdf.m_ID);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, settings.s_BRDFSize, settings.s_BRDFSize,
+			GL_RG, GL_HALF_FLOAT, data);
+
+		return true;
+	}
+
+	bool IBLCache::Save(const std::string& hdrPath, const IBLSettings& settings,
+		const Texture& prefiltered, const Texture& brdf)
+	{
+		uint64_t hash = MappedFile::HashContents(hdrPath);
+		if (hash == 0)
+		{
+			return false;
+		}
+
+		std::ofstream out(GetCachePath(hdrPath), std::ios::binary | std::ios::trunc);
+		if (!out)
+		{
+			std::cout << "IBL CACHE ERROR: Could not write " << GetCachePath(hdrPath) << std::endl;
+			return false;
+		}
+
+		CacheHeader header = { CacheMagic, Version, hash, settings };
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+		// sized for the largest image written below
+		std::vector<uint8_t> pixels(std::max(FaceBytes(settings.s_PrefilterSize),
+			static_cast<size_t>(settings.s_BRDFSize) * settings.s_BRDFSize * LUTTexelBytes));
+
+		RenderState::BindTexture(GL_TEXTURE_CUBE_MAP, prefiltered.m_ID);
+		for (uint32_t level = 0; level < settings.s_PrefilterLevels; ++level)
+		{
+			for (unsigned i = 0; i < 6; ++i)
+			{
+				glGetTexImage(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, level, GL_RGBA, GL_HALF_FLOAT, pixels.data());
+				out.write(reinterpret_cast<const char*>(pixels.data()), FaceBytes(settings.s_PrefilterSize >> level));
+			}
+		}
+
+		RenderState::BindTexture(GL_TEXTURE_2D, brdf.m_ID);
+		glGetTexImage(GL_TEXTURE_2D, 0, GL_RG, GL_HALF_FLOAT, pixels.data());
+		out.write(reinterpret_cast<const char*>(pixels.data()),
+			static_cast<size_t>(settings.s_BRDFSize) * settings.s_BRDFSize * LUTTexelBytes);
+
+		return static_cast<bool>(out);
+	}
+}
@@ -0,0 +1,45 @@
+#ifndef IBLCACHE_H
+#define IBLCACHE_H
+
+#include <string>
+#include <cstdint>
+
+#include "Texture.h"
+
+namespace ARIS
+{
+	// Sizes and sample counts of the baked IBL maps; all of them are part of the cache key
+	struct IBLSettings
+	{
+		uint32_t s_EnvironmentSize = 2048;
+		uint32_t s_PrefilterSize = 512;
+		uint32_t s_PrefilterLevels = 7;
+		uint32_t s_PrefilterSamples = 20;
+		uint32_t s_BRDFSize = 512;
+		uint32_t s_BRDFSamples = 20;
+	};
+
+	// Baked specular IBL maps of an HDR environment (prefiltered mip chain and
+	// BRDF lookup table), stored in half floats next to the source as
+	// "<hdr>.arisibl". A cache is only used if its format version, the bake
+	// settings and the hash of the HDR file's contents all match. Diffuse
+	// irradiance isn't cached; it's SH, projected on the CPU in a few ms.
+	class IBLCache
+	{
+	public:
+		// Bump whenever the file layout or any of the bake shaders change
+		static constexpr uint32_t Version = 2;
+
+		static std::string GetCachePath(const std::string& hdrPath);
+
+		// Upload a valid cache into textures already allocated for these settings;
+		// returns false if it's missing or stale. Both calls read or write GL
+		// textures, so they must run on the render thread.
+		static bool Load(const std::string& hdrPath, const IBLSettings& settings,
+			Texture& prefiltered, Texture& brdf);
+		static bool Save(const std::string& hdrPath, const IBLSettings& settings,
+			const Texture& prefiltered, const Texture& brdf);
+	};
+}
+
+#endif
@@ -0,0 +1,442 @@
+#include <arpch.h>
+
+#include "SphereHarmonics.hpp"
+#include "HDRLoader.hpp"
+#include "Timer.h"
+
+#include <cmath>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define ARIS_SH_SSE
+#endif
+
+namespace ARIS
+{
+    namespace
+    {
+        constexpr double PI = 3.14159265358979323846;
+
+        // Normalization constants with each polynomial's own factors folded in
+        constexpr float K00 = 0.282094792f;  // 1/2 sqrt(1/pi)
+        constexpr float K1 = 0.488602512f;   // 1/2 sqrt(3/pi)
+        constexpr float K21 = 1.092548431f;  // 1/2 sqrt(15/pi)
+        constexpr float K20 = 0.315391565f;  // 1/4 sqrt(5/pi)
+        constexpr float K22 = 0.546274215f;  // 1/4 sqrt(15/pi)
+        constexpr float K33 = 0.590043590f;  // 1/4 sqrt(35/(2pi))
+        constexpr float K32 = 2.890611442f;  // 1/2 sqrt(105/pi)
+        constexpr float K31 = 0.457045799f;  // 1/4 sqrt(21/(2pi))
+        constexpr float K30 = 0.373176332f;  // 1/4 sqrt(7/pi)
+        constexpr float K32b = 1.445305721f; // 1/4 sqrt(105/pi)
+
+        // Every basis function up to bands at once; T is float, double or Lane4
+        template <typename T>
+        void Basis(T x, T y, T z, T* out, int bands)
+        {
+            out[0] = T(K00);
+            if (bands < 2)
+                return;
+
+            out[1] = T(K1) * y;
+            out[2] = T(K1) * z;
+            out[3] = T(K1) * x;
+            if (bands < 3)
+                return;
+
+            T xx = x * x, yy = y * y, zz = z * z;
+            out[4] = T(K21) * x * y;
+            out[5] = T(K21) * y * z;
+            out[6] = T(K20) * (T(3.0f) * zz - T(1.0f));
+            out[7] = T(K21) * x * z;
+            out[8] = T(K22) * (xx - yy);
+            if (bands < 4)
+                return;
+
+            out[9] = T(K33) * y * (T(3.0f) * xx - yy);
+            out[10] = T(K32) * x * y * z;
+            out[11] = T(K31) * y * (T(4.0f) * zz - xx - yy);
+            out[12] = T(K30) * z * (T(2.0f) * zz - T(3.0f) * xx - T(3.0f) * yy);
+            out[13] = T(K31) * x * (T(4.0f) * zz - xx - yy);
+            out[14] = T(K32b) * z * (xx - yy);
+            out[15] = T(K33) * x * (xx - T(3.0f) * yy);
+        }
+
+        // Four directions side by side
+        struct Lane4
+        {
+#ifdef ARIS_SH_SSE
+            __m128 v;
+
+            Lane4(float f = 0.0f) : v(_mm_set1_ps(f)) {}
+            Lane4(__m128 m) : v(m) {}
+            Lane4(float a, float b, float c, float d) : v(_mm_setr_ps(a, b, c, d)) {}
+
+            Lane4 operator+(const Lane4& o) const { return _mm_add_ps(v, o.v); }
+            Lane4 operator-(const Lane4& o) const { return _mm_sub_ps(v, o.v); }
+            Lane4 operator*(const Lane4& o) const { return _mm_mul_ps(v, o.v); }
+
+            float Sum() const
+            {
+                float f[4];
+                _mm_storeu_ps(f, v);
+                return (f[0] + f[1]) + (f[2] + f[3]);
+            }
+#else
+            float v[4];
+
+            Lane4(float f = 0.0f) : v{ f, f, f, f } {}
+            Lane4(float a, float b, float c, float d) : v{ a, b, c, d } {}
+
+            Lane4 operator+(const Lane4& o) const { return { v[0] + o.v[0], v[1] + o.v[1], v[2] + o.v[2], v[3] + o.v[3] }; }
+            Lane4 operator-(const Lane4& o) const { return { v[0] - o.v[0], v[1] - o.v[1], v[2] - o.v[2], v[3] - o.v[3] }; }
+            Lane4 operator*(const Lane4& o) const { return { v[0] * o.v[0], v[1] * o.v[1], v[2] * o.v[2], v[3] * o.v[3] }; }
+
+            float Sum() const { return (v[0] + v[1]) + (v[2] + v[3]); }
+#endif
+        };
+
+        // One row's worth of weighted samples, kept in float lanes
+        struct RowSums
+        {
+            Lane4 s_Sums[SphereHarmonics::MaxCoefficients][3];
+        };
+
+        // Up to four texels of a row (missing ones repeat the last and get zero weight)
+        void Accumulate(RowSums& row, int count, const Lane4& x, const Lane4& y, const Lane4& z,
+            const Lane4& weight, const float* texels, int channels, int first, int width, int bands)
+        {
+            const float* p[4];
+            for (int i = 0; i < 4; ++i)
+            {
+                p[i] = texels + std::min(first + i, width - 1) * channels;
+            }
+
+            Lane4 r = Lane4(p[0][0], p[1][0], p[2][0], p[3][0]) * weight;
+            Lane4 g = Lane4(p[0][1], p[1][1], p[2][1], p[3][1]) * weight;
+            Lane4 b = Lane4(p[0][2], p[1][2], p[2][2], p[3][2]) * weight;
+
+            Lane4 basis[SphereHarmonics::MaxCoefficients];
+            Basis(x, y, z, basis, bands);
+
+            for (int k = 0; k < count; ++k)
+            {
+                row.s_Sums[k][0] = row.s_Sums[k][0] + basis[k] * r;
+                row.s_Sums[k][1] = row.s_Sums[k][1] + basis[k] * g;
+                row.s_Sums[k][2] = row.s_Sums[k][2] + basis[k] * b;
+            }
+        }
+
+        // Run rowFn(row, sums) over every row in parallel. Rows sum in float lanes,
+        // then into per-thread doubles, which are reduced once at the end.
+        template <typename RowFn>
+        std::vector<glm::vec3> ProjectRows(int rows, int bands, RowFn rowFn)
+        {
+            int count = bands * bands;
+            std::vector<double> total(count * 3, 0.0);
+
+        #pragma omp parallel
+            {
+                std::vector<double> partial(count * 3, 0.0);
+                RowSums row;
+
+        #pragma omp for schedule(static)
+                for (int r = 0; r < rows; ++r)
+                {
+                    for (int k = 0; k < count; ++k)
+                    {
+                        row.s_Sums[k][0] = row.s_Sums[k][1] = row.s_Sums[k][2] = Lane4(0.0f);
+                    }
+
+                    rowFn(r, row);
+
+                    for (int k = 0; k < count; ++k)
+                    {
+                        for (int c = 0; c < 3; ++c)
+                        {
+                            partial[k * 3 + c] += row.s_Sums[k][c].Sum();
+                        }
+                    }
+                }
+
+        #pragma omp critical
+                for (int i = 0; i < count * 3; ++i)
+                {
+                    total[i] += partial[i];
+                }
+            }
+
+            std::vector<glm::vec3> coeffs(count);
+            for (int k = 0; k < count; ++k)
+            {
+                coeffs[k] = glm::vec3(total[k * 3 + 0], total[k * 3 + 1], total[k * 3 + 2]);
+            }
+
+            return coeffs;
+        }
+
+        // Equirect texel centre -> world direction (inverse of DirToUV in EquirectToCube.cmpt);
+        // row counts from the top of the image
+        glm::dvec3 EquirectDirection(int row, int col, int width, int height)
+        {
+            double theta = PI * (row + 0.5) / height;
+            double phi = PI - 2.0 * PI * (col + 0.5) / width;
+
+            return glm::dvec3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+        }
+    }
+
+    void SphereHarmonics::EvaluateBasis(const glm::vec3& N, float* out, int bands)
+    {
+        Basis(N.x, N.y, N.z, out, std::clamp(bands, 1, MaxBands));
+    }
+
+    glm::vec3 SphereHarmonics::Evaluate(const std::vector<glm::vec3>& coeffs, const glm::vec3& N)
+    {
+        float basis[MaxCoefficients];
+        int bands = static_cast<int>(std::sqrt(static_cast<float>(coeffs.size())) + 0.5f);
+        EvaluateBasis(N, basis, bands);
+
+        glm::vec3 result(0.0f);
+        for (size_t k = 0; k < coeffs.size() && k < MaxCoefficients; ++k)
+        {
+            result += coeffs[k] * basis[k];
+        }
+
+        return result;
+    }
+
+    std::vector<glm::vec3> SphereHarmonics::ProjectEquirect(const float* pixels, int width, int height,
+        int channels, bool bottomUp, int bands)
+    {
+        bands = std::clamp(bands, 1, MaxBands);
+
+        // per-column direction terms, padded to whole lane groups (padding has zero weight)
+        int padded = (width + 3) & ~3;
+        std::vector<float> cosPhi(padded, 0.0f), sinPhi(padded, 0.0f), valid(padded, 0.0f);
+        for (int c = 0; c < width; ++c)
+        {
+            double phi = PI - 2.0 * PI * (c + 0.5) / width;
+            cosPhi[c] = static_cast<float>(std::cos(phi));
+            sinPhi[c] = static_cast<float>(std::sin(phi));
+            valid[c] = 1.0f;
+        }
+
+        // solid angle of a texel is sin(theta) dtheta dphi
+        float dArea = static_cast<float>((PI / height) * (2.0 * PI / width));
+
+        return ProjectRows(height, bands, [&](int r, RowSums& sums)
+        {
+            double theta = PI * (r + 0.5) / height;
+            float sinTheta = static_cast<float>(std::sin(theta));
+            Lane4 y(static_cast<float>(std::cos(theta)));
+            Lane4 rowWeight(sinTheta * dArea);
+            Lane4 s(sinTheta);
+
+            const float* texels = pixels + static_cast<size_t>(bottomUp ? height - 1 - r : r) * width * channels;
+
+            for (int c = 0; c < width; c += 4)
+            {
+                Lane4 x = s * Lane4(cosPhi[c], cosPhi[c + 1], cosPhi[c + 2], cosPhi[c + 3]);
+                Lane4 z = s * Lane4(sinPhi[c], sinPhi[c + 1], sinPhi[c + 2], sinPhi[c + 3]);
+                Lane4 weight = rowWeight * Lane4(valid[c], valid[c + 1], valid[c + 2], valid[c + 3]);
+
+                Accumulate(sums, bands * bands, x, y, z, weight, texels, channels, c, width, bands);
+            }
+        });
+    }
+
+    std::vector<glm::vec3> SphereHarmonics::ProjectCubemap(const float* const faces[6], int size,
+        int channels, int bands)
+    {
+        bands = std::clamp(bands, 1, MaxBands);
+
+        // GL face layout: direction = major axis + u * uAxis + v * vAxis, with (u, v) = 2 * (s, t) - 1
+        static const glm::vec3 axes[6][3] =
+        {
+            { {  1.0f,  0.0f,  0.0f }, { 0.0f, 0.0f, -1.0f }, { 0.0f, -1.0f,  0.0f } },
+            { { -1.0f,  0.0f,  0.0f }, { 0.0f, 0.0f,  1.0f }, { 0.0f, -1.0f,  0.0f } },
+            { {  0.0f,  1.0f,  0.0f }, { 1.0f, 0.0f,  0.0f }, { 0.0f,  0.0f,  1.0f } },
+            { {  0.0f, -1.0f,  0.0f }, { 1.0f, 0.0f,  0.0f }, { 0.0f,  0.0f, -1.0f } },
+            { {  0.0f,  0.0f,  1.0f }, { 1.0f, 0.0f,  0.0f }, { 0.0f, -1.0f,  0.0f } },
+            { {  0.0f,  0.0f, -1.0f }, {-1.0f, 0.0f,  0.0f }, { 0.0f, -1.0f,  0.0f } }
+        };
+
+        int padded = (size + 3) & ~3;
+        std::vector<float> u(padded, 0.0f), valid(padded, 0.0f);
+        for (int i = 0; i < size; ++i)
+        {
+            u[i] = 2.0f * (i + 0.5f) / size - 1.0f;
+            valid[i] = 1.0f;
+        }
+
+        // a texel at (u, v) subtends (2 / size)^2 / (1 + u^2 + v^2)^(3/2)
+        float dArea = (2.0f / size) * (2.0f / size);
+
+        return ProjectRows(6 * size, bands, [&](int row, RowSums& sums)
+        {
+            int face = row / size;
+            int t = row % size;
+            float v = 2.0f * (t + 0.5f) / size - 1.0f;
+
+            const glm::vec3& major = axes[face][0];
+            const glm::vec3& uAxis = axes[face][1];
+            const glm::vec3& vAxis = axes[face][2];
+
+            const float* texels = faces[face] + static_cast<size_t>(t) * size * channels;
+
+            for (int s = 0; s < size; s += 4)
+            {
+                Lane4 lu(u[s], u[s + 1], u[s + 2], u[s + 3]);
+
+                float inv[4], w[4];
+                for (int i = 0; i < 4; ++i)
+                {
+                    inv[i] = 1.0f / std::sqrt(1.0f + u[s + i] * u[s + i] + v * v);
+                    w[i] = dArea * inv[i] * inv[i] * inv[i] * valid[s + i];
+                }
+                Lane4 invLength(inv[0], inv[1], inv[2], inv[3]);
+
+                Lane4 x = (Lane4(major.x + v * vAxis.x) + lu * Lane4(uAxis.x)) * invLength;
+                Lane4 y = (Lane4(major.y + v * vAxis.y) + lu * Lane4(uAxis.y)) * invLength;
+                Lane4 z = (Lane4(major.z + v * vAxis.z) + lu * Lane4(uAxis.z)) * invLength;
+
+                Accumulate(sums, bands * bands, x, y, z, Lane4(w[0], w[1], w[2], w[3]), texels, channels, s, size, bands);
+            }
+        });
+    }
+
+    std::vector<glm::vec3> SphereHarmonics::ProjectEquirectReference(const float* pixels, int width, int height,
+        int channels, bool bottomUp, int bands)
+    {
+        bands = std::clamp(bands, 1, MaxBands);
+        int count = bands * bands;
+
+        std::vector<double> total(count * 3, 0.0);
+        double dArea = (PI / height) * (2.0 * PI / width);
+
+        for (int r = 0; r < height; ++r)
+        {
+            const float* texels = pixels + static_cast<size_t>(bottomUp ? height - 1 - r : r) * width * channels;
+            double weight = std::sin(PI * (r + 0.5) / height) * dArea;
+
+            for (int c = 0; c < width; ++c)
+            {
+                glm::dvec3 N = EquirectDirection(r, c, width, height);
+
+                double basis[MaxCoefficients];
+                Basis(N.x, N.y, N.z, basis, bands);
+
+                for (int k = 0; k < count; ++k)
+                {
+                    for (int ch = 0; ch < 3; ++ch)
+                    {
+                        total[k * 3 + ch] += texels[c * channels + ch] * basis[k] * weight;
+                    }
+                }
+            }
+        }
+
+        std::vector<glm::vec3> coeffs(count);
+        for (int k = 0; k < count; ++k)
+        {
+            coeffs[k] = glm::vec3(total[k * 3 + 0], total[k * 3 + 1], total[k * 3 + 2]);
+        }
+
+        return coeffs;
+    }
+
+    void SphereHarmonics::ConvolveIrradiance(std::vector<glm::vec3>& coeffs)
+    {
+        // clamped cosine lobe per band; odd bands above 1 vanish
+        const float lobe[MaxBands] = { static_cast<float>(PI), static_cast<float>(2.0 * PI / 3.0), static_cast<float>(PI / 4.0), 0.0f };
+
+        for (size_t k = 0; k < coeffs.size(); ++k)
+        {
+            int band = static_cast<int>(std::sqrt(static_cast<float>(k)));
+            coeffs[k] *= lobe[std::min(band, MaxBands - 1)];
+        }
+    }
+
+    SH9Color SphereHarmonics::GenerateLightingCoefficients(const ImageData& hdrMap)
+    {
+        if (!hdrMap.s_Pixels || !hdrMap.s_HDR || hdrMap.s_Channels < 3)
+        {
+            SH9Color res;
+            res.results.resize(9);
+            return res;
+        }
+
+        return GenerateLightingCoefficients(ProjectEquirect(static_cast<const float*>(hdrMap.s_Pixels.get()),
+            hdrMap.s_Width, hdrMap.s_Height, hdrMap.s_Channels, true));
+    }
+
+    SH9Color SphereHarmonics::GenerateLightingCoefficients(const std::vector<glm::vec3>& radiance)
+    {
+        SH9Color res;
+        res.results = radiance;
+        res.results.resize(9);
+
+        ConvolveIrradiance(res.results);
+
+        return res;
+    }
+
+    void SphereHarmonics::WriteToHDR(std::string dir, const SH9Color& coeffs)
+    {
+        int outW = 400;
+        int outH = 200;
+        std::vector<float> outImg = std::vector<float>(outW * outH * 3);
+        std::string outN = dir + "output.hdr";
+
+    #pragma omp parallel for schedule(static)
+        for (int y = 0; y < outH; ++y)
+        {
+            for (int x = 0; x < outW; ++x)
+            {
+                glm::vec3 color = Evaluate(coeffs.results, glm::vec3(EquirectDirection(y, x, outW, outH)));
+
+                int curr = (y * outW + x) * 3;
+                outImg[curr + 0] = color.x;
+                outImg[curr + 1] = color.y;
+                outImg[curr + 2] = color.z;
+            }
+        }
+
+        HDRLoader::WriteHDR(outN, outImg, outW, outH);
+    }
+
+    SphereHarmonics::Benchmark SphereHarmonics::RunBenchmark(const ImageData& hdrMap, int bands)
+    {
+        Benchmark result;
+        if (!hdrMap.s_Pixels || !hdrMap.s_HDR || hdrMap.s_Channels < 3)
+            return result;
+
+        const float* pixels = static_cast<const float*>(hdrMap.s_Pixels.get());
+
+        // best of a few runs; the first one also pays for thread start-up
+        std::vector<glm::vec3> fast;
+        result.s_ProjectMs = FLT_MAX;
+        for (int i = 0; i < 5; ++i)
+        {
+            Timer timer;
+            fast = ProjectEquirect(pixels, hdrMap.s_Width, hdrMap.s_Height, hdrMap.s_Channels, true, bands);
+            result.s_ProjectMs = std::min(result.s_ProjectMs, timer.ElapsedMillis());
+        }
+
+        Timer timer;
+        std::vector<glm::vec3> reference = ProjectEquirectReference(pixels, hdrMap.s_Width, hdrMap.s_Height,
+            hdrMap.s_Channels, true, bands);
+        result.s_ReferenceMs = timer.ElapsedMillis();
+
+        double scale = std::max({ std::abs(reference[0].x), std::abs(reference[0].y), std::abs(reference[0].z), 1e-6f });
+        for (size_t k = 0; k < reference.size(); ++k)
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                result.s_MaxError = std::max(result.s_MaxError, std::abs(static_cast<double>(fast[k][c]) - reference[k][c]) / scale);
+            }
+        }
+
+        return result;
+    }
+}
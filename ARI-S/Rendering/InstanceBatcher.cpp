@@ -0,0 +1,263 @@
+#include <arpch.h>
+#include "InstanceBatcher.h"
+#include "Hasher.hpp"
+
+#include <numeric>
+
+namespace ARIS
+{
+	void InstanceBatcher::Begin(RenderPass pass, const glm::mat4& view)
+	{
+		m_Pass = pass;
+		m_View = view;
+
+		m_Visible = 0;
+		m_Culled = 0;
+		m_MaterialChanges = 0;
+
+		// groups stay in the table (empty ones are skipped when drawing) so their
+		// instance storage is reused from pass to pass, until they go unused for a while
+		// (an edited material or a reloaded model never comes back under the old key)
+		size_t before = m_Batches.size();
+
+		m_Batches.erase(std::remove_if(m_Batches.begin(), m_Batches.end(), [](Batch& b)
+		{
+			b.s_Idle = b.s_Instances.empty() ? b.s_Idle + 1 : 0;
+			return b.s_Idle > MaxIdlePasses || b.s_Resource.expired();
+		}), m_Batches.end());
+
+		if (m_Batches.size() != before)
+		{
+			Reindex();
+		}
+
+		for (Batch& b : m_Batches)
+		{
+			b.s_Instances.clear();
+			b.s_Depths.clear();
+		}
+	}
+
+	size_t InstanceBatcher::MaterialKeyHash::operator()(const MaterialKey& k) const
+	{
+		size_t seed = 0;
+		HashCombine(seed, k.s_Controllable, k.s_Metalness, k.s_Roughness);
+
+		for (GLuint id : k.s_Textures)
+		{
+			HashCombine(seed, id);
+		}
+
+		for (const auto& [id, type] : k.s_Overrides)
+		{
+			HashCombine(seed, id, type);
+		}
+
+		return seed;
+	}
+
+	size_t InstanceBatcher::BatchKeyHash::operator()(const BatchKey& k) const
+	{
+		size_t seed = MaterialKeyHash{}(k.s_Material);
+		HashCombine(seed, k.s_Resource);
+		return seed;
+	}
+
+	void InstanceBatcher::Reindex()
+	{
+		m_BatchLookup.clear();
+		m_MaterialIDs.clear();
+		m_MeshIDs.clear();
+
+		for (uint32_t i = 0; i < m_Batches.size(); ++i)
+		{
+			Batch& b = m_Batches[i];
+
+			m_BatchLookup.emplace(b.s_Key, i);
+			b.s_MaterialID = GetMaterialID(b.s_Key.s_Material);
+			b.s_MeshID = GetMeshID(b.s_Key.s_Resource);
+		}
+	}
+
+	uint32_t InstanceBatcher::GetMaterialID(const MaterialKey& material)
+	{
+		auto it = m_MaterialIDs.find(material);
+		if (it != m_MaterialIDs.end())
+			return it->second;
+
+		uint32_t id = static_cast<uint32_t>(m_MaterialIDs.size());
+		m_MaterialIDs.emplace(material, id);
+		return id;
+	}
+
+	uint32_t InstanceBatcher::GetMeshID(const MeshResource* mesh)
+	{
+		auto it = m_MeshIDs.find(mesh);
+		if (it != m_MeshIDs.end())
+			return it->second;
+
+		uint32_t id = static_cast<uint32_t>(m_MeshIDs.size());
+		m_MeshIDs[mesh] = id;
+		return id;
+	}
+
+	void InstanceBatcher::Submit(MeshComponent& mc, const glm::mat4& transform, int entityID, const Frustum* frustum)
+	{
+		Model* model = mc.GetModel();
+		if (!model)
+			return;
+
+		const std::vector<BoundingBox>& bounds = mc.GetWorldBounds();
+
+		for (unsigned i = 0; i < model->m_Meshes.size(); ++i)
+		{
+			Mesh& mesh = model->m_Meshes[i];
+
+			if (!mesh.GetResource())
+				continue;
+
+			if (frustum && i < bounds.size() && !frustum->Intersects(bounds[i]))
+			{
+				++m_Culled;
+				continue;
+			}
+
+			++m_Visible;
+
+			MaterialKey& material = m_Key.s_Material;
+			material.s_Controllable = mc.GetControllableMetRough();
+			material.s_Metalness = mc.GetMetalness();
+			material.s_Roughness = mc.GetRoughness();
+
+			material.s_Textures.clear();
+			for (const Texture& t : mesh.m_Textures)
+			{
+				material.s_Textures.push_back(t.m_ID);
+			}
+
+			material.s_Overrides.clear();
+			for (Texture* t : mc.GetOverrides())
+			{
+				material.s_Overrides.emplace_back(t->m_ID, static_cast<int>(t->type));
+			}
+
+			m_Key.s_Resource = mesh.GetResource().get();
+
+			auto it = m_BatchLookup.find(m_Key);
+			if (it == m_BatchLookup.end())
+			{
+				it = m_BatchLookup.emplace(m_Key, static_cast<uint32_t>(m_Batches.size())).first;
+				m_Batches.emplace_back();
+
+				Batch& created = m_Batches.back();
+				created.s_Key = m_Key;
+				created.s_Resource = mesh.GetResource();
+				created.s_MaterialID = GetMaterialID(material);
+				created.s_MeshID = GetMeshID(m_Key.s_Resource);
+			}
+
+			Batch& b = m_Batches[it->second];
+
+			// same address as a resource that has since been freed; Begin() drops
+			// these, so this only happens when one is replaced mid-pass
+			if (b.s_Resource.expired())
+			{
+				b.s_Instances.clear();
+				b.s_Depths.clear();
+				b.s_Resource = mesh.GetResource();
+			}
+
+			b.s_Mesh = &mesh;
+			b.s_Material = &mc;
+
+			glm::vec3 center = i < bounds.size() ? bounds[i].Center() : glm::vec3(transform[3]);
+			float depth = -(m_View * glm::vec4(center, 1.0f)).z;
+
+			b.s_MinDepth = b.s_Instances.empty() ? depth : glm::min(b.s_MinDepth, depth);
+			b.s_Instances.push_back({ transform, static_cast<uint32_t>(entityID) });
+			b.s_Depths.push_back(depth);
+		}
+	}
+
+	void InstanceBatcher::Draw(Shader& s, bool bindMaterial)
+	{
+		m_Queue.Clear();
+		for (uint32_t i = 0; i < m_Batches.size(); ++i)
+		{
+			const Batch& b = m_Batches[i];
+			if (b.s_Instances.empty())
+				continue;
+
+			m_Queue.Push(RenderQueue::MakeKey(m_Pass, s.m_ID, b.s_MaterialID, b.s_MeshID, b.s_MinDepth), i);
+		}
+		m_Queue.Sort();
+
+		s.Activate();
+		s.SetBool("instanced", true);
+
+		uint32_t boundMaterial = ~0u;
+
+		for (const RenderQueue::Item& item : m_Queue)
+		{
+			Batch& b = m_Batches[item.s_Index];
+
+			// front-to-back inside the group so early depth rejects more
+			const std::vector<InstanceData>* instances = &b.s_Instances;
+			if (b.s_Instances.size() > 1)
+			{
+				m_Order.resize(b.s_Instances.size());
+				std::iota(m_Order.begin(), m_Order.end(), 0u);
+				std::sort(m_Order.begin(), m_Order.end(),
+					[&b](uint32_t x, uint32_t y) { return b.s_Depths[x] < b.s_Depths[y]; });
+
+				m_Sorted.clear();
+				for (uint32_t index : m_Order)
+				{
+					m_Sorted.push_back(b.s_Instances[index]);
+				}
+
+				instances = &m_Sorted;
+			}
+
+			// consecutive groups with the same material keep its uniforms and textures
+			bool newMaterial = bindMaterial && b.s_MaterialID != boundMaterial;
+			if (newMaterial)
+			{
+				s.SetFloat("metalVal", b.s_Material->GetMetalness());
+				s.SetFloat("roughVal", b.s_Material->GetRoughness());
+				s.SetBool("controllable", b.s_Material->GetControllableMetRough());
+
+				boundMaterial = b.s_MaterialID;
+				++m_MaterialChanges;
+			}
+
+			b.s_Mesh->DrawInstanced(s, *instances, b.s_Material->GetOverrides(), newMaterial);
+		}
+
+		s.SetBool("instanced", false);
+		RenderState::UseProgram(0);
+	}
+
+	unsigned InstanceBatcher::GetBatchCount() const
+	{
+		unsigned count = 0;
+		for (const Batch& b : m_Batches)
+		{
+			if (!b.s_Instances.empty())
+				++count;
+		}
+
+		return count;
+	}
+
+	unsigned InstanceBatcher::GetInstanceCount() const
+	{
+		unsigned count = 0;
+		for (const Batch& b : m_Batches)
+		{
+			count += static_cast<unsigned>(b.s_Instances.size());
+		}
+
+		return count;
+	}
+}
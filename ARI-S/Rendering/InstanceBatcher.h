@@ -0,0 +1,127 @@
+#ifndef INSTANCEBATCHER_H
+#define INSTANCEBATCHER_H
+
+#include "MeshComponent.hpp"
+#include "Shader.h"
+#include "RenderQueue.hpp"
+#include "Culling/Frustum.hpp"
+
+#include <glm.hpp>
+#include <unordered_map>
+#include <vector>
+
+namespace ARIS
+{
+	// Groups MeshComponents that share a mesh resource and material so each
+	// group can be drawn with a single glDrawElementsInstanced call. Groups
+	// are drawn in render queue order (material, then nearest instance
+	// first), instances within a group front-to-back.
+	class InstanceBatcher
+	{
+	public:
+		// everything the G-buffer pass reads besides geometry, compared by value
+		struct MaterialKey
+		{
+			bool s_Controllable = false;
+			float s_Metalness = 0.0f;
+			float s_Roughness = 0.0f;
+
+			std::vector<GLuint> s_Textures;
+			std::vector<std::pair<GLuint, int>> s_Overrides;
+
+			bool operator==(const MaterialKey& other) const
+			{
+				return s_Controllable == other.s_Controllable && s_Metalness == other.s_Metalness
+					&& s_Roughness == other.s_Roughness && s_Textures == other.s_Textures && s_Overrides == other.s_Overrides;
+			}
+		};
+
+		struct BatchKey
+		{
+			MaterialKey s_Material;
+			const MeshResource* s_Resource = nullptr;
+
+			bool operator==(const BatchKey& other) const { return s_Resource == other.s_Resource && s_Material == other.s_Material; }
+		};
+
+		struct Batch
+		{
+			BatchKey s_Key;
+			// detects a freed resource whose address was handed to a new one
+			std::weak_ptr<MeshResource> s_Resource;
+			// passes in a row this batch received no instances
+			unsigned s_Idle = 0;
+
+			Mesh* s_Mesh = nullptr;
+			MeshComponent* s_Material = nullptr;
+
+			uint32_t s_MaterialID = 0;
+			uint32_t s_MeshID = 0;
+
+			std::vector<InstanceData> s_Instances;
+			std::vector<float> s_Depths;
+			float s_MinDepth = 0.0f;
+		};
+
+		// Start a new pass; keeps the allocations of batches used recently and
+		// drops the ones that stayed empty for MaxIdlePasses passes
+		// view - used for the view-space depth that orders instances
+		void Begin(RenderPass pass = RenderPass::Geometry, const glm::mat4& view = glm::mat4(1.0f));
+		// frustum - if given, meshes whose world bounds fall outside it are skipped
+		void Submit(MeshComponent& mc, const glm::mat4& transform, int entityID = -1, const Frustum* frustum = nullptr);
+
+		// bindMaterial - false for depth-only passes (e.g. shadows)
+		void Draw(Shader& s, bool bindMaterial = true);
+
+		unsigned GetBatchCount() const;
+		unsigned GetInstanceCount() const;
+
+		unsigned GetVisibleCount() const { return m_Visible; }
+		unsigned GetCulledCount() const { return m_Culled; }
+		unsigned GetMaterialChanges() const { return m_MaterialChanges; }
+
+		// a few passes of slack so alternating passes (e.g. shadow cascades) don't churn batches
+		static constexpr unsigned MaxIdlePasses = 8;
+
+	private:
+		struct MaterialKeyHash
+		{
+			size_t operator()(const MaterialKey& k) const;
+		};
+
+		struct BatchKeyHash
+		{
+			size_t operator()(const BatchKey& k) const;
+		};
+
+		uint32_t GetMaterialID(const MaterialKey& material);
+		uint32_t GetMeshID(const MeshResource* mesh);
+
+		// rebuilds the lookup and the compact IDs after batches were dropped
+		void Reindex();
+
+		std::vector<Batch> m_Batches;
+		std::unordered_map<BatchKey, uint32_t, BatchKeyHash> m_BatchLookup;
+
+		// compact IDs for the sort key, only for materials and meshes that still have a batch
+		std::unordered_map<MaterialKey, uint32_t, MaterialKeyHash> m_MaterialIDs;
+		std::unordered_map<const MeshResource*, uint32_t> m_MeshIDs;
+
+		// filled for each submitted mesh; reused so lookups don't allocate
+		BatchKey m_Key;
+
+		RenderQueue m_Queue;
+		RenderPass m_Pass = RenderPass::Geometry;
+		glm::mat4 m_View = glm::mat4(1.0f);
+
+		// scratch for front-to-back instance order
+		std::vector<uint32_t> m_Order;
+		std::vector<InstanceData> m_Sorted;
+
+		unsigned m_Visible = 0;
+		unsigned m_Culled = 0;
+		unsigned m_MaterialChanges = 0;
+	};
+}
+
+#endif
@@ -9,6 +9,7 @@
 #include <array>
 
 #include "Texture.h"
+#include "RenderState.h"
 
 namespace ARIS
 {
@@ -120,7 +121,7 @@ namespace ARIS
 
 		void Bind(bool rb = false)
 		{
-			glBindFramebuffer(GL_FRAMEBUFFER, m_ID);
+			RenderState::BindFramebuffer(GL_FRAMEBUFFER, m_ID);
 
 			if (rb)
 			{
@@ -130,7 +131,7 @@ namespace ARIS
 
 		void Unbind(bool rb = false)
 		{
-			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			RenderState::BindFramebuffer(GL_FRAMEBUFFER, 0);
 
 			if (rb)
 			{
@@ -140,7 +141,7 @@ namespace ARIS
 
 		void SetViewport()
 		{
-			glViewport(0, 0, m_Specs.s_Width, m_Specs.s_Height);
+			RenderState::Viewport(0, 0, m_Specs.s_Width, m_Specs.s_Height);
 		}
 
 		void Clear()
@@ -269,6 +270,19 @@ namespace ARIS
 			}
 		}
 
+		// Attach one layer of an array texture; attaching another layer to the
+		// same slot later just switches which layer is rendered to
+		void AttachTextureLayer(GLenum type, Texture t, GLint layer)
+		{
+			glFramebufferTextureLayer(GL_FRAMEBUFFER, type, t.m_ID, 0, layer);
+
+			if (type != GL_DEPTH_ATTACHMENT && type - GL_COLOR_ATTACHMENT0 >= m_ColorAttachments.size())
+			{
+				m_ColorAttachments.push_back(t);
+				m_Specs.s_Attachments.s_Attachments.push_back(FramebufferTexture(type, t.m_InternalFormat, t.m_DataFormat, GL_UNSIGNED_BYTE));
+			}
+		}
+
 		void AttachTexture(GLenum type, Texture t)
 		{
 			glFramebufferTexture2D(GL_FRAMEBUFFER, type, GL_TEXTURE_2D, t.m_ID, 0);
@@ -304,14 +318,58 @@ namespace ARIS
 			glClearTexImage(id, 0, format, type, &val);
 		}
 
+		// For unsigned integer attachments (glClear leaves those undefined)
+		void ClearAttachment(uint32_t attachmentIdx, uint32_t val)
+		{
+			GLuint id = m_ColorAttachments[attachmentIdx].m_ID;
+			GLenum format = m_ColorAttachments[attachmentIdx].m_DataFormat;
+
+			glClearTexImage(id, 0, format, GL_UNSIGNED_INT, &val);
+		}
+
+		// Integer attachments are read back in their own type, everything else as floats
+		GLenum GetReadType(uint32_t attachmentIdx) const
+		{
+			GLenum format = m_ColorAttachments[attachmentIdx].m_DataFormat;
+			bool integer = format == GL_RED_INTEGER || format == GL_RG_INTEGER || format == GL_RGBA_INTEGER;
+
+			return integer ? m_Specs.s_Attachments.s_Attachments[attachmentIdx].s_Type : GL_FLOAT;
+		}
+
 		int ReadPixel(uint32_t attachmentIdx, int x, int y)
 		{
 			Bind();
 			glReadBuffer(GL_COLOR_ATTACHMENT0 + attachmentIdx);
-			float pixel;
-			glReadPixels(x, y, 1, 1, m_ColorAttachments[attachmentIdx].m_DataFormat, GL_FLOAT, &pixel);
+
+			GLenum format = m_ColorAttachments[attachmentIdx].m_DataFormat;
+			GLenum type = GetReadType(attachmentIdx);
+
+			int pixel = 0;
+			if (type == GL_FLOAT)
+			{
+				float value;
+				glReadPixels(x, y, 1, 1, format, GL_FLOAT, &value);
+				pixel = static_cast<int>(value);
+			}
+			else
+			{
+				glReadPixels(x, y, 1, 1, format, type, &pixel);
+			}
+
+			Unbind();
+			return pixel;
+		}
+
+		// Queue a copy of one pixel into a pixel-pack buffer instead of client memory;
+		// returns immediately (see PixelReadback)
+		void ReadPixel(uint32_t attachmentIdx, int x, int y, GLuint packBuffer)
+		{
+			Bind();
+			glReadBuffer(GL_COLOR_ATTACHMENT0 + attachmentIdx);
+			RenderState::BindBuffer(GL_PIXEL_PACK_BUFFER, packBuffer);
+			glReadPixels(x, y, 1, 1, m_ColorAttachments[attachmentIdx].m_DataFormat, GetReadType(attachmentIdx), nullptr);
+			RenderState::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
 			Unbind();
-			return static_cast<int>(pixel);
 		}
 
 		void Cleanup()
@@ -324,6 +382,7 @@ namespace ARIS
 			m_DepthAttachment.Cleanup();
 
 			glDeleteFramebuffers(1, &m_ID);
+			RenderState::OnFramebufferDeleted(m_ID);
 		}
 
 		GLuint GetID() const { return m_ID; }
@@ -347,6 +406,101 @@ namespace ARIS
 		std::vector<Texture> m_ColorAttachments;
 		Texture m_DepthAttachment;
 	};
+
+	// Single-pixel reads through a ring of pixel-pack buffers guarded by fences.
+	// Request() only queues the copy; Poll() hands back the newest result once
+	// the GPU has finished it (typically a frame or two later), so reading never
+	// waits on the frame in flight.
+	class PixelReadback
+	{
+	public:
+		static constexpr unsigned RingSize = 3;
+
+		void Generate()
+		{
+			for (Slot& slot : m_Slots)
+			{
+				glGenBuffers(1, &slot.s_Buffer);
+				RenderState::BindBuffer(GL_PIXEL_PACK_BUFFER, slot.s_Buffer);
+				glBufferData(GL_PIXEL_PACK_BUFFER, sizeof(glm::vec4), nullptr, GL_STREAM_READ);
+			}
+			RenderState::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		}
+
+		void Cleanup()
+		{
+			for (Slot& slot : m_Slots)
+			{
+				if (slot.s_Fence)
+				{
+					glDeleteSync(slot.s_Fence);
+					slot.s_Fence = nullptr;
+				}
+
+				glDeleteBuffers(1, &slot.s_Buffer);
+				RenderState::OnBufferDeleted(slot.s_Buffer);
+				slot.s_Buffer = 0;
+			}
+
+			m_Pending = 0;
+		}
+
+		// Returns false (and queues nothing) if every slot is still in flight
+		bool Request(Framebuffer& fb, uint32_t attachmentIdx, int x, int y)
+		{
+			if (m_Pending == RingSize)
+				return false;
+
+			Slot& slot = m_Slots[(m_Oldest + m_Pending) % RingSize];
+			fb.ReadPixel(attachmentIdx, x, y, slot.s_Buffer);
+			slot.s_Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+			++m_Pending;
+			return true;
+		}
+
+		// Collect every finished read; value is set to the newest one (T must match
+		// the attachment's read type). Returns false if none has finished yet.
+		template<typename T>
+		bool Poll(T& value)
+		{
+			bool found = false;
+
+			while (m_Pending > 0)
+			{
+				Slot& slot = m_Slots[m_Oldest];
+
+				GLenum status = glClientWaitSync(slot.s_Fence, 0, 0);
+				if (status == GL_TIMEOUT_EXPIRED)
+					break;
+
+				glDeleteSync(slot.s_Fence);
+				slot.s_Fence = nullptr;
+
+				RenderState::BindBuffer(GL_PIXEL_PACK_BUFFER, slot.s_Buffer);
+				glGetBufferSubData(GL_PIXEL_PACK_BUFFER, 0, sizeof(T), &value);
+				found = true;
+
+				m_Oldest = (m_Oldest + 1) % RingSize;
+				--m_Pending;
+			}
+
+			if (found)
+				RenderState::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+			return found;
+		}
+
+	private:
+		struct Slot
+		{
+			GLuint s_Buffer = 0;
+			GLsync s_Fence = nullptr;
+		};
+
+		Slot m_Slots[RingSize];
+		unsigned m_Oldest = 0, m_Pending = 0;
+	};
 }
 
 #endif
\ No newline at end of file
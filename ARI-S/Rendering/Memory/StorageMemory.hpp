@@ -0,0 +1,65 @@
+#ifndef STORAGEMEMORY_HPP
+#define STORAGEMEMORY_HPP
+
+#include <glad/glad.h>
+
+#include "RenderState.h"
+
+namespace ARIS
+{
+	// Shader storage buffer bound to a fixed index. Unlike UniformBuffer it's
+	// sized at runtime and only reallocates when an upload outgrows it.
+	class StorageBuffer
+	{
+	public:
+		StorageBuffer(unsigned idx, GLsizeiptr size = 0)
+			: m_Index(idx)
+		{
+			glGenBuffers(1, &m_ID);
+			Reserve(size > 0 ? size : 16);
+		}
+
+		~StorageBuffer()
+		{
+			glDeleteBuffers(1, &m_ID);
+			RenderState::OnBufferDeleted(m_ID);
+		}
+
+		StorageBuffer(const StorageBuffer&) = delete;
+		StorageBuffer& operator=(const StorageBuffer&) = delete;
+
+		// Grow the buffer (contents are lost) and rebind it to its index
+		void Reserve(GLsizeiptr size)
+		{
+			if (size <= m_Size)
+			{
+				return;
+			}
+
+			m_Size = size;
+
+			RenderState::BindBuffer(GL_SHADER_STORAGE_BUFFER, m_ID);
+			glBufferData(GL_SHADER_STORAGE_BUFFER, m_Size, nullptr, GL_DYNAMIC_DRAW);
+
+			RenderState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, m_Index, m_ID);
+		}
+
+		void SetData(const void* data, GLsizeiptr size)
+		{
+			Reserve(size);
+
+			RenderState::BindBuffer(GL_SHADER_STORAGE_BUFFER, m_ID);
+			glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, size, data);
+		}
+
+		GLuint GetID() const { return m_ID; }
+		GLsizeiptr GetSize() const { return m_Size; }
+
+	private:
+		GLuint m_ID = 0;
+		unsigned m_Index;
+		GLsizeiptr m_Size = 0;
+	};
+}
+
+#endif
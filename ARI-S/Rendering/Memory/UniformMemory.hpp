@@ -4,6 +4,8 @@
 #include <glad/glad.h>
 #include <glm.hpp>
 
+#include "RenderState.h"
+
 #define NUM_LIGHTS 1
 #define MAX_LIGHTS 200 // breaks after going beyond 32 because ubo info is passed in incorrectly, pls fix later
 // ^^ note: breaks when the shader ubo info is not correct, or goes beyond 16KB (16k bytes)
@@ -18,25 +20,24 @@ namespace ARIS
 		{
 			glGenBuffers(1, &id);
 
-			glBindBuffer(GL_UNIFORM_BUFFER, id);
+			RenderState::BindBuffer(GL_UNIFORM_BUFFER, id);
 			glBufferData(GL_UNIFORM_BUFFER, sizeof(T), nullptr, GL_STATIC_DRAW);
-			glBindBuffer(GL_UNIFORM_BUFFER, 0);
+			RenderState::BindBuffer(GL_UNIFORM_BUFFER, 0);
 
-			glBindBufferBase(GL_UNIFORM_BUFFER, idx, id);
+			RenderState::BindBufferBase(GL_UNIFORM_BUFFER, idx, id);
 		}
 
+		// The buffer is left bound; the state cache skips the rebind on the next update
 		void SetData()
 		{
-			glBindBuffer(GL_UNIFORM_BUFFER, id);
+			RenderState::BindBuffer(GL_UNIFORM_BUFFER, id);
 			glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(T), &data);
-			glBindBuffer(GL_UNIFORM_BUFFER, 0);
 		}
 
 		void UpdateData(GLintptr offset)
 		{
-			glBindBuffer(GL_UNIFORM_BUFFER, id);
+			RenderState::BindBuffer(GL_UNIFORM_BUFFER, id);
 			glBufferSubData(GL_UNIFORM_BUFFER, offset, sizeof(T) - offset, static_cast<char*>(&data) + offset);
-			glBindBuffer(GL_UNIFORM_BUFFER, 0);
 		}
 
 		T& GetData()
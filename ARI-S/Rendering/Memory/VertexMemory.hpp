@@ -4,6 +4,8 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#include "RenderState.h"
+
 #include <map>
 
 namespace ARIS
@@ -39,18 +41,19 @@ namespace ARIS
 		void Cleanup()
 		{
 			glDeleteBuffers(1, &id);
+			RenderState::OnBufferDeleted(id);
 		}
 
 		// Bind buffer to use
 		void Bind()
 		{
-			glBindBuffer(type, id);
+			RenderState::BindBuffer(type, id);
 		}
 
 		// Unbind current buffer
 		void Unbind()
 		{
-			glBindBuffer(type, 0);
+			RenderState::BindBuffer(type, 0);
 		}
 
 		// Set the data of the currently bound buffer
@@ -58,7 +61,7 @@ namespace ARIS
 		// data - The data to upload
 		// usage - How the data is drawn (Usually STATIC_DRAW)
 		template<typename T>
-		void SetData(GLuint elements, T* data, GLenum usage)
+		void SetData(GLuint elements, const T* data, GLenum usage)
 		{
 			glBufferData(type, elements * sizeof(T), data, usage);
 		}
@@ -68,7 +71,7 @@ namespace ARIS
 		// elements - Number of elements in the data to set
 		// data - The data to update with
 		template<typename T>
-		void UpdateData(GLintptr offset, GLuint elements, T* data)
+		void UpdateData(GLintptr offset, GLuint elements, const T* data)
 		{
 			glBufferSubData(type, offset, elements * sizeof(T), data);
 		}
@@ -85,11 +88,11 @@ namespace ARIS
 		void SetAttPointer(GLuint idx, GLint size, GLenum type, GLuint stride, GLuint offset, GLuint divisor = 0,
 			bool manualOffset = false, bool manualStride = false)
 		{
-			if (type == GL_INT)
+			// integer attributes keep their exact value instead of being converted to float
+			if (type == GL_INT || type == GL_UNSIGNED_INT)
 			{
-				if (!manualOffset)
-					glVertexAttribIPointer(idx, size, type, manualStride ? stride : stride * sizeof(T), 
-						manualOffset ? (void*)offset : (void*)(offset * sizeof(T)));
+				glVertexAttribIPointer(idx, size, type, manualStride ? stride : stride * sizeof(T), 
+					manualOffset ? (void*)offset : (void*)(offset * sizeof(T)));
 			}
 			else
 			{
@@ -130,7 +133,7 @@ namespace ARIS
 		// Bind the vertex array
 		void Bind()
 		{
-			glBindVertexArray(id);
+			RenderState::BindVertexArray(id);
 		}
 
 		// Draw the elements of a vertex array
@@ -143,16 +146,18 @@ namespace ARIS
 		}
 
 		// Draw the elements of a vertex array, but instanced
-		// THIS GOES UNUSED FOR NOW (This exists because of importing from my other renderer)
-		//void Draw(GLenum mode, GLuint count, GLenum type, GLint indices, GLuint instanceCount = 1)
-		//{
-		//	glDrawElementsInstanced(mode, count, type, (void*)indices, instanceCount);
-		//}
+		// indices - Byte offset into the index buffer
+		// instanceCount - Number of instances to draw (per-instance attributes use a divisor)
+		void Draw(GLenum mode, GLuint count, GLenum type, GLint indices, GLuint instanceCount = 1)
+		{
+			glDrawElementsInstanced(mode, count, type, (void*)(intptr_t)indices, instanceCount);
+		}
 
 		// Clean up the vertex array
 		void Cleanup()
 		{
 			glDeleteVertexArrays(1, &id);
+			RenderState::OnVertexArrayDeleted(id);
 			for (auto& a : buffers)
 			{
 				a.second.Cleanup();
@@ -162,7 +167,7 @@ namespace ARIS
 		// Unbind the current vertex array
 		void Clear()
 		{
-			glBindVertexArray(0);
+			RenderState::BindVertexArray(0);
 		}
 
 	private:
@@ -6,177 +6,172 @@ namespace ARIS
 {
 	Mesh::Mesh()
 		: m_MeshName("Invalid")
-		, m_VertexData(std::vector<Vertex>())
-		, m_Indices(std::vector<unsigned int>())
+		, m_Resource(nullptr)
 		, m_Textures(std::vector<Texture>())
-		, m_MaxBB(glm::vec3(0.0f))
-		, m_MinBB(glm::vec3(0.0f))
-		, m_InitialMax(glm::vec3(0.0f))
-		, m_InitialMin(glm::vec3(0.0f))
 	{
 	}
 
-	Mesh::~Mesh()
-	{
-		DestroyArrays();
-	}
-
 	Mesh::Mesh(std::vector<Vertex> v, std::vector<unsigned int> i, std::vector<Texture> t, 
 				glm::vec3 maxBB, glm::vec3 minBB, std::string name)
 		: m_MeshName(name)
-		, m_VertexData(v)
-		, m_Indices(i)
+		, m_Resource(std::make_shared<MeshResource>(std::move(v), std::move(i), maxBB, minBB))
 		, m_Textures(t)
-		, m_MaxBB(maxBB)
-		, m_MinBB(minBB)
-		, m_InitialMax(maxBB)
-		, m_InitialMin(minBB)
 	{
-		BuildArrays();
 	}
 
-	Mesh::Mesh(const Mesh& other)
+	Mesh::Mesh(std::shared_ptr<MeshResource> resource, std::vector<Texture> t, std::string name)
+		: m_MeshName(name)
+		, m_Resource(resource)
+		, m_Textures(t)
 	{
-		m_MeshName = other.m_MeshName;
-		m_VertexData = other.m_VertexData;
-		m_Indices = other.m_Indices;
-		m_Textures = other.m_Textures;
-
-		m_InitialMax = m_MaxBB = other.m_MaxBB;
-		m_InitialMin = m_MinBB = other.m_MinBB;
-
-		BuildArrays();
 	}
 
-	void Mesh::operator=(const Mesh& other)
+	// Sampler uniform names ("diffTex1", "normTex2", ...) are built once here
+	// rather than concatenated per texture per draw
+	static const std::string& SamplerName(aiTextureType type, unsigned n)
 	{
-		m_MeshName = other.m_MeshName;
-		m_VertexData = other.m_VertexData;
-		m_Indices = other.m_Indices;
-		m_Textures = other.m_Textures;
+		static const std::string none;
+		static std::vector<std::string> names[AI_TEXTURE_TYPE_MAX + 1];
+
+		const char* prefix = nullptr;
+		switch (type)
+		{
+		case aiTextureType_DIFFUSE:
+			prefix = "diffTex";
+			break;
+		case aiTextureType_SPECULAR:
+			prefix = "specTex";
+			break;
+		case aiTextureType_NORMALS:
+			prefix = "normTex";
+			break;
+		case aiTextureType_HEIGHT:
+			prefix = "heightTex";
+			break;
+		case aiTextureType_METALNESS:
+			prefix = "metalTex";
+			break;
+		case aiTextureType_DIFFUSE_ROUGHNESS:
+			prefix = "roughTex";
+			break;
+		case aiTextureType_UNKNOWN:
+			prefix = "metalRoughTex";
+			break;
+		default:
+			return none;
+		}
 
-		m_InitialMax = m_MaxBB = other.m_MaxBB;
-		m_InitialMin = m_MinBB = other.m_MinBB;
+		std::vector<std::string>& list = names[type];
+		while (list.size() < n)
+		{
+			list.push_back(std::string(prefix) + std::to_string(list.size() + 1));
+		}
 
-		BuildArrays();
+		return list[n - 1];
 	}
 
-	void Mesh::Draw(Shader& s, int entID)
+	void Mesh::BindTextures(Shader& s, const std::vector<Texture*>& overrides)
 	{
-		unsigned diffNr = 1;
-		unsigned specNr = 1;
-		unsigned normNr = 1;
-		unsigned heightNr = 1;
-		unsigned metalNr = 1;
-		unsigned roughNr = 1;
-		unsigned metRoughNr = 1;
+		// per-type counters so the n-th texture of a type maps to "<type>Tex<n>"
+		unsigned typeCount[AI_TEXTURE_TYPE_MAX + 1] = {};
 
 		// bool to check if metal + rough are a part of the same texture
 		// (todo?: only would likely work with one texture; support for more?)
 		bool combined = false;
 
 		// textures loaded via ASSIMP
-		if (m_Textures.size() > 0)
+		for (unsigned i = 0; i < m_Textures.size(); ++i)
 		{
-			for (unsigned i = 0; i < m_Textures.size(); ++i)
-			{
-				std::string unit;
-				glActiveTexture(GL_TEXTURE0 + i);
-
-				switch (m_Textures[i].type)
-				{
-				case aiTextureType_DIFFUSE:
-					unit = std::string("diffTex") + std::to_string(diffNr++);
-					break;
-				case aiTextureType_SPECULAR:
-					unit = std::string("specTex") + std::to_string(specNr++);
-					break;
-				case aiTextureType_NORMALS:
-					unit = std::string("normTex") + std::to_string(normNr++);
-					break;
-				case aiTextureType_HEIGHT:
-					unit = std::string("heightTex") + std::to_string(heightNr++);
-					break;
-				case aiTextureType_METALNESS:
-					unit = std::string("metalTex") + std::to_string(metalNr++);
-					break;
-				case aiTextureType_DIFFUSE_ROUGHNESS:
-					unit = std::string("roughTex") + std::to_string(roughNr++);
-					break;
-				case aiTextureType_UNKNOWN:
-					unit = std::string("metalRoughTex") + std::to_string(metRoughNr++);
-					combined = true;
-					break;
-				}
-
-				s.SetIntDirect(unit, i);
-				m_Textures[i].Bind();
-			}
-		}
+			RenderState::ActiveTexture(i);
 
-		s.SetIntDirect("metRoughCombine", static_cast<int>(combined));
+			aiTextureType type = m_Textures[i].type;
+			combined |= (type == aiTextureType_UNKNOWN);
 
-		m_VertexArray.Bind();
+			s.SetInt(s.GetHandle(SamplerName(type, ++typeCount[type])), i);
+			m_Textures[i].Bind();
+		}
 
-		std::vector<float> id(m_VertexData.size(), static_cast<float>(entID));
+		// per-instance overrides replace the first texture of their type
+		for (unsigned i = 0; i < overrides.size(); ++i)
+		{
+			GLuint slot = static_cast<GLuint>(m_Textures.size() + i);
+			RenderState::ActiveTexture(slot);
 
-		m_VertexArray["EntityID"].Bind();
-		m_VertexArray["EntityID"].UpdateData<GLfloat>(0, static_cast<GLuint>(m_VertexData.size()), id.data());
-		m_VertexArray["EntityID"].Unbind();
+			aiTextureType type = overrides[i]->type;
+			combined |= (type == aiTextureType_UNKNOWN);
 
-		m_VertexArray.Draw(GL_TRIANGLES, static_cast<unsigned>(m_Indices.size()), GL_UNSIGNED_INT);
-		m_VertexArray.Clear();
+			s.SetInt(s.GetHandle(SamplerName(type, 1)), static_cast<int>(slot));
+			overrides[i]->Bind();
+		}
 
-		glActiveTexture(0);
+		s.SetInt(s.GetHandle("metRoughCombine"), static_cast<int>(combined));
 	}
 
-	void Mesh::Update(glm::mat4 modelMat)
+	void Mesh::Draw(Shader& s, int entID, const std::vector<Texture*>& overrides)
 	{
-		m_MaxBB = modelMat * glm::vec4(m_InitialMax, 1.0f);
-		m_MinBB = modelMat * glm::vec4(m_InitialMin, 1.0f);
+		if (!m_Resource)
+			return;
+
+		BindTextures(s, overrides);
+
+		// picking ID is a single uniform; instanced draws read it from the instance buffer
+		s.SetInt(s.GetHandle("entityID"), entID);
+
+		VertexArray& vao = m_Resource->GetVAO();
+		vao.Bind();
+		vao.Draw(GL_TRIANGLES, static_cast<unsigned>(m_Resource->GetIndexCount()), GL_UNSIGNED_INT);
+		vao.Clear();
+
+		RenderState::ActiveTexture(0);
 	}
 
-	void Mesh::DrawBoundingBox()
+	void Mesh::DrawInstanced(Shader& s, const std::vector<InstanceData>& instances, 
+		const std::vector<Texture*>& overrides, bool bindTextures)
 	{
-		dd::aabb(glm::value_ptr(m_MinBB), glm::value_ptr(m_MaxBB), glm::value_ptr(glm::vec4(1.0f)));
+		if (!m_Resource || instances.empty())
+			return;
+
+		if (bindTextures)
+			BindTextures(s, overrides);
+
+		m_Resource->UploadInstances(instances);
+
+		VertexArray& vao = m_Resource->GetVAO();
+		vao.Bind();
+		vao.Draw(GL_TRIANGLES, static_cast<unsigned>(m_Resource->GetIndexCount()), GL_UNSIGNED_INT, 
+			0, static_cast<GLuint>(instances.size()));
+
+		// left bound: the next group is often the same mesh, and the state cache skips the rebind
+
+		RenderState::ActiveTexture(0);
 	}
 
-	void Mesh::BuildArrays()
+	BoundingBox Mesh::GetWorldBounds(const glm::mat4& modelMat) const
 	{
-		m_VertexArray.Generate();
-		m_VertexArray.Bind();
-
-		m_VertexArray["Index"] = VertexBuffer(GL_ELEMENT_ARRAY_BUFFER);
-		m_VertexArray["Index"].Generate();
-		m_VertexArray["Index"].Bind();
-		m_VertexArray["Index"].SetData<GLuint>(m_Indices.size(), m_Indices.data(), GL_STATIC_DRAW);
-
-		m_VertexArray["Vertex"] = VertexBuffer(GL_ARRAY_BUFFER);
-		m_VertexArray["Vertex"].Generate();
-		m_VertexArray["Vertex"].Bind();
-		m_VertexArray["Vertex"].SetData<Vertex>(m_VertexData.size(), m_VertexData.data(), GL_STATIC_DRAW);
-		m_VertexArray["Vertex"].SetAttPointer<GLfloat>(0, 3, GL_FLOAT, sizeof(Vertex), 0, 0, true, true);
-		m_VertexArray["Vertex"].SetAttPointer<GLfloat>(1, 3, GL_FLOAT, sizeof(Vertex), offsetof(Vertex, Vertex::s_Normal), 0, true, true);
-		m_VertexArray["Vertex"].SetAttPointer<GLfloat>(2, 3, GL_FLOAT, sizeof(Vertex), offsetof(Vertex, Vertex::s_UV), 0, true, true);
-		m_VertexArray["Vertex"].SetAttPointer<GLfloat>(3, 3, GL_FLOAT, sizeof(Vertex), offsetof(Vertex, Vertex::s_Tangent), 0, true, true);
-		m_VertexArray["Vertex"].SetAttPointer<GLfloat>(4, 3, GL_FLOAT, sizeof(Vertex), offsetof(Vertex, Vertex::s_Bitangent), 0, true, true);
-		m_VertexArray["Vertex"].SetAttPointer<GLint>(5, 4, GL_INT, sizeof(Vertex), offsetof(Vertex, Vertex::m_BoneIDs), 0, true, true);
-		m_VertexArray["Vertex"].SetAttPointer<GLfloat>(6, 4, GL_FLOAT, sizeof(Vertex), offsetof(Vertex, Vertex::m_BoneWeights), 0, true, true);
-
-		m_VertexArray["Vertex"].Unbind();
-
-		m_VertexArray["EntityID"] = VertexBuffer(GL_ARRAY_BUFFER);
-		m_VertexArray["EntityID"].Generate();
-		m_VertexArray["EntityID"].Bind();
-		m_VertexArray["EntityID"].SetData<GLfloat>(m_VertexData.size(), nullptr, GL_DYNAMIC_DRAW);
-		m_VertexArray["EntityID"].SetAttPointer<GLfloat>(3, 1, GL_FLOAT, 1, 0);
-		m_VertexArray["EntityID"].Unbind();
-
-		m_VertexArray.Clear();
+		BoundingBox res;
+
+		if (!m_Resource)
+			return res;
+
+		const BoundingBox& local = m_Resource->GetBounds();
+
+		// Transform the center and fold the extents through |M| so the box
+		// stays correct (and tight) under rotation and negative scale
+		glm::vec3 center = (local.s_Max + local.s_Min) * 0.5f;
+		glm::vec3 extents = (local.s_Max - local.s_Min) * 0.5f;
+
+		glm::vec3 worldCenter = glm::vec3(modelMat * glm::vec4(center, 1.0f));
+		glm::mat3 absMat = glm::mat3(glm::abs(glm::vec3(modelMat[0])), glm::abs(glm::vec3(modelMat[1])), glm::abs(glm::vec3(modelMat[2])));
+		glm::vec3 worldExtents = absMat * extents;
+
+		res.s_Min = worldCenter - worldExtents;
+		res.s_Max = worldCenter + worldExtents;
+
+		return res;
 	}
 
-	void Mesh::DestroyArrays()
+	void Mesh::DrawBoundingBox(const BoundingBox& bounds)
 	{
-		m_VertexArray.Cleanup();
+		dd::aabb(glm::value_ptr(bounds.s_Min), glm::value_ptr(bounds.s_Max), glm::value_ptr(glm::vec4(1.0f)));
 	}
-}
\ No newline at end of file
+}
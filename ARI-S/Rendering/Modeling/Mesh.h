@@ -2,83 +2,66 @@
 #define MESH_H
 
 #include "VertexMemory.hpp"
+#include "MeshResource.h"
 #include "Shader.h"
 #include "Texture.h"
 
 #include <glm.hpp>
 #include <vector>
 #include <string>
-
-#define BONE_INFLUENCE 4
+#include <memory>
 
 namespace ARIS
 {
 	class Texture;
 
-	struct Vertex
-	{
-		glm::vec3 s_Position;
-		glm::vec3 s_Normal;
-		glm::vec3 s_UV;
-		glm::vec3 s_Tangent;
-		glm::vec3 s_Bitangent;
-
-		int m_BoneIDs[BONE_INFLUENCE];
-		float m_BoneWeights[BONE_INFLUENCE];
-	};
-
+	// Lightweight handle to a shared MeshResource plus the textures the model
+	// assigned to it. Copying a Mesh never touches the GPU.
 	class Mesh
 	{
 	public:
 		Mesh();
-		~Mesh();
 
 		Mesh(std::vector<Vertex> v, std::vector<unsigned int> i, 
 			std::vector<Texture> t, glm::vec3 maxBB, glm::vec3 minBB, std::string name = "Unnamed");
 
-		Mesh(const Mesh& other);
-		void operator=(const Mesh& other);
+		Mesh(std::shared_ptr<MeshResource> resource, std::vector<Texture> t, std::string name = "Unnamed");
 
-		void Update(glm::mat4 modelMat);
-		void Draw(Shader& s, int entID = -1);
-		void DrawBoundingBox();
+		BoundingBox GetWorldBounds(const glm::mat4& modelMat) const;
 
-		void BuildArrays();
-		void DestroyArrays();
+		// overrides - per-instance textures bound after the model's own so they take precedence
+		void Draw(Shader& s, int entID = -1, const std::vector<Texture*>& overrides = std::vector<Texture*>());
+		// Draw every instance in one call; the shader reads the instance attributes
+		void DrawInstanced(Shader& s, const std::vector<InstanceData>& instances, 
+			const std::vector<Texture*>& overrides = std::vector<Texture*>(), bool bindTextures = true);
 
-		VertexArray GetVAO() const& { return m_VertexArray; }
+		static void DrawBoundingBox(const BoundingBox& bounds);
 
-		size_t GetIndexCount() { return m_Indices.size(); }
-		std::vector<unsigned int> GetIndices() const { return m_Indices; }
+		const std::shared_ptr<MeshResource>& GetResource() const { return m_Resource; }
 
-		size_t GetVertexCount() { return m_VertexData.size(); }
-		std::vector<Vertex> GetVertexData() const { return m_VertexData; }
+		size_t GetIndexCount() const { return m_Resource ? m_Resource->GetIndexCount() : 0; }
+		size_t GetVertexCount() const { return m_Resource ? m_Resource->GetVertexCount() : 0; }
 
-		std::vector<Texture> GetTextures() { return m_Textures; }
+		const std::vector<Texture>& GetTextures() const { return m_Textures; }
 
-		glm::vec3 GetBoundingBoxCenter() { return (m_MaxBB - m_MinBB) / 2.0f; }
-		glm::vec3 GetBoundingBoxMax() { return m_MaxBB; }
-		glm::vec3 GetBoundingBoxMin() { return m_MinBB; }
+		glm::vec3 GetBoundingBoxMax() const { return m_Resource ? m_Resource->GetBounds().s_Max : glm::vec3(0.0f); }
+		glm::vec3 GetBoundingBoxMin() const { return m_Resource ? m_Resource->GetBounds().s_Min : glm::vec3(0.0f); }
+		glm::vec3 GetBoundingBoxCenter() const { return (GetBoundingBoxMax() + GetBoundingBoxMin()) / 2.0f; }
 
 	private:
+		void BindTextures(Shader& s, const std::vector<Texture*>& overrides);
+
 		std::string m_MeshName;
 
-		std::vector<Vertex> m_VertexData;
-		std::vector<unsigned int> m_Indices;
+		std::shared_ptr<MeshResource> m_Resource;
 		std::vector<Texture> m_Textures;
 
-		glm::vec3 m_MinBB;
-		glm::vec3 m_MaxBB;
-
-		glm::vec3 m_InitialMax, m_InitialMin;
-
-		VertexArray m_VertexArray;
-
 		friend class SceneSerializer;
 		friend class Model;
 		friend class ModelBuilder;
 		friend class HierarchyPanel;
+		friend class InstanceBatcher;
 	};
 }
 
-#endif
\ No newline at end of file
+#endif
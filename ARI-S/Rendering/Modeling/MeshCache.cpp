@@ -0,0 +1,206 @@
+#include <arpch.h>
+#include "MeshCache.h"
+#include "MappedFile.h"
+
+#include <cstring>
+
+namespace ARIS
+{
+	namespace
+	{
+		constexpr uint32_t CacheMagic = 0x4D535241; // "ARSM" in file byte order
+
+		struct CacheHeader
+		{
+			uint32_t s_Magic;
+			uint32_t s_Version;
+			uint64_t s_SourceHash;
+			uint32_t s_VertexSize;
+			uint32_t s_MeshCount;
+		};
+
+		struct MeshHeader
+		{
+			uint32_t s_VertexCount;
+			uint32_t s_IndexCount;
+			uint32_t s_TextureCount;
+			uint32_t s_NameLength;
+			glm::vec3 s_Min;
+			glm::vec3 s_Max;
+		};
+
+		struct TextureHeader
+		{
+			uint32_t s_Type;
+			uint32_t s_PathLength;
+		};
+
+		// strings are padded so the arrays that follow stay 4-byte aligned in the mapping
+		size_t Padded(size_t length)
+		{
+			return (length + 3) & ~size_t(3);
+		}
+
+		void WriteString(std::ofstream& out, const std::string& s)
+		{
+			static const char zeros[4] = {};
+
+			out.write(s.data(), s.size());
+			out.write(zeros, Padded(s.size()) - s.size());
+		}
+
+		// Bounds-checked cursor over the mapped cache
+		class Reader
+		{
+		public:
+			Reader(const uint8_t* data, size_t size)
+				: m_Data(data), m_Size(size)
+			{
+			}
+
+			template <typename T>
+			const T* Take(size_t count = 1)
+			{
+				size_t bytes = sizeof(T) * count;
+				if (bytes > m_Size - m_Offset)
+				{
+					return nullptr;
+				}
+
+				const T* p = reinterpret_cast<const T*>(m_Data + m_Offset);
+				m_Offset += bytes;
+				return p;
+			}
+
+			bool TakeString(size_t length, std::string& s)
+			{
+				const char* p = Take<char>(Padded(length));
+				if (!p)
+				{
+					return false;
+				}
+
+				s.assign(p, length);
+				return true;
+			}
+
+		private:
+			const uint8_t* m_Data;
+			size_t m_Size;
+			size_t m_Offset = 0;
+		};
+	}
+
+	std::string MeshCache::GetCachePath(const std::string& sourcePath)
+	{
+		return sourcePath + ".arismesh";
+	}
+
+	uint64_t MeshCache::HashSource(const std::string& sourcePath)
+	{
+		return MappedFile::HashContents(sourcePath);
+	}
+
+	bool MeshCache::Load(const std::string& sourcePath, ModelData& data)
+	{
+		auto file = std::make_shared<MappedFile>(GetCachePath(sourcePath));
+		if (!file->IsOpen())
+		{
+			return false;
+		}
+
+		Reader reader(file->GetData(), file->GetSize());
+
+		const CacheHeader* header = reader.Take<CacheHeader>();
+		if (!header || header->s_Magic != CacheMagic || header->s_Version != Version ||
+			header->s_VertexSize != sizeof(Vertex) || header->s_SourceHash != HashSource(sourcePath))
+		{
+			return false;
+		}
+
+		// Validate the whole file before handing anything out
+		std::vector<MeshData> meshes(header->s_MeshCount);
+		for (MeshData& mesh : meshes)
+		{
+			const MeshHeader* mh = reader.Take<MeshHeader>();
+			if (!mh || !reader.TakeString(mh->s_NameLength, mesh.s_Name))
+			{
+				return false;
+			}
+
+			for (uint32_t t = 0; t < mh->s_TextureCount; ++t)
+			{
+				const TextureHeader* tex = reader.Take<TextureHeader>();
+				std::string path;
+				if (!tex || !reader.TakeString(tex->s_PathLength, path))
+				{
+					return false;
+				}
+
+				mesh.s_Textures.push_back({ static_cast<aiTextureType>(tex->s_Type), path });
+			}
+
+			mesh.s_Bounds.s_Min = mh->s_Min;
+			mesh.s_Bounds.s_Max = mh->s_Max;
+
+			mesh.s_VertexCount = mh->s_VertexCount;
+			mesh.s_IndexCount = mh->s_IndexCount;
+			mesh.s_Vertices = reader.Take<Vertex>(mesh.s_VertexCount);
+			mesh.s_Indices = reader.Take<unsigned>(mesh.s_IndexCount);
+			if (!mesh.s_Vertices || !mesh.s_Indices)
+			{
+				return false;
+			}
+		}
+
+		data.s_Meshes = std::move(meshes);
+		data.s_Mapping = file;
+
+		return true;
+	}
+
+	bool MeshCache::Save(const std::string& sourcePath, const ModelData& data)
+	{
+		uint64_t hash = HashSource(sourcePath);
+		if (hash == 0 || data.s_Meshes.empty())
+		{
+			return false;
+		}
+
+		std::ofstream out(GetCachePath(sourcePath), std::ios::binary | std::ios::trunc);
+		if (!out)
+		{
+			std::cout << "MESH CACHE ERROR: Could not write " << GetCachePath(sourcePath) << std::endl;
+			return false;
+		}
+
+		CacheHeader header = { CacheMagic, Version, hash, sizeof(Vertex), static_cast<uint32_t>(data.s_Meshes.size()) };
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+		for (const MeshData& mesh : data.s_Meshes)
+		{
+			MeshHeader mh = {};
+			mh.s_VertexCount = static_cast<uint32_t>(mesh.s_VertexCount);
+			mh.s_IndexCount = static_cast<uint32_t>(mesh.s_IndexCount);
+			mh.s_TextureCount = static_cast<uint32_t>(mesh.s_Textures.size());
+			mh.s_NameLength = static_cast<uint32_t>(mesh.s_Name.size());
+			mh.s_Min = mesh.s_Bounds.s_Min;
+			mh.s_Max = mesh.s_Bounds.s_Max;
+
+			out.write(reinterpret_cast<const char*>(&mh), sizeof(mh));
+			WriteString(out, mesh.s_Name);
+
+			for (const auto& [type, path] : mesh.s_Textures)
+			{
+				TextureHeader th = { static_cast<uint32_t>(type), static_cast<uint32_t>(path.size()) };
+				out.write(reinterpret_cast<const char*>(&th), sizeof(th));
+				WriteString(out, path);
+			}
+
+			out.write(reinterpret_cast<const char*>(mesh.s_Vertices), sizeof(Vertex) * mh.s_VertexCount);
+			out.write(reinterpret_cast<const char*>(mesh.s_Indices), sizeof(unsigned) * mh.s_IndexCount);
+		}
+
+		return static_cast<bool>(out);
+	}
+}
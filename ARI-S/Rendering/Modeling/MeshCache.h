@@ -0,0 +1,34 @@
+#ifndef MESHCACHE_H
+#define MESHCACHE_H
+
+#include "ModelBuilder.h"
+
+#include <string>
+#include <cstdint>
+
+namespace ARIS
+{
+	// Binary cache of a fully processed model (post-Assimp vertex/index arrays,
+	// bounds and material texture references), stored next to the source asset
+	// as "<asset>.arismesh". A cache is only used if its format version and the
+	// hash of the source file's contents both match; otherwise it's rebuilt.
+	class MeshCache
+	{
+	public:
+		// Bump whenever Vertex, the file layout or the import flags change
+		static constexpr uint32_t Version = 1;
+
+		static std::string GetCachePath(const std::string& sourcePath);
+
+		// see MappedFile::HashContents
+		static uint64_t HashSource(const std::string& sourcePath);
+
+		// Fill data from a valid cache; the meshes point straight into the mapped file,
+		// which data keeps alive until it's built. Returns false if missing or stale.
+		// Neither call touches GL, so both are safe on worker threads.
+		static bool Load(const std::string& sourcePath, ModelData& data);
+		static bool Save(const std::string& sourcePath, const ModelData& data);
+	};
+}
+
+#endif
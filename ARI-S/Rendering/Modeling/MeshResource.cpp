@@ -0,0 +1,95 @@
+#include <arpch.h>
+#include "MeshResource.h"
+
+namespace ARIS
+{
+	MeshResource::MeshResource(std::vector<Vertex> v, std::vector<unsigned int> i, glm::vec3 maxBB, glm::vec3 minBB)
+		: m_VertexData(std::move(v))
+		, m_Indices(std::move(i))
+	{
+		m_Bounds.s_Min = minBB;
+		m_Bounds.s_Max = maxBB;
+
+		BuildArrays(m_VertexData.data(), m_VertexData.size(), m_Indices.data(), m_Indices.size());
+	}
+
+	MeshResource::MeshResource(const Vertex* v, size_t vertexCount, const unsigned int* i, size_t indexCount, 
+		glm::vec3 maxBB, glm::vec3 minBB)
+		: m_VertexData(v, v + vertexCount)
+		, m_Indices(i, i + indexCount)
+	{
+		m_Bounds.s_Min = minBB;
+		m_Bounds.s_Max = maxBB;
+
+		BuildArrays(v, vertexCount, i, indexCount);
+	}
+
+	MeshResource::~MeshResource()
+	{
+		DestroyArrays();
+	}
+
+	void MeshResource::BuildArrays(const Vertex* vertices, size_t vertexCount, const unsigned int* indices, size_t indexCount)
+	{
+		m_VertexArray.Generate();
+		m_VertexArray.Bind();
+
+		m_VertexArray["Index"] = VertexBuffer(GL_ELEMENT_ARRAY_BUFFER);
+		m_VertexArray["Index"].Generate();
+		m_VertexArray["Index"].Bind();
+		m_VertexArray["Index"].SetData<GLuint>(static_cast<GLuint>(indexCount), indices, GL_STATIC_DRAW);
+
+		m_VertexArray["Vertex"] = VertexBuffer(GL_ARRAY_BUFFER);
+		m_VertexArray["Vertex"].Generate();
+		m_VertexArray["Vertex"].Bind();
+		m_VertexArray["Vertex"].SetData<Vertex>(static_cast<GLuint>(vertexCount), vertices, GL_STATIC_DRAW);
+		m_VertexArray["Vertex"].SetAttPointer<GLfloat>(0, 3, GL_FLOAT, sizeof(Vertex), 0, 0, true, true);
+		m_VertexArray["Vertex"].SetAttPointer<GLfloat>(1, 3, GL_FLOAT, sizeof(Vertex), offsetof(Vertex, Vertex::s_Normal), 0, true, true);
+		m_VertexArray["Vertex"].SetAttPointer<GLfloat>(2, 3, GL_FLOAT, sizeof(Vertex), offsetof(Vertex, Vertex::s_UV), 0, true, true);
+		m_VertexArray["Vertex"].SetAttPointer<GLfloat>(3, 3, GL_FLOAT, sizeof(Vertex), offsetof(Vertex, Vertex::s_Tangent), 0, true, true);
+		m_VertexArray["Vertex"].SetAttPointer<GLfloat>(4, 3, GL_FLOAT, sizeof(Vertex), offsetof(Vertex, Vertex::s_Bitangent), 0, true, true);
+		m_VertexArray["Vertex"].SetAttPointer<GLint>(5, 4, GL_INT, sizeof(Vertex), offsetof(Vertex, Vertex::m_BoneIDs), 0, true, true);
+		m_VertexArray["Vertex"].SetAttPointer<GLfloat>(6, 4, GL_FLOAT, sizeof(Vertex), offsetof(Vertex, Vertex::m_BoneWeights), 0, true, true);
+
+		m_VertexArray["Vertex"].Unbind();
+
+		// model matrix (4 x vec4) + entity ID, advanced once per instance
+		m_VertexArray["Instance"] = VertexBuffer(GL_ARRAY_BUFFER);
+		m_VertexArray["Instance"].Generate();
+		m_VertexArray["Instance"].Bind();
+		m_VertexArray["Instance"].SetData<InstanceData>(0, nullptr, GL_STREAM_DRAW);
+		for (GLuint col = 0; col < 4; ++col)
+		{
+			m_VertexArray["Instance"].SetAttPointer<GLfloat>(7 + col, 4, GL_FLOAT, sizeof(InstanceData), 
+				offsetof(InstanceData, InstanceData::s_Model) + col * sizeof(glm::vec4), 1, true, true);
+		}
+		m_VertexArray["Instance"].SetAttPointer<GLuint>(11, 1, GL_UNSIGNED_INT, sizeof(InstanceData), 
+			offsetof(InstanceData, InstanceData::s_EntityID), 1, true, true);
+		m_VertexArray["Instance"].Unbind();
+
+		m_VertexArray.Clear();
+	}
+
+	void MeshResource::UploadInstances(const std::vector<InstanceData>& instances)
+	{
+		GLuint count = static_cast<GLuint>(instances.size());
+
+		m_VertexArray["Instance"].Bind();
+
+		if (count > m_InstanceCapacity)
+		{
+			m_InstanceCapacity = count + count / 2;
+		}
+
+		// re-specifying the storage orphans the previous frame's data
+		// so the driver doesn't stall on draws still reading it
+		m_VertexArray["Instance"].SetData<InstanceData>(m_InstanceCapacity, nullptr, GL_STREAM_DRAW);
+		m_VertexArray["Instance"].UpdateData<InstanceData>(0, count, instances.data());
+		m_VertexArray["Instance"].Unbind();
+	}
+
+	void MeshResource::DestroyArrays()
+	{
+		m_VertexArray.Cleanup();
+	}
+}
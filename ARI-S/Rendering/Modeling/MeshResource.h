@@ -0,0 +1,94 @@
+#ifndef MESHRESOURCE_H
+#define MESHRESOURCE_H
+
+#include "VertexMemory.hpp"
+
+#include <glm.hpp>
+#include <vector>
+#include <memory>
+
+#define BONE_INFLUENCE 4
+
+namespace ARIS
+{
+	struct Vertex
+	{
+		glm::vec3 s_Position;
+		glm::vec3 s_Normal;
+		glm::vec3 s_UV;
+		glm::vec3 s_Tangent;
+		glm::vec3 s_Bitangent;
+
+		int m_BoneIDs[BONE_INFLUENCE];
+		float m_BoneWeights[BONE_INFLUENCE];
+	};
+
+	// Per-instance data streamed into the instance buffer (attributes 7-11)
+	struct InstanceData
+	{
+		glm::mat4 s_Model;
+		uint32_t s_EntityID; // integer attribute; a float can't hold versioned entity ids
+	};
+
+	struct BoundingBox
+	{
+		glm::vec3 s_Min = glm::vec3(0.0f);
+		glm::vec3 s_Max = glm::vec3(0.0f);
+
+		glm::vec3 Center() const { return (s_Min + s_Max) * 0.5f; }
+
+		float SurfaceArea() const
+		{
+			glm::vec3 d = s_Max - s_Min;
+			return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+		}
+
+		static BoundingBox Merge(const BoundingBox& a, const BoundingBox& b)
+		{
+			return BoundingBox{ glm::min(a.s_Min, b.s_Min), glm::max(a.s_Max, b.s_Max) };
+		}
+	};
+
+	// GPU-side geometry (VAO/VBO/IBO) plus the local bounds of a mesh.
+	// Uploaded once and shared between every Model that references it.
+	class MeshResource
+	{
+	public:
+		MeshResource(std::vector<Vertex> v, std::vector<unsigned int> i, glm::vec3 maxBB, glm::vec3 minBB);
+
+		// Upload straight from external memory (e.g. a mapped mesh cache), then keep a CPU copy for picking
+		MeshResource(const Vertex* v, size_t vertexCount, const unsigned int* i, size_t indexCount, 
+			glm::vec3 maxBB, glm::vec3 minBB);
+		~MeshResource();
+
+		MeshResource(const MeshResource& other) = delete;
+		MeshResource& operator=(const MeshResource& other) = delete;
+
+		VertexArray& GetVAO() { return m_VertexArray; }
+
+		size_t GetIndexCount() const { return m_Indices.size(); }
+		const std::vector<unsigned int>& GetIndices() const { return m_Indices; }
+
+		size_t GetVertexCount() const { return m_VertexData.size(); }
+		const std::vector<Vertex>& GetVertexData() const { return m_VertexData; }
+
+		const BoundingBox& GetBounds() const { return m_Bounds; }
+
+		// Upload per-instance data, growing the instance buffer if needed
+		void UploadInstances(const std::vector<InstanceData>& instances);
+
+	private:
+		void BuildArrays(const Vertex* vertices, size_t vertexCount, const unsigned int* indices, size_t indexCount);
+		void DestroyArrays();
+
+		std::vector<Vertex> m_VertexData;
+		std::vector<unsigned int> m_Indices;
+
+		BoundingBox m_Bounds;
+
+		VertexArray m_VertexArray;
+		GLuint m_InstanceCapacity = 0;
+	};
+}
+
+#endif
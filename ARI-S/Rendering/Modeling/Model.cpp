@@ -6,16 +6,15 @@
 
 namespace ARIS
 {
+    // Meshes only hold handles to their shared GPU resources,
+    // so copying a model does not re-upload any geometry
     Model::Model(const Model& other)
       : m_Name(other.m_Name)
       , m_Path(other.m_Path)
       , m_Meshes(other.m_Meshes)
       , m_LoadedTextures(other.m_LoadedTextures)
+      , m_TextureHandles(other.m_TextureHandles)
     {
-        for (Mesh& m : m_Meshes)
-        {
-            m.m_Textures.clear();
-        }
     }
 
     void Model::operator=(const Model& other)
@@ -24,48 +23,22 @@ namespace ARIS
         m_Path = other.m_Path;
         m_Meshes = other.m_Meshes;
         m_LoadedTextures = other.m_LoadedTextures;
+        m_TextureHandles = other.m_TextureHandles;
     }
 
 	Model::Model(std::string path)
         : m_Name(std::string())
         , m_Path(path)
 	{
-        ModelBuilder::Get().LoadModel(path);
+        std::unique_ptr<Model> loaded(ModelBuilder::Get().LoadModel(path));
+        *this = *loaded;
 	}
 
-    void Model::InitializeID(int id)
-    {
-        for (Mesh m : m_Meshes)
-        {
-            std::vector<int> data(m.GetVertexData().size(), id);
-            m.GetVAO().Bind();
-
-           m.GetVAO()["EntityID"] = VertexBuffer(GL_ARRAY_BUFFER);
-           m.GetVAO()["EntityID"].Generate();
-           m.GetVAO()["EntityID"].Bind();
-           m.GetVAO()["EntityID"].SetData<GLint>(m.GetVertexData().size(), data.data(), GL_STATIC_DRAW);
-           m.GetVAO()["EntityID"].SetAttPointer<GLint>(3, 1, GL_INT, 1, 0);
-           m.GetVAO()["EntityID"].Unbind();
-           m.GetVAO().Clear();
-        }
-    }
-
-    void Model::Update(glm::mat4 modelMat)
+    void Model::Draw(Shader& shader, int entID, const std::vector<Texture*>& overrides)
     {
         for (unsigned i = 0; i < m_Meshes.size(); ++i)
         {
-            m_Meshes[i].Update(modelMat);
-        }
-    }
-
-    void Model::Draw(Shader& shader, int entID)
-    {
-        for (unsigned i = 0; i < m_Meshes.size(); ++i)
-        {
-            m_Meshes[i].Draw(shader, entID);
-
-            if (ModelBuilder::Get().m_DisplayBoxes)
-                m_Meshes[i].DrawBoundingBox();
+            m_Meshes[i].Draw(shader, entID, overrides);
         }
     }
 }
\ No newline at end of file
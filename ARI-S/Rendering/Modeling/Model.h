@@ -22,10 +22,7 @@ namespace ARIS
 
 		void operator=(const Model& other);
 
-		void InitializeID(int entityID);
-
-		void Update(glm::mat4 modelMat);
-		void Draw(Shader& shader, int entID = -1);
+		void Draw(Shader& shader, int entID = -1, const std::vector<Texture*>& overrides = std::vector<Texture*>());
 
 		std::string GetName() const { return m_Name; }
 		std::string GetPath() const { return m_Path; }
@@ -33,11 +30,13 @@ namespace ARIS
 		void SetName(std::string s) { m_Name = s; }
 		void SetPath(std::string s) { m_Path = s; }
 
-		std::vector<Mesh> GetMeshes() const { return m_Meshes; }
+		const std::vector<Mesh>& GetMeshes() const { return m_Meshes; }
 		std::vector<Texture> GetLoadedTextures() const { return m_LoadedTextures; }
 
 	private:
 		std::vector<Texture> m_LoadedTextures;
+		// TextureCache handles keeping m_LoadedTextures resident while any copy is alive
+		std::vector<std::shared_ptr<Texture>> m_TextureHandles;
 		std::vector<Mesh> m_Meshes;
 
 		std::string m_Name;
@@ -46,6 +45,7 @@ namespace ARIS
 		friend class ModelBuilder;
 		friend class SceneSerializer;
 		friend class HierarchyPanel;
+		friend class InstanceBatcher;
 	};
 }
 
@@ -1,6 +1,9 @@
 #include <arpch.h>
 #include "ModelBuilder.h"
 #include "Texture.h"
+#include "MeshCache.h"
+#include "TextureCache.h"
+#include "Timer.h"
 
 #define GLM_ENABLE_EXPERIMENTAL
 #include <gtx/hash.hpp>
@@ -25,25 +28,191 @@ namespace ARIS
         m_ModelTable.clear();
     }
 
+    unsigned ModelBuilder::ReleaseUnused()
+    {
+        // every copy shares the table model's mesh resources
+        auto unused = [](const std::unique_ptr<Model>& m)
+        {
+            for (const Mesh& mesh : m->GetMeshes())
+            {
+                if (mesh.GetResource().use_count() > 1)
+                    return false;
+            }
+
+            return true;
+        };
+
+        size_t count = m_ModelTable.size();
+        m_ModelTable.erase(std::remove_if(m_ModelTable.begin(), m_ModelTable.end(), unused), m_ModelTable.end());
+
+        return static_cast<unsigned>(count - m_ModelTable.size());
+    }
+
     Model* ModelBuilder::LoadModel(std::string path)
     {
-        for (Model* m : m_ModelTable)
+        if (Model* existing = FindModel(path))
+        {
+            return existing;
+        }
+
+        ModelData data;
+        ImportModel(path, data, m_UseMeshCache, false);
+
+        return new Model(*AddModel(data));
+    }
+
+    Model* ModelBuilder::FindModel(const std::string& path)
+    {
+        for (const std::unique_ptr<Model>& m : m_ModelTable)
         {
+            // the copy shares the cached mesh resources
             if (m->m_Path.compare(path) == 0)
             {
                 return new Model(*m);
             }
         }
-        Model* m = new Model();
-        m->m_Path = path;
 
-        GenerateModel(path, *m);
-        m_ModelTable.push_back(m);
+        return nullptr;
+    }
+
+    Model* ModelBuilder::CreatePlaceholder(const std::string& path)
+    {
+        if (!m_Placeholder)
+        {
+            m_Placeholder = CreateSphere(0.5f, 16);
+        }
+
+        // keeps the real path so the scene still serializes correctly mid-load
+        Model* m = new Model(*m_Placeholder);
+        m->m_Path = path;
 
         return m;
     }
 
-    void ModelBuilder::GenerateModel(std::string path, Model& model)
+    bool ModelBuilder::ImportModel(const std::string& path, ModelData& data, bool useCache, bool decodeTextures)
+    {
+        data.s_Path = path;
+
+        // repeat loads skip Assimp entirely; a missing or stale cache is rebuilt
+        bool loaded = useCache && MeshCache::Load(path, data);
+        if (!loaded)
+        {
+            loaded = GenerateModel(path, data);
+
+            if (loaded && useCache)
+            {
+                MeshCache::Save(path, data);
+            }
+        }
+
+        if (loaded && decodeTextures)
+        {
+            for (const MeshData& mesh : data.s_Meshes)
+            {
+                for (const auto& [type, texPath] : mesh.s_Textures)
+                {
+                    if (data.s_Images.find({ texPath, type }) == data.s_Images.end() && !TextureCache::Get().IsResident(texPath, type))
+                    {
+                        data.s_Images[{ texPath, type }] = Texture::ReadImage(texPath, type);
+                    }
+                }
+            }
+        }
+
+        return loaded;
+    }
+
+    void ModelBuilder::BuildModel(const ModelData& data, Model& model)
+    {
+        model.m_Path = data.s_Path;
+
+        for (const MeshData& mesh : data.s_Meshes)
+        {
+            std::vector<Texture> textures;
+            for (const auto& [type, texPath] : mesh.s_Textures)
+            {
+                auto it = std::find_if(model.m_LoadedTextures.begin(), model.m_LoadedTextures.end(),
+                    [&texPath](const Texture& t) { return t.m_Path == texPath; });
+
+                if (it != model.m_LoadedTextures.end())
+                {
+                    textures.push_back(*it);
+                    continue;
+                }
+
+                // shared with every other model (and override) using the same image
+                auto image = data.s_Images.find({ texPath, type });
+                std::shared_ptr<Texture> handle = TextureCache::Get().Acquire(texPath, type, GL_LINEAR, GL_REPEAT, false,
+                    image != data.s_Images.end() ? &image->second : nullptr);
+
+                textures.push_back(*handle);
+                model.m_LoadedTextures.push_back(*handle);
+                model.m_TextureHandles.push_back(handle);
+            }
+
+            auto resource = std::make_shared<MeshResource>(mesh.s_Vertices, mesh.s_VertexCount, 
+                mesh.s_Indices, mesh.s_IndexCount, mesh.s_Bounds.s_Max, mesh.s_Bounds.s_Min);
+
+            model.m_Meshes.push_back(Mesh(resource, textures, mesh.s_Name));
+        }
+    }
+
+    Model* ModelBuilder::AddModel(const ModelData& data)
+    {
+        m_ModelTable.push_back(std::make_unique<Model>());
+        BuildModel(data, *m_ModelTable.back());
+
+        return m_ModelTable.back().get();
+    }
+
+    std::vector<ModelBuilder::ImportTiming> ModelBuilder::BenchmarkImport(const std::vector<std::string>& paths)
+    {
+        std::vector<ImportTiming> results;
+
+        for (const std::string& path : paths)
+        {
+            if (!std::filesystem::exists(path))
+            {
+                std::cout << "Benchmark: skipping missing model " << path << std::endl;
+                continue;
+            }
+
+            ImportTiming timing = { path, 0.0f, 0.0f };
+
+            // evict between runs so both decode the textures (unless the scene holds them)
+            TextureCache::Get().EvictUnused();
+
+            Timer timer;
+            {
+                Model cold;
+                ModelData data;
+                GenerateModel(path, data);
+                BuildModel(data, cold);
+                timing.s_AssimpMs = timer.ElapsedMillis();
+
+                MeshCache::Save(path, data);
+            }
+
+            TextureCache::Get().EvictUnused();
+
+            timer.Reset();
+            {
+                Model warm;
+                ModelData data;
+                bool cached = MeshCache::Load(path, data);
+                BuildModel(data, warm);
+                timing.s_CacheMs = cached ? timer.ElapsedMillis() : -1.0f;
+            }
+
+            TextureCache::Get().EvictUnused();
+
+            results.push_back(timing);
+        }
+
+        return results;
+    }
+
+    bool ModelBuilder::GenerateModel(const std::string& path, ModelData& data)
     {
         Assimp::Importer importer;
         const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_GenSmoothNormals | 
@@ -52,34 +221,44 @@ namespace ARIS
         if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE | !scene->mRootNode)
         {
             std::cout << "ASSIMP ERROR: " << importer.GetErrorString() << std::endl;
-            return;
+            return false;
         }
 
-        ProcessNode(scene->mRootNode, scene, model);
+        ProcessNode(scene->mRootNode, scene, data);
+
+        // storage is final now, so the views can't dangle
+        for (MeshData& mesh : data.s_Meshes)
+        {
+            mesh.s_Vertices = mesh.s_VertexStorage.data();
+            mesh.s_VertexCount = mesh.s_VertexStorage.size();
+            mesh.s_Indices = mesh.s_IndexStorage.data();
+            mesh.s_IndexCount = mesh.s_IndexStorage.size();
+        }
+
+        return true;
     }
 
-    void ModelBuilder::ProcessNode(aiNode* node, const aiScene* scene, Model& model)
+    void ModelBuilder::ProcessNode(aiNode* node, const aiScene* scene, ModelData& data)
     {
         for (unsigned i = 0; i < node->mNumMeshes; ++i)
         {
             aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-            model.m_Meshes.push_back(ProcessMesh(mesh, scene, model));
+            data.s_Meshes.push_back(ProcessMesh(mesh, scene, data.s_Path));
         }
 
         for (unsigned i = 0; i < node->mNumChildren; ++i)
         {
-            ProcessNode(node->mChildren[i], scene, model);
+            ProcessNode(node->mChildren[i], scene, data);
         }
     }
 
-    Mesh ModelBuilder::ProcessMesh(aiMesh* mesh, const aiScene* scene, Model& model)
+    MeshData ModelBuilder::ProcessMesh(aiMesh* mesh, const aiScene* scene, const std::string& path)
     {
-        std::vector<Vertex> vertexData;
-        std::vector<unsigned> indices;
-        std::vector<Texture> textures;
+        MeshData result;
+        std::vector<Vertex>& vertexData = result.s_VertexStorage;
+        std::vector<unsigned>& indices = result.s_IndexStorage;
 
-        glm::vec3 maxBB;
-        glm::vec3 minBB;
+        vertexData.reserve(mesh->mNumVertices);
 
         for (unsigned i = 0; i < mesh->mNumVertices; ++i)
         {
@@ -116,88 +295,41 @@ namespace ARIS
             }
         }
 
-        maxBB = glm::vec3(mesh->mAABB.mMax.x, mesh->mAABB.mMax.y, mesh->mAABB.mMax.z);
-        minBB = glm::vec3(mesh->mAABB.mMin.x, mesh->mAABB.mMin.y, mesh->mAABB.mMin.z);
+        result.s_Bounds.s_Max = glm::vec3(mesh->mAABB.mMax.x, mesh->mAABB.mMax.y, mesh->mAABB.mMax.z);
+        result.s_Bounds.s_Min = glm::vec3(mesh->mAABB.mMin.x, mesh->mAABB.mMin.y, mesh->mAABB.mMin.z);
 
         aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
 
-        std::vector<Texture> diffuseMaps = LoadMaterialTextures(material, aiTextureType_DIFFUSE, model);
-        textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
-
-        std::vector<Texture> specularMaps = LoadMaterialTextures(material, aiTextureType_SPECULAR, model);
-        textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
-
-        std::vector<Texture> normalMaps = LoadMaterialTextures(material, aiTextureType_NORMALS, model);
-        textures.insert(textures.end(), normalMaps.begin(), normalMaps.end());
-
-        std::vector<Texture> metalMap = LoadMaterialTextures(material, aiTextureType_METALNESS, model);
-        textures.insert(textures.end(), metalMap.begin(), metalMap.end());
-
-        std::vector<Texture> roughnessMaps = LoadMaterialTextures(material, aiTextureType_DIFFUSE_ROUGHNESS, model);
-        textures.insert(textures.end(), roughnessMaps.begin(), roughnessMaps.end());
+        LoadMaterialTextures(material, aiTextureType_DIFFUSE, path, result);
+        LoadMaterialTextures(material, aiTextureType_SPECULAR, path, result);
+        LoadMaterialTextures(material, aiTextureType_NORMALS, path, result);
+        LoadMaterialTextures(material, aiTextureType_METALNESS, path, result);
+        LoadMaterialTextures(material, aiTextureType_DIFFUSE_ROUGHNESS, path, result);
+        LoadMaterialTextures(material, aiTextureType_HEIGHT, path, result);
+        LoadMaterialTextures(material, aiTextureType_UNKNOWN, path, result);
 
-        std::vector<Texture> heightMaps = LoadMaterialTextures(material, aiTextureType_HEIGHT, model);
-        textures.insert(textures.end(), heightMaps.begin(), heightMaps.end());
-
-        std::vector<Texture> metalRoughMaps = LoadMaterialTextures(material, aiTextureType_UNKNOWN, model);
-        textures.insert(textures.end(), metalRoughMaps.begin(), metalRoughMaps.end());
-
-        return Mesh(vertexData, indices, textures, maxBB, minBB);
+        return result;
     }
 
-    std::vector<Texture> ModelBuilder::LoadMaterialTextures(aiMaterial* mat, aiTextureType type, Model& model)
+    void ModelBuilder::LoadMaterialTextures(aiMaterial* mat, aiTextureType type, const std::string& path, MeshData& mesh)
     {
-        std::vector<Texture> t;
+        size_t remove = path.find_last_of("/\\");
+        std::string dir = path.substr(0, remove) + std::string("/\\");
 
+        // only references here; BuildModel shares textures with the same path
         for (unsigned i = 0; i < mat->GetTextureCount(type); ++i)
         {
             aiString str;
             mat->GetTexture(type, i, &str);
 
-            bool skip = false;
-            for (unsigned j = 0; j < model.m_LoadedTextures.size(); ++j)
-            {
-                size_t remove = model.m_LoadedTextures[j].m_Path.find_last_of("/\\");
-                std::string path = model.m_LoadedTextures[j].m_Path.substr(remove, model.GetPath().length());
-
-                std::string aiStringStr = std::string(str.C_Str());
-                std::string aiStringCmp = std::string();
-
-                remove = aiStringStr.find_last_of("/\\");
-                if (remove > model.m_LoadedTextures[j].m_Path.length() || remove < 0)
-                {
-                    aiStringCmp = aiStringStr;
-                }
-                else
-                {
-                    aiStringCmp = aiStringStr.substr(remove, aiStringStr.length());
-                }
-
-                if (std::strcmp(path.c_str(), aiStringCmp.c_str()) == 0)
-                {
-                    t.push_back(model.m_LoadedTextures[j]);
-                    skip = true;
-                    break;
-                }
-            }
-
-            if (!skip)
-            {
-                size_t remove = model.GetPath().find_last_of("/\\");
-                std::string dir = model.GetPath().substr(0, remove) + std::string("/\\");
-
-                Texture newTex(dir + std::string(str.C_Str()), GL_LINEAR, GL_REPEAT, false, type);
-                t.push_back(newTex);
-                model.m_LoadedTextures.push_back(newTex);
-            }
+            mesh.s_Textures.push_back({ type, dir + std::string(str.C_Str()) });
         }
-
-        return t;
     }
 
     Model* ModelBuilder::CreateSphere(float radius, unsigned divisions)
     {
-        Mesh m;
+        std::vector<Vertex> vertexData;
+        std::vector<unsigned> indices;
 
         float x, y, z, xy;
         float length = 1.0f / radius;
@@ -225,11 +357,11 @@ namespace ARIS
                 float ny = y * length;
                 float nz = z * length;
 
-                Vertex v;
+                Vertex v = Vertex();
                 v.s_Position = glm::vec3(x, y, z);
                 v.s_Normal = glm::vec3(nx, ny, nz);
 
-                m.m_VertexData.push_back(v);
+                vertexData.push_back(v);
             }
         }
 
@@ -243,22 +375,23 @@ namespace ARIS
             {
                 if (i != 0)
                 {
-                    m.m_Indices.push_back(k1);
-                    m.m_Indices.push_back(k2);
-                    m.m_Indices.push_back(k1 + 1);
+                    indices.push_back(k1);
+                    indices.push_back(k2);
+                    indices.push_back(k1 + 1);
                 }
 
                 if (i != (divisions - 1))
                 {
-                    m.m_Indices.push_back(k1 + 1);
-                    m.m_Indices.push_back(k2);
-                    m.m_Indices.push_back(k2 + 1);
+                    indices.push_back(k1 + 1);
+                    indices.push_back(k2);
+                    indices.push_back(k2 + 1);
                 }
             }
         }
 
         Model* mo = new Model();
-        mo->m_Meshes.push_back(m);
+        mo->m_Meshes.push_back(Mesh(vertexData, indices, std::vector<Texture>(), 
+            glm::vec3(radius), glm::vec3(-radius), "Sphere"));
 
         return mo;
     }
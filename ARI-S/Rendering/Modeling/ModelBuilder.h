@@ -2,6 +2,7 @@
 #define MODELBUILDER_H
 
 #include "Model.h"
+#include "MappedFile.h"
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
@@ -9,11 +10,46 @@
 
 namespace ARIS
 {
+	// CPU-side result of importing a model, built into GPU resources later
+	struct MeshData
+	{
+		std::string s_Name = "Unnamed";
+		BoundingBox s_Bounds;
+
+		// either into the storage below or into ModelData::s_Mapping (cache loads)
+		const Vertex* s_Vertices = nullptr;
+		const unsigned* s_Indices = nullptr;
+		size_t s_VertexCount = 0, s_IndexCount = 0;
+
+		std::vector<Vertex> s_VertexStorage;
+		std::vector<unsigned> s_IndexStorage;
+
+		std::vector<std::pair<aiTextureType, std::string>> s_Textures;
+	};
+
+	struct ModelData
+	{
+		std::string s_Path;
+		std::vector<MeshData> s_Meshes;
+
+		std::shared_ptr<MappedFile> s_Mapping;
+
+		// material textures decoded ahead of time, by path and type (the type picks the compressed format)
+		std::map<std::pair<std::string, aiTextureType>, ImageData> s_Images;
+	};
+
 	class ModelBuilder
 	{
 		typedef std::pair<glm::vec3, int> VertexPair;
 
 	public:
+		struct ImportTiming
+		{
+			std::string s_Path;
+			float s_AssimpMs;
+			float s_CacheMs;
+		};
+
 		struct Compare
 		{
 			float eps = 0.00001f;
@@ -32,25 +68,50 @@ namespace ARIS
 
 		void DestroyTable();
 
+		// Drop the built models no instance copies from anymore (their mesh
+		// resources are only held by the table), releasing their texture handles
+		unsigned ReleaseUnused();
+
+		// Caller owns the returned copy
 		Model* LoadModel(std::string path);
 
+		// Copy of an already loaded model, or nullptr
+		Model* FindModel(const std::string& path);
+
+		// Stand-in shown while a model loads in the background
+		Model* CreatePlaceholder(const std::string& path);
+
+		// Assimp import (or .arismesh load) without any GL calls; safe on any thread.
+		// decodeTextures also decodes the material textures into data.s_Images.
+		static bool ImportModel(const std::string& path, ModelData& data, bool useCache, bool decodeTextures);
+
+		// GL thread: create the GPU resources for imported data
+		static void BuildModel(const ModelData& data, Model& model);
+
+		// BuildModel into a new model and add it to the table (which keeps ownership)
+		Model* AddModel(const ModelData& data);
+
 		inline static ModelBuilder& Get() { return *m_Instance; }
 		
-		std::vector<Model*> GetModelTable() { return m_ModelTable; }
+		const std::vector<std::unique_ptr<Model>>& GetModelTable() const { return m_ModelTable; }
 
 		static Model* CreateSphere(float radius, unsigned divisions);
 
+		// Cold Assimp import vs. warm .arismesh load for each existing path (textures decoded in both)
+		std::vector<ImportTiming> BenchmarkImport(const std::vector<std::string>& paths);
+
 		bool m_DisplayBoxes = false;
+		bool m_UseMeshCache = true;
 
 	private:
-		void GenerateModel(std::string path, Model& model);
-		void ProcessNode(aiNode* node, const aiScene* scene, Model& model);
-		Mesh ProcessMesh(aiMesh* mesh, const aiScene* scene, Model& model);
-		std::vector<Texture> LoadMaterialTextures(aiMaterial* mat, aiTextureType type, Model& model);
+		static bool GenerateModel(const std::string& path, ModelData& data);
+		static void ProcessNode(aiNode* node, const aiScene* scene, ModelData& data);
+		static MeshData ProcessMesh(aiMesh* mesh, const aiScene* scene, const std::string& path);
+		static void LoadMaterialTextures(aiMaterial* mat, aiTextureType type, const std::string& path, MeshData& mesh);
 
-		
+		Model* m_Placeholder = nullptr;
 
-		std::vector<Model*> m_ModelTable;
+		std::vector<std::unique_ptr<Model>> m_ModelTable;
 		static ModelBuilder* m_Instance;
 
 
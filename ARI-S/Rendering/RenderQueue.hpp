@@ -0,0 +1,73 @@
+#ifndef RENDERQUEUE_HPP
+#define RENDERQUEUE_HPP
+
+#include <glm.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace ARIS
+{
+	enum class RenderPass : uint32_t
+	{
+		Geometry = 0,
+		Shadow
+	};
+
+	// Draw items ordered by a 64-bit key so consecutive draws share as much
+	// GL state as possible. From the most significant bits down:
+	// pass (4) | shader (8) | material (20) | depth (16) | mesh (16)
+	// Depth sits above the mesh so the groups sharing a material go front-to-back;
+	// the mesh only breaks ties between groups at the same quantized depth
+	class RenderQueue
+	{
+	public:
+		struct Item
+		{
+			uint64_t s_Key;
+			uint32_t s_Index;
+		};
+
+		static uint64_t MakeKey(RenderPass pass, uint32_t shader, uint32_t material, uint32_t mesh, float depth)
+		{
+			return (static_cast<uint64_t>(pass) & 0xF) << 60
+				| (static_cast<uint64_t>(shader) & 0xFF) << 52
+				| (static_cast<uint64_t>(material) & 0xFFFFF) << 32
+				| QuantizeDepth(depth) << 16
+				| (static_cast<uint64_t>(mesh) & 0xFFFF);
+		}
+
+		// Upper 16 bits of a non-negative float keep their order (exponent + 7 mantissa bits),
+		// so near-to-far sorts front-to-back without knowing the depth range
+		static uint64_t QuantizeDepth(float depth)
+		{
+			float d = glm::max(depth, 0.0f);
+
+			uint32_t bits;
+			std::memcpy(&bits, &d, sizeof(bits));
+
+			return bits >> 16;
+		}
+
+		void Clear() { m_Items.clear(); }
+		void Push(uint64_t key, uint32_t index) { m_Items.push_back({ key, index }); }
+
+		void Sort()
+		{
+			std::sort(m_Items.begin(), m_Items.end(), 
+				[](const Item& a, const Item& b) { return a.s_Key < b.s_Key; });
+		}
+
+		std::vector<Item>::const_iterator begin() const { return m_Items.begin(); }
+		std::vector<Item>::const_iterator end() const { return m_Items.end(); }
+
+		size_t Size() const { return m_Items.size(); }
+
+	private:
+		std::vector<Item> m_Items;
+	};
+}
+
+#endif
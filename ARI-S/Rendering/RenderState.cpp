@@ -0,0 +1,358 @@
+#include <arpch.h>
+#include "RenderState.h"
+
+namespace ARIS
+{
+	// Sentinel for "unknown": forces the next bind through
+	static constexpr GLuint s_Unknown = ~0u;
+
+	// texture targets tracked per unit; anything else is passed straight through
+	enum TextureSlot { Slot2D, SlotCube, SlotCount };
+
+	// buffer targets tracked; anything else is passed straight through
+	enum BufferSlot { SlotArray, SlotElement, SlotUniform, SlotStorage, SlotPack, SlotUnpack, BufferSlotCount };
+
+	// capabilities tracked; anything else is passed straight through
+	static constexpr GLenum s_Caps[] = { GL_CULL_FACE, GL_DEPTH_TEST, GL_BLEND, GL_SCISSOR_TEST, 
+		GL_STENCIL_TEST, GL_TEXTURE_CUBE_MAP_SEAMLESS, GL_PROGRAM_POINT_SIZE };
+	static constexpr int s_CapCount = sizeof(s_Caps) / sizeof(s_Caps[0]);
+
+	enum CapState : GLuint { CapOff = 0, CapOn = 1, CapUnknown = s_Unknown };
+
+	static GLuint s_Program = s_Unknown;
+	static GLuint s_VertexArray = s_Unknown;
+	static GLuint s_ActiveUnit = s_Unknown;
+	static GLuint s_Textures[RenderState::MaxTextureUnits][SlotCount];
+
+	static GLuint s_Buffers[BufferSlotCount];
+	static GLuint s_ReadFramebuffer = s_Unknown;
+	static GLuint s_DrawFramebuffer = s_Unknown;
+	static GLint s_Viewport[4] = { -1, -1, -1, -1 };
+
+	static GLuint s_CapStates[s_CapCount];
+	static GLenum s_CullFace = s_Unknown;
+	static GLenum s_BlendSrc = s_Unknown, s_BlendDst = s_Unknown;
+	static GLenum s_DepthFunc = s_Unknown;
+
+	RenderState::Counters RenderState::s_Current;
+	RenderState::Counters RenderState::s_LastFrame;
+
+	static int SlotOf(GLenum target)
+	{
+		switch (target)
+		{
+		case GL_TEXTURE_2D:
+			return Slot2D;
+		case GL_TEXTURE_CUBE_MAP:
+			return SlotCube;
+		default:
+			return -1;
+		}
+	}
+
+	static int BufferSlotOf(GLenum target)
+	{
+		switch (target)
+		{
+		case GL_ARRAY_BUFFER:
+			return SlotArray;
+		case GL_ELEMENT_ARRAY_BUFFER:
+			return SlotElement;
+		case GL_UNIFORM_BUFFER:
+			return SlotUniform;
+		case GL_SHADER_STORAGE_BUFFER:
+			return SlotStorage;
+		case GL_PIXEL_PACK_BUFFER:
+			return SlotPack;
+		case GL_PIXEL_UNPACK_BUFFER:
+			return SlotUnpack;
+		default:
+			return -1;
+		}
+	}
+
+	static int CapIndexOf(GLenum cap)
+	{
+		for (int i = 0; i < s_CapCount; ++i)
+		{
+			if (s_Caps[i] == cap)
+				return i;
+		}
+
+		return -1;
+	}
+
+	// Shared skip-or-issue for single-value state
+	template <typename Call>
+	static void SetCached(GLuint& cached, GLuint value, unsigned& counter, unsigned& skipped, Call call)
+	{
+		if (cached == value)
+		{
+			++skipped;
+			return;
+		}
+
+		call();
+		cached = value;
+		++counter;
+	}
+
+	void RenderState::UseProgram(GLuint program)
+	{
+		if (s_Program == program)
+		{
+			++s_Current.s_Skipped;
+			return;
+		}
+
+		glUseProgram(program);
+		s_Program = program;
+		++s_Current.s_Programs;
+	}
+
+	void RenderState::BindVertexArray(GLuint vao)
+	{
+		if (s_VertexArray == vao)
+		{
+			++s_Current.s_Skipped;
+			return;
+		}
+
+		glBindVertexArray(vao);
+		s_VertexArray = vao;
+		++s_Current.s_VertexArrays;
+
+		// the element array binding belongs to the VAO
+		s_Buffers[SlotElement] = s_Unknown;
+	}
+
+	void RenderState::ActiveTexture(GLuint unit)
+	{
+		if (s_ActiveUnit == unit)
+			return;
+
+		glActiveTexture(GL_TEXTURE0 + unit);
+		s_ActiveUnit = unit;
+	}
+
+	void RenderState::BindTexture(GLenum target, GLuint texture)
+	{
+		int slot = SlotOf(target);
+
+		if (s_ActiveUnit >= MaxTextureUnits || slot < 0)
+		{
+			glBindTexture(target, texture);
+			++s_Current.s_Textures;
+			return;
+		}
+
+		GLuint& bound = s_Textures[s_ActiveUnit][slot];
+		if (bound == texture)
+		{
+			++s_Current.s_Skipped;
+			return;
+		}
+
+		glBindTexture(target, texture);
+		bound = texture;
+		++s_Current.s_Textures;
+	}
+
+	void RenderState::BindTexture(GLenum target, GLuint texture, GLuint unit)
+	{
+		ActiveTexture(unit);
+		BindTexture(target, texture);
+	}
+
+	void RenderState::BindBuffer(GLenum target, GLuint buffer)
+	{
+		int slot = BufferSlotOf(target);
+		if (slot < 0)
+		{
+			glBindBuffer(target, buffer);
+			++s_Current.s_Buffers;
+			return;
+		}
+
+		SetCached(s_Buffers[slot], buffer, s_Current.s_Buffers, s_Current.s_Skipped,
+			[&]() { glBindBuffer(target, buffer); });
+	}
+
+	void RenderState::BindBufferBase(GLenum target, GLuint index, GLuint buffer)
+	{
+		// indexed binds aren't cached, but they also replace the generic binding
+		glBindBufferBase(target, index, buffer);
+		++s_Current.s_Buffers;
+
+		int slot = BufferSlotOf(target);
+		if (slot >= 0)
+			s_Buffers[slot] = buffer;
+	}
+
+	void RenderState::BindFramebuffer(GLenum target, GLuint fbo)
+	{
+		switch (target)
+		{
+		case GL_READ_FRAMEBUFFER:
+			SetCached(s_ReadFramebuffer, fbo, s_Current.s_Framebuffers, s_Current.s_Skipped,
+				[&]() { glBindFramebuffer(target, fbo); });
+			break;
+		case GL_DRAW_FRAMEBUFFER:
+			SetCached(s_DrawFramebuffer, fbo, s_Current.s_Framebuffers, s_Current.s_Skipped,
+				[&]() { glBindFramebuffer(target, fbo); });
+			break;
+		default:
+			if (s_ReadFramebuffer == fbo && s_DrawFramebuffer == fbo)
+			{
+				++s_Current.s_Skipped;
+				return;
+			}
+
+			glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+			s_ReadFramebuffer = s_DrawFramebuffer = fbo;
+			++s_Current.s_Framebuffers;
+			break;
+		}
+	}
+
+	void RenderState::Viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+	{
+		if (s_Viewport[0] == x && s_Viewport[1] == y && s_Viewport[2] == width && s_Viewport[3] == height)
+		{
+			++s_Current.s_Skipped;
+			return;
+		}
+
+		glViewport(x, y, width, height);
+		s_Viewport[0] = x;
+		s_Viewport[1] = y;
+		s_Viewport[2] = width;
+		s_Viewport[3] = height;
+		++s_Current.s_Viewports;
+	}
+
+	void RenderState::Enable(GLenum cap)
+	{
+		int i = CapIndexOf(cap);
+		if (i < 0)
+		{
+			glEnable(cap);
+			++s_Current.s_States;
+			return;
+		}
+
+		SetCached(s_CapStates[i], CapOn, s_Current.s_States, s_Current.s_Skipped, [&]() { glEnable(cap); });
+	}
+
+	void RenderState::Disable(GLenum cap)
+	{
+		int i = CapIndexOf(cap);
+		if (i < 0)
+		{
+			glDisable(cap);
+			++s_Current.s_States;
+			return;
+		}
+
+		SetCached(s_CapStates[i], CapOff, s_Current.s_States, s_Current.s_Skipped, [&]() { glDisable(cap); });
+	}
+
+	void RenderState::CullFace(GLenum mode)
+	{
+		SetCached(s_CullFace, mode, s_Current.s_States, s_Current.s_Skipped, [&]() { glCullFace(mode); });
+	}
+
+	void RenderState::BlendFunc(GLenum src, GLenum dst)
+	{
+		if (s_BlendSrc == src && s_BlendDst == dst)
+		{
+			++s_Current.s_Skipped;
+			return;
+		}
+
+		glBlendFunc(src, dst);
+		s_BlendSrc = src;
+		s_BlendDst = dst;
+		++s_Current.s_States;
+	}
+
+	void RenderState::DepthFunc(GLenum func)
+	{
+		SetCached(s_DepthFunc, func, s_Current.s_States, s_Current.s_Skipped, [&]() { glDepthFunc(func); });
+	}
+
+	void RenderState::OnTextureDeleted(GLuint texture)
+	{
+		for (GLuint unit = 0; unit < MaxTextureUnits; ++unit)
+		{
+			for (GLuint& bound : s_Textures[unit])
+			{
+				if (bound == texture)
+					bound = 0;
+			}
+		}
+	}
+
+	void RenderState::OnVertexArrayDeleted(GLuint vao)
+	{
+		if (s_VertexArray == vao)
+			s_VertexArray = 0;
+	}
+
+	void RenderState::OnBufferDeleted(GLuint buffer)
+	{
+		for (GLuint& bound : s_Buffers)
+		{
+			if (bound == buffer)
+				bound = 0;
+		}
+	}
+
+	void RenderState::OnFramebufferDeleted(GLuint fbo)
+	{
+		if (s_ReadFramebuffer == fbo)
+			s_ReadFramebuffer = 0;
+
+		if (s_DrawFramebuffer == fbo)
+			s_DrawFramebuffer = 0;
+	}
+
+	void RenderState::Invalidate()
+	{
+		s_Program = s_Unknown;
+		s_VertexArray = s_Unknown;
+		s_ActiveUnit = s_Unknown;
+
+		s_ReadFramebuffer = s_DrawFramebuffer = s_Unknown;
+		s_Viewport[0] = s_Viewport[1] = s_Viewport[2] = s_Viewport[3] = -1;
+
+		s_CullFace = s_BlendSrc = s_BlendDst = s_DepthFunc = s_Unknown;
+
+		for (GLuint& bound : s_Buffers)
+		{
+			bound = s_Unknown;
+		}
+
+		for (GLuint& state : s_CapStates)
+		{
+			state = CapUnknown;
+		}
+
+		for (GLuint unit = 0; unit < MaxTextureUnits; ++unit)
+		{
+			for (GLuint& bound : s_Textures[unit])
+			{
+				bound = s_Unknown;
+			}
+		}
+	}
+
+	void RenderState::BeginFrame()
+	{
+		s_LastFrame = s_Current;
+		s_Current = Counters();
+
+		// the UI backend and anything else outside the engine may have rebound things
+		Invalidate();
+	}
+}
@@ -0,0 +1,70 @@
+#ifndef RENDERSTATE_H
+#define RENDERSTATE_H
+
+#include <glad/glad.h>
+
+namespace ARIS
+{
+	// Shadow copy of the GL binding and fixed-function state. Calls that
+	// match what's already set are skipped; every bind, capability toggle
+	// and viewport change in the engine goes through here so the copy stays
+	// in sync with the driver.
+	class RenderState
+	{
+	public:
+		static constexpr unsigned MaxTextureUnits = 32;
+
+		// Calls actually sent to GL vs. skipped as redundant
+		struct Counters
+		{
+			unsigned s_Programs = 0, s_VertexArrays = 0, s_Textures = 0;
+			unsigned s_Buffers = 0, s_Framebuffers = 0, s_Viewports = 0;
+			unsigned s_States = 0;
+			unsigned s_Skipped = 0;
+		};
+
+		static void UseProgram(GLuint program);
+		static void BindVertexArray(GLuint vao);
+
+		static void ActiveTexture(GLuint unit);
+
+		// Bind to the active unit / to the given unit (which becomes active)
+		static void BindTexture(GLenum target, GLuint texture);
+		static void BindTexture(GLenum target, GLuint texture, GLuint unit);
+
+		// Element array bindings are VAO state and are forgotten whenever the VAO changes
+		static void BindBuffer(GLenum target, GLuint buffer);
+		static void BindBufferBase(GLenum target, GLuint index, GLuint buffer);
+
+		// GL_FRAMEBUFFER sets both the read and draw bindings
+		static void BindFramebuffer(GLenum target, GLuint fbo);
+
+		static void Viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+		static void Enable(GLenum cap);
+		static void Disable(GLenum cap);
+
+		static void CullFace(GLenum mode);
+		static void BlendFunc(GLenum src, GLenum dst);
+		static void DepthFunc(GLenum func);
+
+		// Forget a deleted object so a recycled name isn't mistaken for it
+		static void OnTextureDeleted(GLuint texture);
+		static void OnVertexArrayDeleted(GLuint vao);
+		static void OnBufferDeleted(GLuint buffer);
+		static void OnFramebufferDeleted(GLuint fbo);
+
+		// Forget all cached state (after code that talks to GL directly)
+		static void Invalidate();
+
+		// Invalidates the cache and starts a new set of counters
+		static void BeginFrame();
+
+		static const Counters& GetFrameCounters() { return s_LastFrame; }
+
+	private:
+		static Counters s_Current, s_LastFrame;
+	};
+}
+
+#endif
@@ -69,14 +69,16 @@ namespace ARIS
 		{
 			glDeleteShader(gShader);
 		}
+
+		ReflectUniforms();
 	}
 
-	void Shader::GenerateCompute(bool includeHeader, const char* cmptPath)
+	void Shader::GenerateCompute(bool includeHeader, const char* cmptPath, const char* header)
 	{
 		int success;
 		char infoLog[512];
 
-		GLuint vShader = Compile(includeHeader, cmptPath, GL_COMPUTE_SHADER, std::string());
+		GLuint vShader = Compile(includeHeader, cmptPath, GL_COMPUTE_SHADER, std::string(), header);
 
 		m_ID = glCreateProgram();
 		glAttachShader(m_ID, vShader);
@@ -90,11 +92,64 @@ namespace ARIS
 		}
 
 		glDeleteShader(vShader);
+
+		ReflectUniforms();
+	}
+
+	void Shader::ReflectUniforms()
+	{
+		m_UniformLocations.clear();
+
+		GLint count = 0, maxLength = 0;
+		glGetProgramiv(m_ID, GL_ACTIVE_UNIFORMS, &count);
+		glGetProgramiv(m_ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+		std::vector<GLchar> buf(maxLength > 0 ? maxLength : 1);
+		m_UniformLocations.reserve(count);
+
+		for (GLint i = 0; i < count; ++i)
+		{
+			GLint size = 0;
+			GLenum type = 0;
+			GLsizei length = 0;
+			glGetActiveUniform(m_ID, static_cast<GLuint>(i), maxLength, &length, &size, &type, buf.data());
+
+			std::string name(buf.data(), length);
+			GLint loc = glGetUniformLocation(m_ID, name.c_str());
+
+			// uniform block members have no location
+			if (loc < 0)
+				continue;
+
+			m_UniformLocations[name] = loc;
+
+			// arrays are reported as "name[0]"; register the bare name and every element
+			size_t bracket = name.rfind("[0]");
+			if (bracket != std::string::npos && bracket + 3 == name.length())
+			{
+				std::string base = name.substr(0, bracket);
+				m_UniformLocations[base] = loc;
+
+				for (GLint j = 1; j < size; ++j)
+				{
+					std::string element = base + "[" + std::to_string(j) + "]";
+					m_UniformLocations[element] = glGetUniformLocation(m_ID, element.c_str());
+				}
+			}
+		}
+	}
+
+	GLint Shader::GetUniformLocation(const std::string& name) const
+	{
+		auto it = m_UniformLocations.find(name);
+
+		// inactive/unknown uniforms behave like GL's -1 location (silently ignored)
+		return it != m_UniformLocations.end() ? it->second : -1;
 	}
 
 	void Shader::Activate()
 	{
-		glUseProgram(m_ID);
+		RenderState::UseProgram(m_ID);
 	}
 
 	std::stringstream Shader::defaultHeaders;
@@ -180,42 +235,42 @@ namespace ARIS
 
 	void Shader::SetBool(const std::string& name, bool val)
 	{
-		glUniform1i(glGetUniformLocation(m_ID, name.c_str()), (int)val);
+		glUniform1i(GetUniformLocation(name), (int)val);
 	}
 
 	void Shader::SetInt(const std::string& name, int val)
 	{
-		glUniform1i(glGetUniformLocation(m_ID, name.c_str()), val);
+		glUniform1i(GetUniformLocation(name), val);
 	}
 
 	void Shader::SetIntDirect(const std::string& name, int val)
 	{
-		glUniform1i(glGetUniformLocation(m_ID, name.c_str()), val);
+		glUniform1i(GetUniformLocation(name), val);
 	}
 
 	void Shader::SetFloat(const std::string& name, float val)
 	{
-		glUniform1f(glGetUniformLocation(m_ID, name.c_str()), val);
+		glUniform1f(GetUniformLocation(name), val);
 	}
 
 	void Shader::SetVec3(const std::string& name, float v1, float v2, float v3)
 	{
-		glUniform3f(glGetUniformLocation(m_ID, name.c_str()), v1, v2, v3);
+		glUniform3f(GetUniformLocation(name), v1, v2, v3);
 	}
 
 	void Shader::SetVec3(const std::string& name, glm::vec3 v)
 	{
-		glUniform3fv(glGetUniformLocation(m_ID, name.c_str()), 1, &v[0]);
+		glUniform3fv(GetUniformLocation(name), 1, &v[0]);
 	}
 
 	void Shader::SetVec4(const std::string& name, float v1, float v2, float v3, float v4)
 	{
-		glUniform4f(glGetUniformLocation(m_ID, name.c_str()), v1, v2, v3, v4);
+		glUniform4f(GetUniformLocation(name), v1, v2, v3, v4);
 	}
 
 	void Shader::SetVec4(const std::string& name, glm::vec4 v)
 	{
-		glUniform4fv(glGetUniformLocation(m_ID, name.c_str()), 1, &v[0]);
+		glUniform4fv(GetUniformLocation(name), 1, &v[0]);
 	}
 
 	//void Shader::SetVec4(const std::string& name, aiColor4D color)
@@ -225,6 +280,6 @@ namespace ARIS
 
 	void Shader::SetMat4(const std::string& name, glm::mat4 val)
 	{
-		glUniformMatrix4fv(glGetUniformLocation(m_ID, name.c_str()), 1, GL_FALSE, glm::value_ptr(val));
+		glUniformMatrix4fv(GetUniformLocation(name), 1, GL_FALSE, glm::value_ptr(val));
 	}
 }
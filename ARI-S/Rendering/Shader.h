@@ -7,13 +7,23 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <unordered_map>
 
 #include <glm.hpp>
 #include <gtc/type_ptr.hpp>
 #include <gtc/matrix_transform.hpp>
 
+#include "RenderState.h"
+
 namespace ARIS
 {
+	// Pre-resolved uniform location; hot paths hold these instead of names
+	struct UniformHandle
+	{
+		GLint s_Location = -1;
+
+		bool IsValid() const { return s_Location >= 0; }
+	};
 
 	class Shader
 	{
@@ -29,12 +39,25 @@ namespace ARIS
 
 		void Generate(bool includeDefaultHeader, const char* vPath, const char* fPath, 
 			const char* gPath = nullptr, const char* header = nullptr);
-		void GenerateCompute(bool includeHeader, const char* cmptPath);
+		void GenerateCompute(bool includeHeader, const char* cmptPath, const char* header = nullptr);
 		void Activate();
 
 
 		GLuint Compile(bool includeDefaultHeader, const char* path, GLenum type, std::string& src, const char* header = nullptr);
 
+		// Location lookups go through the table built at link time
+		GLint GetUniformLocation(const std::string& name) const;
+		UniformHandle GetHandle(const std::string& name) const { return UniformHandle{ GetUniformLocation(name) }; }
+
+		void SetBool(UniformHandle h, bool val) { glUniform1i(h.s_Location, static_cast<int>(val)); }
+		void SetInt(UniformHandle h, int val) { glUniform1i(h.s_Location, val); }
+		void SetFloat(UniformHandle h, float val) { glUniform1f(h.s_Location, val); }
+		void SetVec2(UniformHandle h, glm::vec2 v) { glUniform2fv(h.s_Location, 1, &v[0]); }
+		void SetVec3(UniformHandle h, glm::vec3 v) { glUniform3fv(h.s_Location, 1, &v[0]); }
+		void SetVec4(UniformHandle h, glm::vec4 v) { glUniform4fv(h.s_Location, 1, &v[0]); }
+		void SetMat4(UniformHandle h, const glm::mat4& val) { glUniformMatrix4fv(h.s_Location, 1, GL_FALSE, glm::value_ptr(val)); }
+		void SetMat4Array(UniformHandle h, const glm::mat4* vals, int count) { glUniformMatrix4fv(h.s_Location, count, GL_FALSE, glm::value_ptr(vals[0])); }
+
 		void SetBool(const std::string& name, bool val);
 
 		void SetInt(const std::string& name, int val);
@@ -92,6 +115,11 @@ namespace ARIS
 		static void ClearDefault();
 
 		static std::string LoadShaderSrc(bool includeDefaultHeader, const char* path, const char* header = nullptr);
+
+	private:
+		void ReflectUniforms();
+
+		std::unordered_map<std::string, GLint> m_UniformLocations;
 	};
 }
 
@@ -0,0 +1,98 @@
+#include <arpch.h>
+#include "ShadowCascades.h"
+
+#include <gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace ARIS
+{
+	void ShadowCascades::Update(const CascadeSettings& settings, const glm::vec3& lightDir,
+		const glm::mat4& camView, const glm::mat4& camProj, float camNear, const BoundingBox& casters)
+	{
+		m_Count = std::min(std::max(settings.s_Count, 1u), MaxCascades);
+		m_Splits = glm::vec4(0.0f);
+
+		float zNear = camNear;
+		float zFar = std::max(settings.s_Distance, zNear + 0.01f);
+
+		// View-space rays through the frustum's corners, scaled to unit depth
+		glm::mat4 invProj = glm::inverse(camProj);
+		glm::mat4 invView = glm::inverse(camView);
+
+		glm::vec3 rays[4];
+		const glm::vec2 ndc[4] = { { -1.0f, -1.0f }, { 1.0f, -1.0f }, { -1.0f, 1.0f }, { 1.0f, 1.0f } };
+		for (int i = 0; i < 4; ++i)
+		{
+			glm::vec4 p = invProj * glm::vec4(ndc[i], 1.0f, 1.0f);
+			glm::vec3 corner = glm::vec3(p) / p.w;
+			rays[i] = corner / -corner.z;
+		}
+
+		// Light space only rotates; cascades translate within it
+		glm::vec3 dir = glm::normalize(lightDir);
+		glm::vec3 up = std::abs(dir.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+		m_LightView = glm::lookAt(glm::vec3(0.0f), dir, up);
+		const glm::mat4& lightView = m_LightView;
+
+		// Nearest caster depth (light space looks down -z, so towards the light is +z)
+		float casterMaxZ = -FLT_MAX;
+		for (int i = 0; i < 8; ++i)
+		{
+			glm::vec3 corner = glm::vec3(
+				(i & 1) ? casters.s_Max.x : casters.s_Min.x,
+				(i & 2) ? casters.s_Max.y : casters.s_Min.y,
+				(i & 4) ? casters.s_Max.z : casters.s_Min.z);
+
+			casterMaxZ = std::max(casterMaxZ, (lightView * glm::vec4(corner, 1.0f)).z);
+		}
+
+		float sliceNear = zNear;
+		for (uint32_t c = 0; c < m_Count; ++c)
+		{
+			// Blend of uniform and logarithmic split distances
+			float t = static_cast<float>(c + 1) / m_Count;
+			float uniform = zNear + (zFar - zNear) * t;
+			float logarithmic = zNear * std::pow(zFar / zNear, t);
+			float sliceFar = uniform + (logarithmic - uniform) * settings.s_SplitLambda;
+
+			glm::vec3 corners[8];
+			glm::vec3 center = glm::vec3(0.0f);
+			for (int i = 0; i < 4; ++i)
+			{
+				corners[i] = glm::vec3(invView * glm::vec4(rays[i] * sliceNear, 1.0f));
+				corners[i + 4] = glm::vec3(invView * glm::vec4(rays[i] * sliceFar, 1.0f));
+				center += corners[i] + corners[i + 4];
+			}
+			center /= 8.0f;
+
+			float radius = 0.0f;
+			for (const glm::vec3& corner : corners)
+			{
+				radius = std::max(radius, glm::length(corner - center));
+			}
+
+			// Quantized so float noise in the corners can't change the texel size
+			radius = std::ceil(radius * 16.0f) / 16.0f;
+
+			glm::vec3 lightCenter = glm::vec3(lightView * glm::vec4(center, 1.0f));
+
+			float texel = (2.0f * radius) / static_cast<float>(settings.s_Resolution);
+			lightCenter.x = std::floor(lightCenter.x / texel) * texel;
+			lightCenter.y = std::floor(lightCenter.y / texel) * texel;
+
+			float maxZ = std::max(lightCenter.z + radius, casterMaxZ);
+			float minZ = lightCenter.z - radius;
+
+			glm::mat4 lightProj = glm::ortho(lightCenter.x - radius, lightCenter.x + radius,
+				lightCenter.y - radius, lightCenter.y + radius, -maxZ, -minZ);
+
+			m_Projection[c] = lightProj;
+			m_Splits[c] = sliceFar;
+
+			sliceNear = sliceFar;
+		}
+	}
+}
@@ -0,0 +1,58 @@
+#ifndef SHADOWCASCADES_H
+#define SHADOWCASCADES_H
+
+#include "MeshResource.h"
+
+#include <glm.hpp>
+#include <cstdint>
+
+namespace ARIS
+{
+	struct CascadeSettings
+	{
+		uint32_t s_Count = 4;
+		uint32_t s_Resolution = 1024;
+
+		// Shadows end this far from the camera (view-space depth)
+		float s_Distance = 60.0f;
+
+		// 0 = uniform splits, 1 = logarithmic
+		float s_SplitLambda = 0.8f;
+	};
+
+	// Cascaded shadow maps for a directional light. The camera frustum up to the
+	// shadow distance is cut into depth slices, and each slice gets an
+	// orthographic light projection around its bounding sphere. The sphere keeps
+	// the projection's size fixed as the camera turns, and its centre is snapped
+	// to whole shadow texels, so edges don't shimmer while the camera moves.
+	class ShadowCascades
+	{
+	public:
+		static constexpr uint32_t MaxCascades = 4;
+
+		// lightDir - direction the light travels
+		// casters - bounds of everything that can cast, so geometry between the
+		//           light and a slice still lands in that slice's depth range
+		void Update(const CascadeSettings& settings, const glm::vec3& lightDir,
+			const glm::mat4& camView, const glm::mat4& camProj, float camNear, const BoundingBox& casters);
+
+		uint32_t GetCount() const { return m_Count; }
+
+		// All cascades share the light's rotation; only their projections differ
+		const glm::mat4& GetLightView() const { return m_LightView; }
+		const glm::mat4& GetProjection(uint32_t cascade) const { return m_Projection[cascade]; }
+		glm::mat4 GetViewProjection(uint32_t cascade) const { return m_Projection[cascade] * m_LightView; }
+
+		// View-space depth where each cascade ends (unused entries are 0)
+		const glm::vec4& GetSplits() const { return m_Splits; }
+
+	private:
+		uint32_t m_Count = 0;
+
+		glm::mat4 m_LightView = glm::mat4(1.0f);
+		glm::mat4 m_Projection[MaxCascades];
+		glm::vec4 m_Splits = glm::vec4(0.0f);
+	};
+}
+
+#endif
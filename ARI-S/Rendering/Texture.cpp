@@ -1,8 +1,11 @@
 #include <arpch.h>
 
 #include "Texture.h"
+#include "Compression/TextureCompressor.h"
+#include "IBL/HDRLoader.hpp"
 
 #include <stb_image.h>
+#include <cmath>
 
 namespace ARIS
 {
@@ -49,11 +52,15 @@ namespace ARIS
 		m_DataFormat = dataForm;
 
 		glGenTextures(1, &m_ID);
-		glBindTexture(GL_TEXTURE_2D, m_ID);
+		RenderState::BindTexture(GL_TEXTURE_2D, m_ID);
 
 		glTexImage2D(GL_TEXTURE_2D, 0, intForm, w, h, 0, dataForm, type, NULL);
 
-		glGenerateMipmap(GL_TEXTURE_2D);
+		// integer formats can't be filtered, so they get no mip chain
+		if (dataForm != GL_RED_INTEGER && dataForm != GL_RG_INTEGER && dataForm != GL_RGBA_INTEGER)
+		{
+			glGenerateMipmap(GL_TEXTURE_2D);
+		}
 
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
@@ -71,108 +78,112 @@ namespace ARIS
 		{
 			glTexImage2D(GL_TEXTURE_2D, 0, intForm, w, h, 0, dataForm, type, data);
 		}
-		glBindTexture(GL_TEXTURE_2D, 0);
+		RenderState::BindTexture(GL_TEXTURE_2D, 0);
 	}
 
 	Texture::Texture(const std::string& path, GLenum filter, GLenum repeat, 
 					bool hdr, aiTextureType texType)
+		: Texture(ReadImage(path, texType, hdr), path, filter, repeat, texType)
+	{
+	}
+
+	Texture::Texture(const ImageData& image, const std::string& path, GLenum filter, GLenum repeat, 
+					aiTextureType texType, int residentLevel)
 		: m_IsLoaded(false)
 		, type(texType)
 		, m_Path(path)
+		, m_Width(0)
+		, m_Height(0)
+		, m_InternalFormat(0)
+		, m_DataFormat(0)
 	{
-		int width, height, channels;
-		stbi_set_flip_vertically_on_load(1);
-
-		if (hdr)
-		{
-			int test = stbi_is_hdr(path.c_str());
-		}
-	
 		glGenTextures(1, &m_ID);
-		glBindTexture(GL_TEXTURE_2D, m_ID);
-	
-		
-		if (hdr)
-		{
-			float* data = stbi_loadf(path.c_str(), &width, &height, &channels, 0);
+		RenderState::BindTexture(GL_TEXTURE_2D, m_ID);
 
-			if (data != nullptr)
+		if (image.s_Pixels && image.s_CompressedFormat != 0)
+		{
+			m_IsLoaded = true;
+			m_Width = image.s_Width;
+			m_Height = image.s_Height;
+			m_InternalFormat = image.s_CompressedFormat;
+			m_DataFormat = image.s_Channels == 4 ? GL_RGBA : GL_RGB;
+
+			// the mips were built offline; upload each level as-is
+			GLsizei levels = static_cast<GLsizei>(image.s_Levels.size());
+			if (residentLevel >= 0)
 			{
-				m_IsLoaded = true;
-				m_Width = width;
-				m_Height = height;
-				m_Path = path;
-
-				GLenum dataFormat = 0;
-				if (channels == 4)
-				{
-					dataFormat = GL_RGBA;
-				}
-				else if (channels == 3)
-				{
-					dataFormat = GL_RGB;
-				}
-				else if (channels == 1)
-				{
-					dataFormat = GL_RED;
-				}
-
-				m_DataFormat = dataFormat;
-				m_InternalFormat = channels == 3 ? GL_RGB16F : GL_RGBA16F;
-
-				GLenum loadAs = hdr ? GL_FLOAT : GL_UNSIGNED_BYTE;
-
-				//glTextureStorage2D(m_ID, 1, internalFormat, m_Width, m_Height);
-				glTexImage2D(GL_TEXTURE_2D, 0, m_InternalFormat, m_Width, m_Height, 0, m_DataFormat, loadAs, data);
-				glGenerateMipmap(GL_TEXTURE_2D);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+				StreamLevels(image, levels, std::min<int>(residentLevel, levels - 1));
 			}
 			else
 			{
-				std::cout << "Texture failed!" << std::endl;
+				glTexStorage2D(GL_TEXTURE_2D, levels, m_InternalFormat, m_Width, m_Height);
+
+				GLsizei w = m_Width, h = m_Height;
+				for (GLsizei l = 0; l < levels; ++l)
+				{
+					glCompressedTexSubImage2D(GL_TEXTURE_2D, l, 0, 0, w, h, m_InternalFormat, 
+						static_cast<GLsizei>(image.s_Levels[l].second), image.s_Levels[l].first);
+
+					w = std::max(1, w / 2);
+					h = std::max(1, h / 2);
+				}
 			}
 		}
-			
-		else
+		else if (image.s_Pixels)
 		{
-			stbi_uc* data = stbi_load(path.c_str(), &width, &height, &channels, 0);
+			m_IsLoaded = true;
+			m_Width = image.s_Width;
+			m_Height = image.s_Height;
 
-			if (data != nullptr)
+			GLenum dataFormat = 0;
+			switch (image.s_Channels)
 			{
-				m_IsLoaded = true;
-				m_Width = width;
-				m_Height = height;
-				m_Path = path;
+			case 1:
+				dataFormat = GL_RED;
+				break;
+			case 2:
+				dataFormat = GL_RG;
+				break;
+			case 3:
+				dataFormat = GL_RGB;
+				break;
+			default:
+				dataFormat = GL_RGBA;
+				break;
+			}
 
-				GLenum dataFormat = 0;
-				if (channels == 4)
-				{
-					dataFormat = GL_RGBA;
-				}
-				else if (channels == 3)
-				{
-					dataFormat = GL_RGB;
-				}
-				else if (channels == 1)
-				{
-					dataFormat = GL_RED;
-				}
+			m_DataFormat = dataFormat;
+			m_InternalFormat = ChooseInternalFormat(texType, image.s_Channels, image.s_HDR);
 
-				m_DataFormat = dataFormat;
-				m_InternalFormat = channels == 3 ? GL_RGB16F : GL_RGBA16F;
+			GLenum loadAs = image.s_HDR ? GL_FLOAT : GL_UNSIGNED_BYTE;
 
-				GLenum loadAs = hdr ? GL_FLOAT : GL_UNSIGNED_BYTE;
+			// immutable storage for the full mip chain, allocated once
+			GLsizei levels = 1 + static_cast<GLsizei>(std::floor(std::log2(std::max(m_Width, m_Height))));
+			glTexStorage2D(GL_TEXTURE_2D, levels, m_InternalFormat, m_Width, m_Height);
 
-				//glTextureStorage2D(m_ID, 1, internalFormat, m_Width, m_Height);
-				glTexImage2D(GL_TEXTURE_2D, 0, m_InternalFormat, m_Width, m_Height, 0, m_DataFormat, loadAs, data);
-				glGenerateMipmap(GL_TEXTURE_2D);
-			}
-			else
+			// 8-bit RGB/R/RG rows aren't necessarily 4-byte aligned
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_Width, m_Height, m_DataFormat, loadAs, image.s_Pixels.get());
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+			glGenerateMipmap(GL_TEXTURE_2D);
+
+			// greyscale colour maps are stored as R/RG; read them back as grey
+			if (!image.s_HDR && IsColorData(texType) && image.s_Channels <= 2)
 			{
-				std::cout << "Texture failed!" << std::endl;
+				GLint swizzle[4] = { GL_RED, GL_RED, GL_RED, image.s_Channels == 2 ? GL_GREEN : GL_ONE };
+				glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
 			}
 		}
+		else
+		{
+			std::cout << "Texture failed!" << std::endl;
+		}
 	
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+		// use the mip chain when filtering linearly
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, 
+			m_IsLoaded && filter == GL_LINEAR ? GL_LINEAR_MIPMAP_LINEAR : filter);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
 
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, repeat);
@@ -186,6 +197,118 @@ namespace ARIS
 		}
 	}
 
+	void Texture::StreamLevels(const ImageData& image, int oldBase, int newBase)
+	{
+		RenderState::BindTexture(GL_TEXTURE_2D, m_ID);
+
+		// finer levels are defined before sampling is allowed to reach them...
+		for (int l = newBase; l < oldBase; ++l)
+		{
+			GLsizei w = std::max<GLsizei>(1, m_Width >> l);
+			GLsizei h = std::max<GLsizei>(1, m_Height >> l);
+
+			glCompressedTexImage2D(GL_TEXTURE_2D, l, m_InternalFormat, w, h, 0, 
+				static_cast<GLsizei>(image.s_Levels[l].second), image.s_Levels[l].first);
+		}
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, newBase);
+
+		// ...and dropped ones are redefined as empty afterwards, releasing their storage
+		for (int l = oldBase; l < newBase; ++l)
+		{
+			glTexImage2D(GL_TEXTURE_2D, l, GL_R8, 0, 0, 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+		}
+	}
+
+	bool Texture::IsColorData(aiTextureType type)
+	{
+		return type == aiTextureType_DIFFUSE || type == aiTextureType_BASE_COLOR || type == aiTextureType_EMISSIVE;
+	}
+
+	GLenum Texture::ChooseInternalFormat(aiTextureType type, int channels, bool hdr)
+	{
+		if (hdr)
+		{
+			const GLenum formats[] = { GL_R16F, GL_RG16F, GL_RGB16F, GL_RGBA16F };
+			return formats[std::clamp(channels, 1, 4) - 1];
+		}
+
+		switch (type)
+		{
+		// single-channel data; extra source channels are dropped on upload
+		case aiTextureType_METALNESS:
+		case aiTextureType_DIFFUSE_ROUGHNESS:
+		case aiTextureType_AMBIENT_OCCLUSION:
+		case aiTextureType_LIGHTMAP:
+		case aiTextureType_SPECULAR:
+		case aiTextureType_HEIGHT:
+			return GL_R8;
+
+		// tangent-space XY; Z follows from unit length
+		case aiTextureType_NORMALS:
+			return GL_RG8;
+
+		// glTF packed metal/roughness (G and B)
+		case aiTextureType_UNKNOWN:
+			return GL_RGB8;
+
+		default:
+			break;
+		}
+
+		if (IsColorData(type))
+		{
+			const GLenum formats[] = { GL_R8, GL_RG8, GL_SRGB8, GL_SRGB8_ALPHA8 };
+			return formats[std::clamp(channels, 1, 4) - 1];
+		}
+
+		const GLenum formats[] = { GL_R8, GL_RG8, GL_RGB8, GL_RGBA8 };
+		return formats[std::clamp(channels, 1, 4) - 1];
+	}
+
+	ImageData Texture::Decode(const std::string& path, bool hdr, bool flip)
+	{
+		// per-thread flag, so worker threads can decode alongside the GL thread
+		stbi_set_flip_vertically_on_load_thread(flip);
+
+		ImageData image;
+		image.s_HDR = hdr;
+
+		// Radiance files go through the parallel RGBE decoder
+		if (hdr && std::filesystem::path(path).extension() == ".hdr")
+		{
+			auto pixels = std::make_shared<std::vector<float>>();
+			if (HDRLoader::Decode(path, *pixels, image.s_Width, image.s_Height, flip))
+			{
+				image.s_Channels = 3;
+				image.s_Pixels = std::shared_ptr<void>(pixels, pixels->data());
+			}
+
+			return image;
+		}
+
+		void* pixels = hdr ? static_cast<void*>(stbi_loadf(path.c_str(), &image.s_Width, &image.s_Height, &image.s_Channels, 0))
+			: static_cast<void*>(stbi_load(path.c_str(), &image.s_Width, &image.s_Height, &image.s_Channels, 0));
+
+		if (pixels)
+		{
+			image.s_Pixels = std::shared_ptr<void>(pixels, stbi_image_free);
+		}
+
+		return image;
+	}
+
+	ImageData Texture::ReadImage(const std::string& path, aiTextureType type, bool hdr)
+	{
+		ImageData image;
+		if (!hdr && TextureCompressor::Load(path, type, image))
+		{
+			return image;
+		}
+
+		return Decode(path, hdr);
+	}
+
 	void Texture::Generate()
 	{
 		glGenTextures(1, &m_ID);
@@ -193,7 +316,7 @@ namespace ARIS
 
 	void Texture::Load(bool flip)
 	{
-		stbi_set_flip_vertically_on_load(flip);
+		stbi_set_flip_vertically_on_load_thread(flip);
 
 		int width, height, nChannels;
 		unsigned char* data = stbi_load((dir + "/" + m_Path).c_str(), &width, &height, &nChannels, 0);
@@ -212,7 +335,7 @@ namespace ARIS
 
 		if (data)
 		{
-			glBindTexture(GL_TEXTURE_2D, m_ID);
+			RenderState::BindTexture(GL_TEXTURE_2D, m_ID);
 			glTexImage2D(GL_TEXTURE_2D, 0, colorMode, width, height, 0, colorMode, GL_UNSIGNED_BYTE, data);
 			glGenerateMipmap(GL_TEXTURE_2D);
 
@@ -232,7 +355,7 @@ namespace ARIS
 	void Texture::AllocateCubemap(GLuint width, GLuint height, GLenum intForm, GLenum dataForm,
 		GLenum filter, GLenum repeat, GLenum type, bool generateMipMaps)
 	{
-		glBindTexture(GL_TEXTURE_CUBE_MAP, m_ID);
+		RenderState::BindTexture(GL_TEXTURE_CUBE_MAP, m_ID);
 
 		for (unsigned i = 0; i < 6; ++i)
 		{
@@ -251,10 +374,28 @@ namespace ARIS
 		}
 	}
 
+	void Texture::AllocateArray(GLuint width, GLuint height, GLuint layers, GLenum intForm, GLenum dataForm,
+		GLenum filter, GLenum repeat, GLenum type)
+	{
+		m_Width = width;
+		m_Height = height;
+		m_InternalFormat = intForm;
+		m_DataFormat = dataForm;
+
+		RenderState::BindTexture(GL_TEXTURE_2D_ARRAY, m_ID);
+
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, intForm, width, height, layers, 0, dataForm, type, nullptr);
+
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, repeat);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, repeat);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, filter);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, filter);
+	}
+
 	void Texture::LoadCubemap(std::vector<std::string> faces)
 	{
-		stbi_set_flip_vertically_on_load(false);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, m_ID);
+		stbi_set_flip_vertically_on_load_thread(false);
+		RenderState::BindTexture(GL_TEXTURE_CUBE_MAP, m_ID);
 
 		int width, height, nrChannels;
 
@@ -307,22 +448,23 @@ namespace ARIS
 
 	void Texture::Bind()
 	{
-		glBindTexture(GL_TEXTURE_2D, m_ID);
+		RenderState::BindTexture(GL_TEXTURE_2D, m_ID);
 	}
 
 	void Texture::Bind(GLuint slot)
 	{
-		glActiveTexture(GL_TEXTURE0 + slot);
-		glBindTexture(GL_TEXTURE_2D, m_ID);
+		RenderState::ActiveTexture(slot);
+		RenderState::BindTexture(GL_TEXTURE_2D, m_ID);
 	}
 
 	void Texture::Unbind()
 	{
-		glBindTexture(GL_TEXTURE_2D, 0);
+		RenderState::BindTexture(GL_TEXTURE_2D, 0);
 	}
 
 	void Texture::Cleanup()
 	{
 		glDeleteTextures(1, &m_ID);
+		RenderState::OnTextureDeleted(m_ID);
 	}
 }
\ No newline at end of file
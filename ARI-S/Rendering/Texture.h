@@ -6,9 +6,27 @@
 #include <assimp/scene.h>
 
 #include <string>
+#include <memory>
+#include <vector>
+
+#include "RenderState.h"
 
 namespace ARIS
 {
+	// Decoded pixels, produced off the GL thread and uploaded later
+	struct ImageData
+	{
+		int s_Width = 0, s_Height = 0, s_Channels = 0;
+		bool s_HDR = false;
+
+		// stbi-owned (or the compressed levels' storage); empty if decoding failed
+		std::shared_ptr<void> s_Pixels;
+
+		// Block-compressed mip chain (s_CompressedFormat != 0); the levels point into s_Pixels
+		GLenum s_CompressedFormat = 0;
+		std::vector<std::pair<const uint8_t*, size_t>> s_Levels;
+	};
+
 	class Texture
 	{
 	public:
@@ -16,17 +34,39 @@ namespace ARIS
 		Texture(std::string name);
 		Texture(std::string dir, std::string path, aiTextureType texType = aiTextureType_NONE);
 		Texture(const std::string& path, GLenum filter, GLenum repeat, bool hdr = false, aiTextureType texType = aiTextureType_NONE);
+		// residentLevel - for block-compressed chains, upload only that level and coarser into
+		// mutable per-level storage so StreamLevels() can change residency later (-1 = everything)
+		Texture(const ImageData& image, const std::string& path, GLenum filter, GLenum repeat, 
+			aiTextureType texType = aiTextureType_NONE, int residentLevel = -1);
 
 		Texture(GLuint width, GLuint height, 
 			GLenum intForm, GLenum dataForm, void* data = nullptr, 
 			GLenum filter = GL_LINEAR, GLenum repeat = GL_REPEAT, GLenum type = GL_UNSIGNED_BYTE);
 
+		// Thread-safe; no GL calls
+		static ImageData Decode(const std::string& path, bool hdr = false, bool flip = true);
+
+		// Block-compressed image from the texture cache when possible (see TextureCompressor),
+		// otherwise the decoded source. Thread-safe; no GL calls
+		static ImageData ReadImage(const std::string& path, aiTextureType type, bool hdr = false);
+
+		// Compact storage format for a decoded image: sRGB for colour maps,
+		// linear R8/RG8 for single-channel data and normal maps, 16F for HDR
+		static GLenum ChooseInternalFormat(aiTextureType type, int channels, bool hdr);
+		static bool IsColorData(aiTextureType type);
+
+		// Move the finest resident level of a streamed texture from oldBase to newBase,
+		// uploading newly needed levels from image or releasing dropped ones
+		void StreamLevels(const ImageData& image, int oldBase, int newBase);
+
 		void Generate();
 		void Load(bool flip = true);
 		
 		void LoadCubemap(std::vector<std::string> faces);
 		void AllocateCubemap(GLuint width, GLuint height, GLenum intForm, GLenum dataForm, 
 			GLenum filter, GLenum repeat, GLenum type, bool genMipMaps = false);
+		void AllocateArray(GLuint width, GLuint height, GLuint layers, GLenum intForm, GLenum dataForm,
+			GLenum filter, GLenum repeat, GLenum type);
 
 		void Allocate(GLenum interForm, GLenum dataForm, GLuint width, GLuint height, GLenum type);
 
@@ -0,0 +1,321 @@
+#include <arpch.h>
+#include "TextureCache.h"
+#include "Compression/TextureCompressor.h"
+
+namespace ARIS
+{
+	TextureCache* TextureCache::m_Instance = nullptr;
+
+	TextureCache::TextureCache()
+	{
+		m_Instance = this;
+	}
+
+	TextureCache::~TextureCache()
+	{
+		// entries still referenced by handles stay alive through them
+		m_Entries.clear();
+	}
+
+	std::string TextureCache::MakeKey(const std::string& path, aiTextureType type, GLenum filter, GLenum repeat, bool hdr)
+	{
+		std::error_code ec;
+		std::filesystem::path canonical = std::filesystem::weakly_canonical(path, ec);
+		if (ec)
+		{
+			canonical = std::filesystem::path(path).lexically_normal();
+		}
+
+		std::string key = canonical.generic_string();
+		std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+		return key + "|" + std::to_string(type) + "|" + std::to_string(filter) + "|" + std::to_string(repeat) + "|" + std::to_string(hdr);
+	}
+
+	std::shared_ptr<Texture> TextureCache::Acquire(const std::string& path, aiTextureType type,
+		GLenum filter, GLenum repeat, bool hdr, const ImageData* image)
+	{
+		std::string key = MakeKey(path, type, filter, repeat, hdr);
+
+		std::shared_ptr<Entry> entry;
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			auto it = m_Entries.find(key);
+			if (it != m_Entries.end())
+			{
+				entry = it->second;
+				++m_Hits;
+			}
+		}
+
+		if (!entry)
+		{
+			ImageData source = image ? *image : Texture::ReadImage(path, type, hdr);
+
+			// stream chains with levels above the tail; everything else is uploaded whole
+			int levels = source.s_CompressedFormat != 0 ? static_cast<int>(source.s_Levels.size()) : 0;
+			int tail = std::max(0, levels - StreamingTailLevels);
+			bool streamed = m_Streaming && tail > 0;
+
+			entry = std::make_shared<Entry>(Entry{ Texture(source, path, filter, repeat, type, streamed ? tail : -1) });
+
+			if (streamed)
+			{
+				entry->s_Streamed = true;
+				entry->s_Source = source;
+				entry->s_BaseLevel = entry->s_TailLevel = entry->s_WantedLevel = tail;
+				entry->s_Bytes = LevelBytes(*entry, tail);
+			}
+			else
+			{
+				entry->s_Bytes = EstimateBytes(entry->s_Texture);
+			}
+
+			// the old loader's RGB16F / RGBA16F, for comparison
+			const Texture& t = entry->s_Texture;
+			size_t legacy = static_cast<size_t>(t.m_Width) * t.m_Height * (t.m_DataFormat == GL_RGB ? 6 : 8);
+			entry->s_Legacy16FBytes = t.m_IsLoaded ? legacy + legacy / 3 : 0;
+
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Entries[key] = entry;
+			if (streamed)
+			{
+				m_Streamed[entry->s_Texture.m_ID] = entry.get();
+			}
+			m_ResidentBytes += entry->s_Bytes;
+			m_Legacy16FBytes += entry->s_Legacy16FBytes;
+			++m_Misses;
+		}
+
+		// the handle's deleter holds the entry, so use_count() tracks live handles
+		Texture* view = new Texture(entry->s_Texture);
+		view->m_Path = path;
+
+		return std::shared_ptr<Texture>(view, [entry](Texture* t) { delete t; });
+	}
+
+	bool TextureCache::IsResident(const std::string& path, aiTextureType type, GLenum filter, GLenum repeat, bool hdr) const
+	{
+		std::string key = MakeKey(path, type, filter, repeat, hdr);
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return m_Entries.find(key) != m_Entries.end();
+	}
+
+	unsigned TextureCache::EvictUnused()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		unsigned evicted = 0;
+		for (auto it = m_Entries.begin(); it != m_Entries.end();)
+		{
+			if (it->second.use_count() == 1)
+			{
+				m_Streamed.erase(it->second->s_Texture.m_ID);
+				it->second->s_Texture.Cleanup();
+				m_ResidentBytes -= it->second->s_Bytes;
+				m_Legacy16FBytes -= it->second->s_Legacy16FBytes;
+
+				it = m_Entries.erase(it);
+				++evicted;
+			}
+			else
+			{
+				++it;
+			}
+		}
+
+		m_Evictions += evicted;
+		return evicted;
+	}
+
+	TextureCache::Stats TextureCache::GetStats() const
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		Stats s;
+		s.s_Hits = m_Hits;
+		s.s_Misses = m_Misses;
+		s.s_Evictions = m_Evictions;
+		s.s_Entries = static_cast<unsigned>(m_Entries.size());
+		s.s_ResidentBytes = m_ResidentBytes;
+		s.s_Legacy16FBytes = m_Legacy16FBytes;
+
+		s.s_Streamed = static_cast<unsigned>(m_Streamed.size());
+		s.s_LevelUploads = m_LevelUploads;
+		s.s_LevelEvictions = m_LevelEvictions;
+		for (const auto& [id, e] : m_Streamed)
+		{
+			s.s_StreamedBytes += e->s_Bytes;
+			s.s_StreamedFullBytes += LevelBytes(*e, 0);
+		}
+
+		return s;
+	}
+
+	void TextureCache::RequestResidency(GLuint id, float screenPixels)
+	{
+		auto it = m_Streamed.find(id);
+		if (it == m_Streamed.end())
+			return;
+
+		Entry& e = *it->second;
+
+		// one texel per pixel: each level down halves the resolution
+		float size = static_cast<float>(std::max(e.s_Texture.m_Width, e.s_Texture.m_Height));
+		float level = std::log2(size / std::max(screenPixels, 1.0f)) - m_StreamingBias;
+		int wanted = std::clamp(static_cast<int>(std::floor(level)), 0, e.s_TailLevel);
+
+		// the finest request of the frame wins
+		if (e.s_LastUsed != m_Frame)
+		{
+			e.s_LastUsed = m_Frame;
+			e.s_WantedLevel = wanted;
+		}
+		else
+		{
+			e.s_WantedLevel = std::min(e.s_WantedLevel, wanted);
+		}
+	}
+
+	void TextureCache::UpdateStreaming()
+	{
+		std::vector<Entry*> raise;
+		for (const auto& [id, e] : m_Streamed)
+		{
+			if (GetDesiredLevel(*e) < e->s_BaseLevel)
+				raise.push_back(e);
+		}
+
+		// furthest from what they need first
+		std::sort(raise.begin(), raise.end(), [this](const Entry* a, const Entry* b)
+		{
+			return a->s_BaseLevel - GetDesiredLevel(*a) > b->s_BaseLevel - GetDesiredLevel(*b);
+		});
+
+		// one level per texture per frame, within the upload budget
+		m_LevelUploads = 0;
+		size_t uploaded = 0;
+		for (Entry* e : raise)
+		{
+			int level = e->s_BaseLevel - 1;
+			size_t bytes = e->s_Source.s_Levels[level].second;
+
+			if (uploaded > 0 && uploaded + bytes > m_UploadBudget)
+				break;
+
+			while (m_ResidentBytes + bytes > m_StreamingBudget && EvictLevel(e))
+			{
+			}
+
+			if (m_ResidentBytes + bytes > m_StreamingBudget)
+				continue;
+
+			SetBaseLevel(*e, level);
+			uploaded += bytes;
+			++m_LevelUploads;
+		}
+
+		// the budget may have been lowered
+		while (m_ResidentBytes > m_StreamingBudget && EvictLevel(nullptr))
+		{
+		}
+
+		++m_Frame;
+	}
+
+	size_t TextureCache::LevelBytes(const Entry& e, int from)
+	{
+		size_t bytes = 0;
+		for (size_t l = from; l < e.s_Source.s_Levels.size(); ++l)
+		{
+			bytes += e.s_Source.s_Levels[l].second;
+		}
+
+		return bytes;
+	}
+
+	int TextureCache::GetDesiredLevel(const Entry& e) const
+	{
+		return e.s_LastUsed == m_Frame ? e.s_WantedLevel : e.s_TailLevel;
+	}
+
+	void TextureCache::SetBaseLevel(Entry& e, int level)
+	{
+		e.s_Texture.StreamLevels(e.s_Source, e.s_BaseLevel, level);
+
+		if (level > e.s_BaseLevel)
+		{
+			m_LevelEvictions += level - e.s_BaseLevel;
+		}
+
+		size_t bytes = LevelBytes(e, level);
+		e.s_BaseLevel = level;
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_ResidentBytes = m_ResidentBytes - e.s_Bytes + bytes;
+		e.s_Bytes = bytes;
+	}
+
+	bool TextureCache::EvictLevel(const Entry* keep)
+	{
+		Entry* victim = nullptr;
+		for (const auto& [id, e] : m_Streamed)
+		{
+			if (e == keep || e->s_BaseLevel >= GetDesiredLevel(*e))
+				continue;
+
+			if (!victim || e->s_LastUsed < victim->s_LastUsed ||
+				(e->s_LastUsed == victim->s_LastUsed && e->s_BaseLevel < victim->s_BaseLevel))
+			{
+				victim = e;
+			}
+		}
+
+		if (!victim)
+			return false;
+
+		SetBaseLevel(*victim, victim->s_BaseLevel + 1);
+		return true;
+	}
+
+	size_t TextureCache::EstimateBytes(const Texture& t)
+	{
+		if (!t.m_IsLoaded)
+			return 0;
+
+		// block formats: 4 or 8 bits per texel, + a third for the mips
+		if (unsigned bits = TextureCompressor::GetBitsPerTexel(t.m_InternalFormat))
+		{
+			size_t base = static_cast<size_t>(t.m_Width) * t.m_Height * bits / 8;
+			return base + base / 3;
+		}
+
+		size_t texel = 4;
+		switch (t.m_InternalFormat)
+		{
+		case GL_R8:
+			texel = 1;
+			break;
+		case GL_RG8:
+		case GL_R16F:
+			texel = 2;
+			break;
+		case GL_RGB8:
+		case GL_SRGB8:
+			texel = 3;
+			break;
+		case GL_RGB16F:
+			texel = 6;
+			break;
+		case GL_RGBA16F:
+			texel = 8;
+			break;
+		}
+
+		// + a third for the mip chain
+		size_t base = static_cast<size_t>(t.m_Width) * t.m_Height * texel;
+		return base + base / 3;
+	}
+}
@@ -0,0 +1,120 @@
+#ifndef TEXTURECACHE_H
+#define TEXTURECACHE_H
+
+#include "Texture.h"
+
+#include <mutex>
+
+namespace ARIS
+{
+	// Process-wide cache of file textures keyed by canonical path, texture type
+	// (which picks the storage format) and sampler parameters, so each image is
+	// decoded and uploaded once. Handles are shared_ptrs to a copy of the entry's
+	// texture; every live handle pins its entry, and EvictUnused() frees the GL
+	// textures nobody holds.
+	//
+	// Block-compressed textures are streamed: only the mip tail (64x64 and below)
+	// is uploaded at first. Each frame the geometry pass reports how many pixels
+	// every visible texture covers, and UpdateStreaming() uploads finer levels
+	// towards that, dropping levels from textures that no longer need them
+	// (least recently seen first) whenever the budget would be exceeded.
+	class TextureCache
+	{
+	public:
+		struct Stats
+		{
+			unsigned s_Hits = 0, s_Misses = 0, s_Evictions = 0;
+			unsigned s_Entries = 0;
+			size_t s_ResidentBytes = 0;
+
+			// what the same textures took when every 8-bit image was stored as RGB(A)16F
+			size_t s_Legacy16FBytes = 0;
+
+			// streamed textures: resident vs. full-chain size, levels uploaded
+			// last frame and levels dropped in total
+			unsigned s_Streamed = 0;
+			size_t s_StreamedBytes = 0, s_StreamedFullBytes = 0;
+			unsigned s_LevelUploads = 0, s_LevelEvictions = 0;
+		};
+
+		TextureCache();
+		~TextureCache();
+
+		inline static TextureCache& Get() { return *m_Instance; }
+
+		// image - already decoded pixels to upload on a miss (nullptr = decode here)
+		std::shared_ptr<Texture> Acquire(const std::string& path, aiTextureType type = aiTextureType_NONE,
+			GLenum filter = GL_LINEAR, GLenum repeat = GL_REPEAT, bool hdr = false, const ImageData* image = nullptr);
+
+		// Safe from worker threads; lets loaders skip decoding resident images
+		bool IsResident(const std::string& path, aiTextureType type = aiTextureType_NONE,
+			GLenum filter = GL_LINEAR, GLenum repeat = GL_REPEAT, bool hdr = false) const;
+
+		// Delete every entry without live handles; returns how many were freed
+		unsigned EvictUnused();
+
+		// GL thread. screenPixels - on-screen size of the surface the texture covers
+		void RequestResidency(GLuint id, float screenPixels);
+
+		// GL thread, once per frame after the requests
+		void UpdateStreaming();
+
+		Stats GetStats() const;
+
+		static size_t EstimateBytes(const Texture& t);
+
+		// Only affects textures loaded from here on
+		bool m_Streaming = true;
+
+		// Cap on the bytes of every cached texture, and on level uploads per frame
+		size_t m_StreamingBudget = size_t(512) << 20;
+		size_t m_UploadBudget = size_t(8) << 20;
+
+		// Positive values keep finer mips than the screen-size estimate asks for
+		float m_StreamingBias = 1.0f;
+
+	private:
+		// levels of the chain that are always resident (64x64 and below)
+		static constexpr int StreamingTailLevels = 7;
+
+		struct Entry
+		{
+			Texture s_Texture;
+			size_t s_Bytes = 0;
+			size_t s_Legacy16FBytes = 0;
+
+			// streaming state; s_Source keeps the compressed chain (mapped cache file)
+			bool s_Streamed = false;
+			ImageData s_Source;
+			int s_BaseLevel = 0, s_TailLevel = 0, s_WantedLevel = 0;
+			uint64_t s_LastUsed = 0;
+		};
+
+		static std::string MakeKey(const std::string& path, aiTextureType type, GLenum filter, GLenum repeat, bool hdr);
+
+		static size_t LevelBytes(const Entry& e, int from);
+
+		// Finest level the entry needs this frame (its tail if it wasn't seen)
+		int GetDesiredLevel(const Entry& e) const;
+		void SetBaseLevel(Entry& e, int level);
+
+		// Drop one level from the least recently seen texture holding more than
+		// it needs (never the one being raised); false if there's nothing to drop
+		bool EvictLevel(const Entry* keep);
+
+		std::unordered_map<std::string, std::shared_ptr<Entry>> m_Entries;
+		mutable std::mutex m_Mutex;
+
+		// streamed entries by GL id, so the geometry pass can report them cheaply
+		std::unordered_map<GLuint, Entry*> m_Streamed;
+		uint64_t m_Frame = 1;
+
+		unsigned m_Hits = 0, m_Misses = 0, m_Evictions = 0;
+		unsigned m_LevelUploads = 0, m_LevelEvictions = 0;
+		size_t m_ResidentBytes = 0, m_Legacy16FBytes = 0;
+
+		static TextureCache* m_Instance;
+	};
+}
+
+#endif
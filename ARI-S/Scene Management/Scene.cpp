@@ -14,6 +14,13 @@
 #include "Math/Vector.h"
 #include "Math/Cholesky.hpp"
 #include "IBL/SphereHarmonics.hpp"
+#include "Math/Math.h"
+#include "Culling/Frustum.hpp"
+#include "AssetLoader.h"
+#include "TextureCache.h"
+#include "Hasher.hpp"
+
+#include <omp.h>
 
 #include "../Rendering/DebugDraw.h"
 
@@ -31,12 +38,13 @@ bool useSpecular = true;
 bool useOcclusion = true;
 bool useToneMapping = true;
 
-bool useSH = false;
 bool useOldPBRMethod = false;
 std::string currEnvMap = "Newport_Loft";
 
+bool shFromCubemap = false;
+bool useIBLCache = true;
+
 bool displayIrr = false;
-bool displayIrrSH = false;
 float exposure = 1.0f;
 
 float aoScale = 1.0f;
@@ -45,6 +53,13 @@ int aoSamplePoints = 20;
 float aoInfluenceRange = 0.1f;
 bool blurAO = true;
 
+bool useFrustumCulling = true;
+bool useClusteredLights = true;
+bool showCascades = false;
+bool useShadowCache = true;
+
+int benchmarkLightCount = 1024;
+
 namespace ARIS
 {
     float RandomNum(float min, float max)
@@ -77,12 +92,191 @@ namespace ARIS
         return e;
     }
 
+    entt::entity Scene::Raycast(const glm::vec3& origin, const glm::vec3& dir, float maxDist)
+    {
+        m_BVH.QueryRay(origin, dir, maxDist, m_RayResults);
+
+        entt::entity closest = entt::null;
+        float closestT = maxDist;
+
+        // Candidates are sorted by box entry distance, so stop once a box
+        // starts beyond the nearest triangle hit so far
+        for (const auto& [boxT, data] : m_RayResults)
+        {
+            if (boxT > closestT)
+                break;
+
+            entt::entity entity = static_cast<entt::entity>(data);
+            auto [objTr, mesh] = m_Registry.get<TransformComponent, MeshComponent>(entity);
+
+            // Intersect in model space against the shared vertex data
+            glm::mat4 invModel = glm::inverse(objTr.GetTransform());
+            glm::vec3 o = glm::vec3(invModel * glm::vec4(origin, 1.0f));
+            glm::vec3 d = glm::vec3(invModel * glm::vec4(dir, 0.0f));
+
+            for (const Mesh& m : mesh.GetModel()->GetMeshes())
+            {
+                if (!m.GetResource())
+                    continue;
+
+                const std::vector<Vertex>& verts = m.GetResource()->GetVertexData();
+                const std::vector<unsigned>& indices = m.GetResource()->GetIndices();
+
+                for (size_t i = 0; i + 2 < indices.size(); i += 3)
+                {
+                    // Moller-Trumbore; t is in world units since d is the untransformed direction
+                    const glm::vec3& v0 = verts[indices[i]].s_Position;
+                    glm::vec3 e1 = verts[indices[i + 1]].s_Position - v0;
+                    glm::vec3 e2 = verts[indices[i + 2]].s_Position - v0;
+
+                    glm::vec3 p = glm::cross(d, e2);
+                    float det = glm::dot(e1, p);
+                    if (std::abs(det) < 1e-8f)
+                        continue;
+
+                    float invDet = 1.0f / det;
+                    glm::vec3 s = o - v0;
+                    float u = glm::dot(s, p) * invDet;
+                    if (u < 0.0f || u > 1.0f)
+                        continue;
+
+                    glm::vec3 q = glm::cross(s, e1);
+                    float v = glm::dot(d, q) * invDet;
+                    if (v < 0.0f || u + v > 1.0f)
+                        continue;
+
+                    float t = glm::dot(e2, q) * invDet;
+                    if (t > 0.0f && t < closestT)
+                    {
+                        closestT = t;
+                        closest = entity;
+                    }
+                }
+            }
+        }
+
+        m_RayResults.clear();
+        return closest;
+    }
+
+    entt::entity Scene::PickEntity(const EditorCamera& cam, const glm::vec2& ndc)
+    {
+        glm::mat4 invViewProj = glm::inverse(cam.GetViewProjection());
+
+        glm::vec4 nearP = invViewProj * glm::vec4(ndc, -1.0f, 1.0f);
+        glm::vec4 farP = invViewProj * glm::vec4(ndc, 1.0f, 1.0f);
+
+        glm::vec3 origin = glm::vec3(nearP) / nearP.w;
+        glm::vec3 end = glm::vec3(farP) / farP.w;
+
+        return Raycast(origin, glm::normalize(end - origin), glm::length(end - origin));
+    }
+
     void Scene::DestroyEntity(Entity e)
     {
+        // Children outlive their parent as roots
+        if (RelationshipComponent* rel = m_Registry.try_get<RelationshipComponent>(e))
+        {
+            while (rel->s_FirstChild != entt::null)
+            {
+                SetParent({ rel->s_FirstChild, this }, {});
+            }
+
+            DetachFromParent(e);
+        }
+
         m_EntityMap.erase(e.GetUUID());
         m_Registry.destroy(e);
     }
 
+    void Scene::SetParent(Entity child, Entity parent, bool keepWorld)
+    {
+        entt::entity c = child, p = parent;
+
+        if (c == p || GetParent(child) == parent)
+            return;
+
+        // The new parent can't be one of the child's descendants
+        for (entt::entity it = p; it != entt::null; it = GetParent({ it, this }))
+        {
+            if (it == c)
+            {
+                std::cout << "Cannot parent " << child.GetName() << " to its own descendant " << parent.GetName() << std::endl;
+                return;
+            }
+        }
+
+        DetachFromParent(c);
+
+        glm::mat4 parentWorld = glm::mat4(1.0f);
+
+        if (p != entt::null)
+        {
+            m_Registry.get_or_emplace<RelationshipComponent>(p);
+            m_Registry.get_or_emplace<RelationshipComponent>(c);
+
+            RelationshipComponent& parentRel = m_Registry.get<RelationshipComponent>(p);
+            RelationshipComponent& childRel = m_Registry.get<RelationshipComponent>(c);
+
+            childRel.s_Parent = p;
+            childRel.s_NextSibling = parentRel.s_FirstChild;
+
+            if (parentRel.s_FirstChild != entt::null)
+            {
+                m_Registry.get<RelationshipComponent>(parentRel.s_FirstChild).s_PrevSibling = c;
+            }
+
+            parentRel.s_FirstChild = c;
+            ++parentRel.s_ChildCount;
+
+            parentWorld = m_Registry.get<TransformComponent>(p).GetTransform();
+        }
+
+        // Keep the child where it is in the world
+        TransformComponent& tr = m_Registry.get<TransformComponent>(c);
+
+        glm::vec3 translation, rotation, scale;
+        if (keepWorld && Math::Decompose(glm::inverse(parentWorld) * tr.GetTransform(), translation, rotation, scale))
+        {
+            tr.Translate(translation);
+            tr.Rotate(rotation);
+            tr.Scale(scale);
+        }
+
+        tr.MarkDirty();
+    }
+
+    Entity Scene::GetParent(Entity e)
+    {
+        const RelationshipComponent* rel = m_Registry.try_get<RelationshipComponent>(e);
+        if (!rel || rel->s_Parent == entt::null)
+            return {};
+
+        return { rel->s_Parent, this };
+    }
+
+    void Scene::DetachFromParent(entt::entity e)
+    {
+        RelationshipComponent* rel = m_Registry.try_get<RelationshipComponent>(e);
+        if (!rel || rel->s_Parent == entt::null)
+            return;
+
+        RelationshipComponent& parentRel = m_Registry.get<RelationshipComponent>(rel->s_Parent);
+
+        if (parentRel.s_FirstChild == e)
+            parentRel.s_FirstChild = rel->s_NextSibling;
+
+        if (rel->s_PrevSibling != entt::null)
+            m_Registry.get<RelationshipComponent>(rel->s_PrevSibling).s_NextSibling = rel->s_NextSibling;
+
+        if (rel->s_NextSibling != entt::null)
+            m_Registry.get<RelationshipComponent>(rel->s_NextSibling).s_PrevSibling = rel->s_PrevSibling;
+
+        --parentRel.s_ChildCount;
+
+        rel->s_Parent = rel->s_PrevSibling = rel->s_NextSibling = entt::null;
+    }
+
     Entity Scene::FindEntityByName(std::string_view name)
     {
         auto view = m_Registry.view<TagComponent>();
@@ -133,7 +327,12 @@ namespace ARIS
         harmonicData = new UniformBuffer<HarmonicColors>(5);
         aoKernelData = new UniformBuffer<BlurKernel>(6);
 
-        outputIrrTex = nullptr;
+        hdrMapping = nullptr;
+
+        hdrTexture = nullptr;
+        hdrCubemap = nullptr;
+        filteredHDR = nullptr;
+        brdfTex = nullptr;
     }
 
     void Scene::ReloadShaders()
@@ -151,6 +350,15 @@ namespace ARIS
         aoPass = new Shader(false, "AO/AO.vert", "AO/AO.frag");
         aoBlurX = new Shader(false, "AO/BilateralBlurX.cmpt");
         aoBlurY = new Shader(false, "AO/BilateralBlurY.cmpt");
+
+        // cached shadow layers were rendered with the old programs
+        for (ShadowCache& cache : m_ShadowCache)
+        {
+            cache.s_Valid = false;
+        }
+        m_BlurredWeight = 0;
+
+        m_LightClusters.ReloadShaders();
     }
 
     void Scene::GenerateBasicShapes()
@@ -166,8 +374,8 @@ namespace ARIS
         // setup plane VAO
         glGenVertexArrays(1, &quadVAO);
         glGenBuffers(1, &quadVBO);
-        glBindVertexArray(quadVAO);
-        glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+        RenderState::BindVertexArray(quadVAO);
+        RenderState::BindBuffer(GL_ARRAY_BUFFER, quadVBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
         glEnableVertexAttribArray(0);
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
@@ -221,159 +429,122 @@ namespace ARIS
         glGenVertexArrays(1, &cubeVAO);
         glGenBuffers(1, &cubeVBO);
         // fill buffer
-        glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+        RenderState::BindBuffer(GL_ARRAY_BUFFER, cubeVBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
         // link vertex attributes
-        glBindVertexArray(cubeVAO);
+        RenderState::BindVertexArray(cubeVAO);
         glEnableVertexAttribArray(0);
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
         glEnableVertexAttribArray(1);
         glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
         glEnableVertexAttribArray(2);
         glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
+        RenderState::BindBuffer(GL_ARRAY_BUFFER, 0);
+        RenderState::BindVertexArray(0);
     }
 
     void Scene::GenerateIBL()
     {
-        // IBL
-        hdrMapping = new Shader(false, "IBL/CubemapHDR.vert", "IBL/CubemapHDR.frag");
-        hdrEnvironment = new Shader(false, "IBL/Environment.vert", "IBL/Environment.frag");
-        irradiance = new Shader(false, "IBL/CubemapHDR.vert", "IBL/IrradianceConvolution.frag");
-        mapFilter = new Shader(true, "IBL/CubemapHDR.vert", "IBL/MapFilter.frag", nullptr, "IBL/FormulasIBL.gh");
-        brdf = new Shader(true, "IBL/BRDF.vert", "IBL/BRDF.frag", nullptr, "IBL/FormulasIBL.gh");
+        // shaders are built once; a reload only re-bakes the maps
+        if (!hdrMapping)
+        {
+            hdrMapping = new Shader(false, "IBL/EquirectToCube.cmpt");
+            hdrEnvironment = new Shader(false, "IBL/Environment.vert", "IBL/Environment.frag");
 
-        lightingPass = new Shader(true, "IBL/LightingPassPBR_New.vert", "IBL/LightingPassPBR_New.frag", nullptr, "IBL/FormulasIBL.gh");
+            mapFilter = new Shader();
+            mapFilter->GenerateCompute(true, "IBL/MapFilter.cmpt", "IBL/FormulasIBL.gh");
 
-        hdrTexture = new Texture("Content/Assets/Textures/HDR/" + currEnvMap + ".hdr", GL_LINEAR, GL_CLAMP_TO_EDGE, true);
+            brdf = new Shader();
+            brdf->GenerateCompute(true, "IBL/BRDF.cmpt", "IBL/FormulasIBL.gh");
 
-        hdrCubemap = new Texture();
-        hdrCubemap->AllocateCubemap(2048, 2048, GL_RGBA, GL_RGBA, GL_LINEAR, GL_CLAMP_TO_EDGE, GL_FLOAT, true);
+            lightingPass = new Shader(true, "IBL/LightingPassPBR_New.vert", "IBL/LightingPassPBR_New.frag", nullptr, "IBL/FormulasIBL.gh");
+        }
 
-        irradianceTex = new Texture();
-        irradianceTex->AllocateCubemap(32, 32, GL_RGBA, GL_RGBA, GL_LINEAR, GL_CLAMP_TO_EDGE, GL_FLOAT);
+        // release the previous environment's maps
+        for (Texture* tex : { hdrTexture, hdrCubemap, filteredHDR, brdfTex })
+        {
+            if (tex)
+            {
+                tex->Cleanup();
+                delete tex;
+            }
+        }
 
-        filteredHDR = new Texture();
-        filteredHDR->AllocateCubemap(2048, 2048, GL_RGBA, GL_RGBA, GL_LINEAR, GL_CLAMP_TO_EDGE, GL_FLOAT, true);
-
-        brdfTex = new Texture(2048, 2048, GL_RG16F, GL_RG, nullptr, GL_LINEAR, GL_CLAMP_TO_EDGE, GL_FLOAT);
-
-        // capture frame buffer (for irradiance mapping, pre-filtered color mapping)
-        captureBuffer = new Framebuffer(true);
-        captureBuffer->Bind(true);
-        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 2048, 2048);
-        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, captureBuffer->GetRBO());
-        captureBuffer->Unbind(true);
-
-        glm::mat4 hdrProj = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 10.0f);
-        glm::mat4 hdrView[] =
-        {
-            glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.0f,  0.0f,  0.0f), glm::vec3(0.0f, -1.0f,  0.0f)),
-            glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(-1.0f,  0.0f,  0.0f), glm::vec3(0.0f, -1.0f,  0.0f)),
-            glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f,  1.0f,  0.0f), glm::vec3(0.0f,  0.0f,  1.0f)),
-            glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f,  0.0f), glm::vec3(0.0f,  0.0f, -1.0f)),
-            glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f,  0.0f,  1.0f), glm::vec3(0.0f, -1.0f,  0.0f)),
-            glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f,  0.0f, -1.0f), glm::vec3(0.0f, -1.0f,  0.0f))
-        };
+        const IBLSettings& settings = m_IBLSettings;
+        auto groups = [](uint32_t size, uint32_t local) { return (size + local - 1) / local; };
 
-        // Draw the HDR cubemap first...
-        hdrMapping->Activate();
-        hdrMapping->SetInt("hdrMap", 0);
-        hdrMapping->SetMat4("projection", hdrProj);
+        Timer timer;
 
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, hdrTexture->m_ID);
-        glViewport(0, 0, 2048, 2048);
+        std::string envPath = "Content/Assets/Textures/HDR/" + currEnvMap + ".hdr";
+        m_EnvImage = Texture::Decode(envPath, true);
+        hdrTexture = new Texture(m_EnvImage, envPath, GL_LINEAR, GL_CLAMP_TO_EDGE);
 
-        captureBuffer->Bind();
+        hdrCubemap = new Texture();
+        hdrCubemap->AllocateCubemap(settings.s_EnvironmentSize, settings.s_EnvironmentSize, GL_RGBA16F, GL_RGBA,
+            GL_LINEAR, GL_CLAMP_TO_EDGE, GL_FLOAT, true);
 
-        for (unsigned i = 0; i < 6; ++i)
-        {
-            hdrMapping->SetMat4("view", hdrView[i]);
-            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, hdrCubemap->m_ID, 0);
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        filteredHDR = new Texture();
+        filteredHDR->AllocateCubemap(settings.s_PrefilterSize, settings.s_PrefilterSize, GL_RGBA16F, GL_RGBA,
+            GL_LINEAR, GL_CLAMP_TO_EDGE, GL_FLOAT, true);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, settings.s_PrefilterLevels - 1);
 
-            glBindVertexArray(cubeVAO);
-            glDrawArrays(GL_TRIANGLES, 0, 36);
-            glBindVertexArray(0);
-        }
-        captureBuffer->Unbind();
+        brdfTex = new Texture(settings.s_BRDFSize, settings.s_BRDFSize, GL_RG16F, GL_RG, nullptr, GL_LINEAR, GL_CLAMP_TO_EDGE, GL_FLOAT);
 
-        // .. then bind the created cubemap for the irradiance and pre-filtered map generation...
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, hdrCubemap->m_ID);
-        glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+        // Map the HDR onto the cubemap first, all six faces (z) per dispatch...
+        hdrMapping->Activate();
 
-        // ... then create the irradiance map...
-        captureBuffer->Bind(true);
-        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 32, 32);
+        RenderState::ActiveTexture(0);
+        RenderState::BindTexture(GL_TEXTURE_2D, hdrTexture->m_ID);
+        glBindImageTexture(0, hdrCubemap->m_ID, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA16F);
 
-        irradiance->Activate();
-        irradiance->SetIntDirect("envMap", 0);
-        irradiance->SetMat4("projection", hdrProj);
+        glDispatchCompute(groups(settings.s_EnvironmentSize, 16), groups(settings.s_EnvironmentSize, 16), 6);
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
 
-        glViewport(0, 0, 32, 32);
+        // .. then build its mips, which the filtering below samples...
+        RenderState::BindTexture(GL_TEXTURE_CUBE_MAP, hdrCubemap->m_ID);
+        glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
 
-        for (unsigned i = 0; i < 6; ++i)
+        // ... and only bake the specular maps if there's no valid cache for this environment
+        m_IBLFromCache = useIBLCache && IBLCache::Load(envPath, settings, *filteredHDR, *brdfTex);
+        if (!m_IBLFromCache)
         {
-            irradiance->SetMat4("view", hdrView[i]);
-            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, irradianceTex->m_ID, 0);
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            RenderState::ActiveTexture(0);
+            RenderState::BindTexture(GL_TEXTURE_CUBE_MAP, hdrCubemap->m_ID);
 
-            glBindVertexArray(cubeVAO);
-            glDrawArrays(GL_TRIANGLES, 0, 36);
-            glBindVertexArray(0);
-        }
-        captureBuffer->Unbind(true);
+            // the pre-filtered mip levels, one dispatch each...
+            mapFilter->Activate();
+            mapFilter->SetInt("sampleCount", static_cast<int>(settings.s_PrefilterSamples));
 
-        // ... then create the pre-filtered cubemap + mipmap levels...
-        mapFilter->Activate();
-        mapFilter->SetIntDirect("envMap", 0);
-        mapFilter->SetMat4("projection", hdrProj);
+            for (uint32_t mip = 0; mip < settings.s_PrefilterLevels; ++mip)
+            {
+                uint32_t size = settings.s_PrefilterSize >> mip;
 
-        captureBuffer->Bind();
+                float roughness = static_cast<float>(mip) / static_cast<float>(settings.s_PrefilterLevels - 1);
+                mapFilter->SetFloat("roughness", roughness);
+                glBindImageTexture(0, filteredHDR->m_ID, mip, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA16F);
 
-        unsigned maxMipLevels = 7;
-        for (unsigned mip = 0; mip < maxMipLevels; ++mip)
-        {
-            unsigned w = static_cast<unsigned>(2048 * std::pow(0.5, mip));
-            unsigned h = static_cast<unsigned>(2048 * std::pow(0.5, mip));
+                glDispatchCompute(groups(size, 8), groups(size, 8), 6);
+            }
 
-            glBindRenderbuffer(GL_RENDERBUFFER, captureBuffer->GetRBO());
-            glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, w, h);
-            glViewport(0, 0, w, h);
+            // ... and the BRDF lookup table
+            brdf->Activate();
+            brdf->SetInt("sampleCount", static_cast<int>(settings.s_BRDFSamples));
+            glBindImageTexture(0, brdfTex->m_ID, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RG16F);
 
-            float roughness = static_cast<float>(mip) / static_cast<float>(maxMipLevels - 1);
-            mapFilter->SetFloat("roughness", roughness);
+            glDispatchCompute(groups(settings.s_BRDFSize, 16), groups(settings.s_BRDFSize, 16), 1);
+            glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
 
-            for (unsigned i = 0; i < 6; ++i)
+            if (useIBLCache)
             {
-                mapFilter->SetMat4("view", hdrView[i]);
-                glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, filteredHDR->m_ID, mip);
-                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-                glBindVertexArray(cubeVAO);
-                glDrawArrays(GL_TRIANGLES, 0, 36);
-                glBindVertexArray(0);
+                IBLCache::Save(envPath, settings, *filteredHDR, *brdfTex);
             }
         }
-        captureBuffer->Unbind();
-
-        // ... then create the BRDF lookup table
-        captureBuffer->Bind(true);
-        brdfTex->Bind();
 
-        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 2048, 2048);
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, brdfTex->m_ID, 0);
+        RenderState::UseProgram(0);
 
-        glViewport(0, 0, 2048, 2048);
-        brdf->Activate();
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        RenderQuad();
-
-        brdfTex->Unbind();
-        captureBuffer->Unbind(true);
+        // wait on the GPU so the time covers the whole bake (or cache upload)
+        glFinish();
+        m_IBLBakeMs = timer.ElapsedMillis();
 
         hammersleyData->GetData().N = 20;
         
@@ -397,61 +568,380 @@ namespace ARIS
         }
         
         hammersleyData->SetData();
+
+        // diffuse irradiance comes from SH, evaluated per pixel in the lighting pass
+        GenerateSphereHarmonics();
     }
 
     void Scene::GenerateSphereHarmonics()
     {
-        SH9Color coeffs = SphereHarmonics::GenerateLightingCoefficients(*hdrTexture);
+        Timer timer;
 
-        outputIrradiance = new Texture();
-        outputIrradiance->AllocateCubemap(2048, 2048, GL_RGBA, GL_RGBA, GL_LINEAR, GL_CLAMP_TO_EDGE, GL_FLOAT);
+        SH9Color coeffs;
+        if (shFromCubemap)
+        {
+            // project a low mip of the captured cubemap instead of the equirect source
+            const int level = 3;
+            const int size = static_cast<int>(m_IBLSettings.s_EnvironmentSize) >> level;
 
-        outputIrrTex = new Texture("Content/Assets/Textures/HDR/output.hdr", GL_LINEAR, GL_CLAMP_TO_EDGE, true);
+            std::vector<float> faces[6];
+            const float* facePtrs[6];
 
-        glm::mat4 hdrProj = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 10.0f);
-        glm::mat4 hdrView[] =
+            RenderState::ActiveTexture(0);
+            RenderState::BindTexture(GL_TEXTURE_CUBE_MAP, hdrCubemap->m_ID);
+            for (unsigned i = 0; i < 6; ++i)
+            {
+                faces[i].resize(static_cast<size_t>(size) * size * 3);
+                glGetTexImage(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, level, GL_RGB, GL_FLOAT, faces[i].data());
+                facePtrs[i] = faces[i].data();
+            }
+
+            coeffs = SphereHarmonics::GenerateLightingCoefficients(SphereHarmonics::ProjectCubemap(facePtrs, size, 3));
+        }
+        else
         {
-            glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.0f,  0.0f,  0.0f), glm::vec3(0.0f, -1.0f,  0.0f)),
-            glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(-1.0f,  0.0f,  0.0f), glm::vec3(0.0f, -1.0f,  0.0f)),
-            glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f,  1.0f,  0.0f), glm::vec3(0.0f,  0.0f,  1.0f)),
-            glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f,  0.0f), glm::vec3(0.0f,  0.0f, -1.0f)),
-            glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f,  0.0f,  1.0f), glm::vec3(0.0f, -1.0f,  0.0f)),
-            glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f,  0.0f, -1.0f), glm::vec3(0.0f, -1.0f,  0.0f))
-        };
+            coeffs = SphereHarmonics::GenerateLightingCoefficients(m_EnvImage);
+        }
 
-        hdrMapping->Activate();
-        hdrMapping->SetInt("hdrMap", 0);
-        hdrMapping->SetMat4("projection", hdrProj);
+        // irradiance coefficients go straight to the lighting pass (binding 5)
+        for (int i = 0; i < 9; ++i)
+        {
+            harmonicData->GetData().shColor[i] = glm::vec4(coeffs.results[i], 0.0f);
+        }
+        harmonicData->SetData();
+
+        m_SHMs = timer.ElapsedMillis();
+    }
+
+    Scene::~Scene()
+    {
+        m_Registry.on_construct<MeshComponent>().disconnect(this);
+        m_Registry.on_destroy<MeshComponent>().disconnect(this);
+
+        AssetLoader::Get().Cancel(this);
+
+        CleanUp();
+    }
 
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, outputIrrTex->m_ID);
-        glViewport(0, 0, 2048, 2048);
+    void Scene::AssignModel(entt::entity e, Model* model)
+    {
+        if (!m_Registry.valid(e) || !m_Registry.all_of<MeshComponent>(e))
+        {
+            delete model;
+            return;
+        }
 
-        captureBuffer->Bind();
+        MeshComponent& mesh = m_Registry.get<MeshComponent>(e);
 
-        for (unsigned i = 0; i < 6; ++i)
+        // the name was set on the placeholder (released by SetModel)
+        if (Model* placeholder = mesh.GetModel())
         {
-            hdrMapping->SetMat4("view", hdrView[i]);
-            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, outputIrradiance->m_ID, 0);
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            model->SetName(placeholder->GetName());
+        }
+        mesh.SetModel(model);
+
+        // new bounds are picked up with the next transform update
+        m_Registry.get<TransformComponent>(e).MarkDirty();
+    }
+
+    void Scene::AssignTexture(entt::entity e, std::shared_ptr<Texture> tex)
+    {
+        // a dropped handle just leaves the entry for TextureCache::EvictUnused
+        if (!m_Registry.valid(e) || !m_Registry.all_of<MeshComponent>(e))
+            return;
+
+        m_Registry.get<MeshComponent>(e).SetTexture(tex->type, tex);
+    }
+
+    void Scene::OnMeshConstructed(entt::registry& registry, entt::entity e)
+    {
+        // routes the new mesh through the changed-transform list so its bounds get built
+        registry.get<TransformComponent>(e).MarkDirty();
+    }
+
+    void Scene::OnMeshDestroyed(entt::registry& registry, entt::entity e)
+    {
+        MeshComponent& mesh = registry.get<MeshComponent>(e);
+        m_BVH.Remove(mesh.GetBVHProxy());
+        mesh.SetBVHProxy(BVH::Null);
+
+        // drop the model's texture handles now so the cache can evict them
+        mesh.SetModel(nullptr);
+    }
 
-            glBindVertexArray(cubeVAO);
-            glDrawArrays(GL_TRIANGLES, 0, 36);
-            glBindVertexArray(0);
+    void Scene::UpdateTransforms()
+    {
+        // Point light volumes are scaled to the light's range (no-op unless it changed)
+        auto lights = m_Registry.view<TransformComponent, PointLightComponent>();
+        for (auto entity : lights)
+        {
+            auto [transform, light] = lights.get<TransformComponent, PointLightComponent>(entity);
+            transform.Scale(glm::vec3(light.GetRange()));
         }
-        captureBuffer->Unbind();
+
+        // World matrices + mesh bounds, in parallel over the transform storage
+        m_TransformSystem.Update(m_Registry);
     }
 
-    Scene::~Scene()
+    void Scene::UpdateBVH()
     {
-        CleanUp();
+        // Only entities whose world transform changed this frame touch the tree
+        // (their bounds were recomputed by the transform system)
+        for (entt::entity entity : m_TransformSystem.GetChanged())
+        {
+            MeshComponent* mesh = m_Registry.try_get<MeshComponent>(entity);
+            if (!mesh || mesh->GetWorldBounds().empty())
+                continue;
+
+            if (mesh->GetBVHProxy() == BVH::Null)
+                mesh->SetBVHProxy(m_BVH.Insert(mesh->GetEntityBounds(), static_cast<uint32_t>(entity)));
+            else
+                m_BVH.Update(mesh->GetBVHProxy(), mesh->GetEntityBounds());
+        }
+
+        // Refits only grow boxes in place; restructure once they add up
+        if (m_BVH.GetRefitCount() > m_BVH.GetLeafCount())
+        {
+            m_BVH.Rebuild();
+        }
+    }
+
+    void Scene::RenderShadows(EditorCamera& editorCam)
+    {
+        m_ShadowTimer.Begin();
+
+        // A caster counts as static once it has stayed put for this many frames
+        const uint32_t settleFrames = 30;
+
+        ++m_ShadowFrame;
+        for (entt::entity entity : m_TransformSystem.GetChanged())
+        {
+            m_MovingCasters[static_cast<uint32_t>(entity)] = m_ShadowFrame;
+        }
+
+        for (auto it = m_MovingCasters.begin(); it != m_MovingCasters.end();)
+        {
+            it = m_ShadowFrame - it->second > settleFrames ? m_MovingCasters.erase(it) : std::next(it);
+        }
+
+        m_ShadowStats = ShadowStats();
+
+        // IMPORTANT TO DO THIS: Color will blend with BG if this is anything else but vec4(0)
+        glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+        sBuffer->Bind();
+        sBuffer->SetViewport();
+
+        RenderState::CullFace(GL_FRONT);
+
+        const GLsizei res = static_cast<GLsizei>(sDepthMap->m_Width);
+        const GLint scratch = ShadowCascades::MaxCascades;
+
+        // The lighting pass has one set of cascades, so only the first
+        // directional light casts shadows
+        auto v = m_Registry.view<TransformComponent, DirectionLightComponent>();
+        for (auto entity : v)
+        {
+            auto [transform, light] = v.get<TransformComponent, DirectionLightComponent>(entity);
+
+            // Update light matrices (transforms were resolved in UpdateTransforms)
+            light.Update(transform.GetWorldTranslation(), transform.GetRotation());
+
+            m_Cascades.Update(m_CascadeSettings, transform.Forward(), editorCam.GetViewMatrix(),
+                editorCam.GetProjection(), editorCam.GetNearClip(), m_BVH.GetRootBounds());
+
+            shadowPass->Activate();
+            shadowPass->SetFloat("nearP", light.GetNear());
+            shadowPass->SetFloat("farP", light.GetFar());
+            shadowPass->SetFloat("usePersp", false);
+            shadowPass->SetMat4("view", m_Cascades.GetLightView());
+
+            for (uint32_t c = 0; c < m_Cascades.GetCount(); ++c)
+            {
+                glm::mat4 viewProj = m_Cascades.GetViewProjection(c);
+                Frustum lightFrustum(viewProj);
+
+                // Casters in the cascade's box (the BVH was refit in the G-Buffer pass)
+                if (useFrustumCulling)
+                {
+                    m_BVH.QueryFrustum(lightFrustum, m_QueryResults);
+                }
+                else
+                {
+                    auto obj = m_Registry.view<TransformComponent, MeshComponent>();
+                    for (auto e : obj)
+                    {
+                        m_QueryResults.push_back(static_cast<uint32_t>(e));
+                    }
+                }
+
+                m_StaticCasters.clear();
+                m_DynamicCasters.clear();
+
+                for (uint32_t id : m_QueryResults)
+                {
+                    if (useShadowCache && m_MovingCasters.count(id))
+                        m_DynamicCasters.push_back(id);
+                    else
+                        m_StaticCasters.push_back(id);
+                }
+                m_QueryResults.clear();
+
+                // The query order follows the tree, which rebuilds can shuffle
+                std::sort(m_StaticCasters.begin(), m_StaticCasters.end());
+
+                size_t signature = 0;
+                for (uint32_t id : m_StaticCasters)
+                {
+                    const MeshComponent& mesh = m_Registry.get<MeshComponent>(static_cast<entt::entity>(id));
+                    HashCombine(signature, id, mesh.GetModel());
+                }
+
+                ShadowCache& cache = m_ShadowCache[c];
+                bool staticDirty = !useShadowCache || !cache.s_Valid
+                    || cache.s_ViewProj != viewProj || cache.s_Signature != signature;
+
+                // Nothing moved in or out of this cascade: last frame's moments still hold
+                if (!staticDirty && m_DynamicCasters.empty() && !cache.s_HadDynamic)
+                {
+                    ++m_ShadowStats.s_Reused;
+                    continue;
+                }
+
+                shadowPass->SetMat4("projection", m_Cascades.GetProjection(c));
+
+                // Nothing to keep in the static layer (cache off, or no static casters here):
+                // draw straight into the cascade and skip the layer copy
+                if (!useShadowCache || m_StaticCasters.empty())
+                {
+                    sBuffer->AttachTextureLayer(GL_COLOR_ATTACHMENT0, *sDepthMap, c);
+                    sBuffer->AttachTextureLayer(GL_DEPTH_ATTACHMENT, *sShadowDepth, c);
+                    sBuffer->Clear();
+
+                    if (!m_StaticCasters.empty())
+                        DrawShadowCasters(m_StaticCasters, lightFrustum);
+
+                    if (!m_DynamicCasters.empty())
+                        DrawShadowCasters(m_DynamicCasters, lightFrustum);
+
+                    // an empty static set is still a valid cache; with the cache off the
+                    // static layer went stale, so turning it back on re-renders it
+                    cache.s_ViewProj = viewProj;
+                    cache.s_Signature = signature;
+                    cache.s_Valid = useShadowCache;
+                    cache.s_HadDynamic = !m_DynamicCasters.empty();
+                    m_ShadowBlurDirty[c] = true;
+
+                    if (!useShadowCache)
+                        ++m_ShadowStats.s_Rendered;
+
+                    ++m_ShadowStats.s_Composed;
+                    continue;
+                }
+
+                if (staticDirty)
+                {
+                    sBuffer->AttachTextureLayer(GL_COLOR_ATTACHMENT0, *sStaticMoments, c);
+                    sBuffer->AttachTextureLayer(GL_DEPTH_ATTACHMENT, *sShadowDepth, c);
+                    sBuffer->Clear();
+
+                    DrawShadowCasters(m_StaticCasters, lightFrustum);
+
+                    cache.s_ViewProj = viewProj;
+                    cache.s_Signature = signature;
+                    cache.s_Valid = true;
+
+                    ++m_ShadowStats.s_Rendered;
+                }
+
+                // The cascade's moments = the static layer plus this frame's moving casters,
+                // depth tested against a copy of the static depth
+                glCopyImageSubData(sStaticMoments->m_ID, GL_TEXTURE_2D_ARRAY, 0, 0, 0, c,
+                    sDepthMap->m_ID, GL_TEXTURE_2D_ARRAY, 0, 0, 0, c, res, res, 1);
+
+                if (!m_DynamicCasters.empty())
+                {
+                    glCopyImageSubData(sShadowDepth->m_ID, GL_TEXTURE_2D_ARRAY, 0, 0, 0, c,
+                        sShadowDepth->m_ID, GL_TEXTURE_2D_ARRAY, 0, 0, 0, scratch, res, res, 1);
+
+                    sBuffer->AttachTextureLayer(GL_COLOR_ATTACHMENT0, *sDepthMap, c);
+                    sBuffer->AttachTextureLayer(GL_DEPTH_ATTACHMENT, *sShadowDepth, scratch);
+
+                    DrawShadowCasters(m_DynamicCasters, lightFrustum);
+                }
+
+                cache.s_HadDynamic = !m_DynamicCasters.empty();
+                m_ShadowBlurDirty[c] = true;
+
+                ++m_ShadowStats.s_Composed;
+            }
+
+            break;
+        }
+
+        sBuffer->Unbind();
+
+        m_ShadowTimer.End();
+    }
+
+    void Scene::DrawShadowCasters(const std::vector<uint32_t>& entities, const Frustum& frustum)
+    {
+        m_ShadowBatcher.Begin(RenderPass::Shadow, m_Cascades.GetLightView());
+
+        for (uint32_t id : entities)
+        {
+            entt::entity entity = static_cast<entt::entity>(id);
+            auto [objTr, mesh] = m_Registry.get<TransformComponent, MeshComponent>(entity);
+
+            m_ShadowBatcher.Submit(mesh, objTr.GetTransform(), (int)entity, useFrustumCulling ? &frustum : nullptr);
+        }
+
+        m_ShadowBatcher.Draw(*shadowPass, false);
+
+        m_CullStats.s_ShadowEntities += static_cast<unsigned>(entities.size());
+        m_CullStats.s_ShadowVisible += m_ShadowBatcher.GetVisibleCount();
+        m_CullStats.s_ShadowCulled += m_ShadowBatcher.GetCulledCount();
+    }
+
+    void Scene::RequestTextureResidency(const MeshComponent& mesh, const glm::vec3& eye, float pixelScale)
+    {
+        Model* model = mesh.GetModel();
+        if (!model)
+            return;
+
+        const std::vector<Mesh>& meshes = model->GetMeshes();
+        const std::vector<BoundingBox>& bounds = mesh.GetWorldBounds();
+
+        // projected diameter of each mesh's bounding sphere, measured at its nearest point
+        float largest = 0.0f;
+        for (size_t i = 0; i < meshes.size() && i < bounds.size(); ++i)
+        {
+            glm::vec3 center = (bounds[i].s_Min + bounds[i].s_Max) * 0.5f;
+            float radius = glm::length(bounds[i].s_Max - bounds[i].s_Min) * 0.5f;
+            float distance = std::max(glm::length(center - eye) - radius, 0.1f);
+
+            float pixels = radius * pixelScale / distance;
+            largest = std::max(largest, pixels);
+
+            for (const Texture& t : meshes[i].GetTextures())
+            {
+                TextureCache::Get().RequestResidency(t.m_ID, pixels);
+            }
+        }
+
+        for (Texture* t : mesh.GetOverrides())
+        {
+            TextureCache::Get().RequestResidency(t->m_ID, largest);
+        }
     }
 
     int Scene::Init()
     {
-        glEnable(GL_DEPTH_TEST);
-        glDepthFunc(GL_LEQUAL);
-        glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+        m_Registry.on_construct<MeshComponent>().connect<&Scene::OnMeshConstructed>(this);
+        m_Registry.on_destroy<MeshComponent>().connect<&Scene::OnMeshDestroyed>(this);
+
+        RenderState::Enable(GL_DEPTH_TEST);
+        RenderState::DepthFunc(GL_LEQUAL);
+        RenderState::Enable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
 
         geometryPass = new Shader(false, "Deferred/GeometryPass.vert", "Deferred/GeometryPass.frag");
 
@@ -464,31 +954,39 @@ namespace ARIS
         aoBlurX = new Shader(false, "AO/BilateralBlurX.cmpt");
         aoBlurY = new Shader(false, "AO/BilateralBlurY.cmpt");
 
-        // gBuffer textures (position, normals, albedo (diffuse), metallic/roughness)
-        std::string names[4] = { "GPosition", "GNormals", "GAlbedo", "GAMR" };
+        m_LightClusters.Init();
 
-        for (unsigned i = 0; i < 4; ++i)
-        {
-            gTextures.push_back(new Texture(_windowWidth, _windowHeight, GL_RGBA16F, GL_RGBA, nullptr,
-                GL_NEAREST, GL_CLAMP_TO_EDGE));
-            m_DisplayTextures[names[i]] = gTextures[i];
-        }
+        // gBuffer textures, in GBufferTarget order (18 bytes a pixel with depth)
+        // octahedral normals
+        gTextures.push_back(new Texture(_windowWidth, _windowHeight, GL_RG16, GL_RG, nullptr,
+            GL_NEAREST, GL_CLAMP_TO_EDGE, GL_UNSIGNED_SHORT));
+        m_DisplayTextures["GNormals"] = gTextures[GNormal];
+
+        // albedo (diffuse); written through GL_FRAMEBUFFER_SRGB
+        gTextures.push_back(new Texture(_windowWidth, _windowHeight, GL_SRGB8_ALPHA8, GL_RGBA, nullptr,
+            GL_NEAREST, GL_CLAMP_TO_EDGE));
+        m_DisplayTextures["GAlbedo"] = gTextures[GAlbedo];
 
-        // Single-channel red texture (for entity ID and mouse-clicking; this will be
-        // shared with the scene FBO)
-        gTextures.push_back(new Texture(_windowWidth, _windowHeight, GL_R32F, GL_RED, nullptr,
-            GL_NEAREST, GL_CLAMP_TO_BORDER, GL_UNSIGNED_BYTE));
-        m_DisplayTextures["EntityID"] = gTextures[4];
+        // metallic/roughness
+        gTextures.push_back(new Texture(_windowWidth, _windowHeight, GL_RG8, GL_RG, nullptr,
+            GL_NEAREST, GL_CLAMP_TO_EDGE));
+        m_DisplayTextures["GAMR"] = gTextures[GMetalRough];
 
-        // gBuffer depth texture
+        // entity ID for mouse-clicking; the lighting pass copies it to the scene FBO
+        gTextures.push_back(new Texture(_windowWidth, _windowHeight, GL_R32UI, GL_RED_INTEGER, nullptr,
+            GL_NEAREST, GL_CLAMP_TO_EDGE, GL_UNSIGNED_INT));
+
+        // gBuffer depth texture; world positions are reconstructed from it
         gTextures.push_back(new Texture(_windowWidth, _windowHeight, GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, nullptr,
             GL_NEAREST, GL_REPEAT, GL_FLOAT));
-        m_DisplayTextures["GDepth"] = gTextures[5];
+        m_DisplayTextures["GDepth"] = gTextures[GDepth];
+
+        // shadow map (moments), one layer per cascade
+        const uint32_t shadowRes = m_CascadeSettings.s_Resolution;
 
-        // shadow map
-        sDepthMap = new Texture(2048, 2048, GL_RGBA32F, GL_RGBA, nullptr,
-            GL_NEAREST, GL_CLAMP_TO_BORDER, GL_UNSIGNED_BYTE);
-        m_DisplayTextures["ShadowMap"] = sDepthMap;
+        sDepthMap = new Texture();
+        sDepthMap->AllocateArray(shadowRes, shadowRes, ShadowCascades::MaxCascades, GL_RGBA32F, GL_RGBA,
+            GL_NEAREST, GL_CLAMP_TO_EDGE, GL_FLOAT);
 
         // AO map
         aoMap = new Texture(_windowWidth, _windowHeight, GL_RGBA16F, GL_RGBA, nullptr, GL_NEAREST, GL_CLAMP_TO_EDGE);
@@ -502,23 +1000,30 @@ namespace ARIS
         m_DisplayTextures["AoBlurXY"] = aoBlurOutputXY;
 
         // filtered shadow map
-        blurOutput = new Texture(2048, 2048, GL_RGBA32F, GL_RGBA, nullptr,
-            GL_NEAREST, GL_CLAMP_TO_BORDER, GL_FLOAT);
-        m_DisplayTextures["ShadowBlur"] = blurOutput;
+        blurOutput = new Texture();
+        blurOutput->AllocateArray(shadowRes, shadowRes, ShadowCascades::MaxCascades, GL_RGBA32F, GL_RGBA,
+            GL_NEAREST, GL_CLAMP_TO_EDGE, GL_FLOAT);
+
+        // cached static casters, and shadow depth (one layer per cascade + a scratch layer)
+        sStaticMoments = new Texture();
+        sStaticMoments->AllocateArray(shadowRes, shadowRes, ShadowCascades::MaxCascades, GL_RGBA32F, GL_RGBA,
+            GL_NEAREST, GL_CLAMP_TO_EDGE, GL_FLOAT);
+
+        sShadowDepth = new Texture();
+        sShadowDepth->AllocateArray(shadowRes, shadowRes, ShadowCascades::MaxCascades + 1, GL_DEPTH_COMPONENT32F,
+            GL_DEPTH_COMPONENT, GL_NEAREST, GL_CLAMP_TO_EDGE, GL_FLOAT);
 
         // gBuffer FBO
         gBuffer = new Framebuffer(_windowWidth, _windowHeight, GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         gBuffer->Bind();
 
-        unsigned texes = 0;
-        for (texes = 0; texes < gTextures.size() - 2; ++texes)
+        for (unsigned texes = 0; texes < GDepth; ++texes)
         {
             gBuffer->AttachTexture(GL_COLOR_ATTACHMENT0 + texes, *gTextures[texes]);
         }
-        gBuffer->AttachTexture(GL_COLOR_ATTACHMENT0 + texes, *gTextures[gTextures.size() - 2]);
         gBuffer->DrawBuffers();
         
-        gBuffer->AttachTexture(GL_DEPTH_ATTACHMENT, *gTextures[gTextures.size() - 1]);
+        gBuffer->AttachTexture(GL_DEPTH_ATTACHMENT, *gTextures[GDepth]);
 
         gBuffer->Unbind();
 
@@ -531,7 +1036,7 @@ namespace ARIS
 
         m_SceneFBO->Bind();
         m_SceneFBO->AllocateAttachTexture(GL_COLOR_ATTACHMENT0, GL_RGBA32F, GL_RGBA, GL_UNSIGNED_BYTE);
-        m_SceneFBO->AllocateAttachTexture(GL_COLOR_ATTACHMENT1, GL_R32F, GL_RED, GL_UNSIGNED_BYTE);
+        m_SceneFBO->AllocateAttachTexture(GL_COLOR_ATTACHMENT1, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT);
         //m_SceneFBO->AttachTexture(GL_COLOR_ATTACHMENT1, *gTextures[gTextures.size() - 2]);
         m_SceneFBO->DrawBuffers();
         m_SceneFBO->AllocateAttachTexture(GL_DEPTH_ATTACHMENT, GL_DEPTH_COMPONENT, GL_DEPTH_COMPONENT, GL_FLOAT);
@@ -546,14 +1051,15 @@ namespace ARIS
         m_SceneFBO->Unbind();
 
         // Shadow FBO 
-        sBuffer = new Framebuffer(2048, 2048, GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        sBuffer = new Framebuffer(shadowRes, shadowRes, GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         m_Framebuffers["ShadowFBO"] = sBuffer;
 
         sBuffer->Bind();
 
-        sBuffer->AttachTexture(GL_COLOR_ATTACHMENT0, *sDepthMap);
+        // the shadow pass switches layers per cascade
+        sBuffer->AttachTextureLayer(GL_COLOR_ATTACHMENT0, *sDepthMap, 0);
         sBuffer->DrawBuffers();
-        sBuffer->AllocateAttachTexture(GL_DEPTH_ATTACHMENT, GL_DEPTH_COMPONENT, GL_DEPTH_COMPONENT, GL_FLOAT);
+        sBuffer->AttachTextureLayer(GL_DEPTH_ATTACHMENT, *sShadowDepth, 0);
 
         if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
         {
@@ -591,26 +1097,26 @@ namespace ARIS
     int Scene::PreRender()
     {
         lightingPass->Activate();
-        lightingPass->SetInt("gPos", 0);
-        lightingPass->SetInt("gNorm", 1);
-        lightingPass->SetInt("gAlbedo", 2);
-        lightingPass->SetInt("gMetRough", 3);
-        lightingPass->SetInt("gEntityID", 4);
-        lightingPass->SetInt("gDepth", 5);
+        lightingPass->SetInt("gNorm", GNormal);
+        lightingPass->SetInt("gAlbedo", GAlbedo);
+        lightingPass->SetInt("gMetRough", GMetalRough);
+        lightingPass->SetInt("gEntityID", GEntityID);
+        lightingPass->SetInt("gDepth", GDepth);
 
         shadowPass->Activate();
         shadowPass->SetInt("sDepth", 0);
 
         aoPass->Activate();
-        aoPass->SetInt("gPos", 0);
-        aoPass->SetInt("gNorm", 1);
-        aoPass->SetInt("gDepth", 2);
+        aoPass->SetInt("gNorm", 0);
+        aoPass->SetInt("gDepth", 1);
 
         return 0;
     }
 
     int Scene::RenderEditor(EditorCamera& editorCam)
     {
+        RenderState::BeginFrame();
+
         int sceneWidth = m_SceneFBO->GetSpecs().s_Width;
         int sceneHeight = m_SceneFBO->GetSpecs().s_Height;
 
@@ -618,81 +1124,100 @@ namespace ARIS
         glClearColor(0.1f, 1.0f, 0.5f, 1.0f);
         gBuffer->Activate();
 
-        gBuffer->ClearAttachment(4, -1.0f, GL_FLOAT);
-
-        glEnable(GL_CULL_FACE);
-        glCullFace(GL_BACK);
-        glEnable(GL_DEPTH_TEST);
-        glDisable(GL_BLEND);
+        gBuffer->ClearAttachment(GEntityID, 0xFFFFFFFFu);
 
-        // For all meshes...
-        auto obj = m_Registry.view<TransformComponent, MeshComponent>();
-        for (auto entity : obj)
-        {
-            auto [objTr, mesh] = obj.get<TransformComponent, MeshComponent>(entity);
+        RenderState::Enable(GL_CULL_FACE);
+        RenderState::CullFace(GL_BACK);
+        RenderState::Enable(GL_DEPTH_TEST);
+        RenderState::Disable(GL_BLEND);
 
-            geometryPass->Activate();
-            geometryPass->SetFloat("metalVal", mesh.GetMetalness());
-            geometryPass->SetFloat("roughVal", mesh.GetRoughness());
+        // Resolve moved transforms once for the whole frame
+        UpdateTransforms();
 
-            geometryPass->SetBool("controllable", mesh.GetControllableMetRough());
-            glUseProgram(0);
+        // For all meshes...
+        UpdateBVH();
 
-            // Update and render them normally
-            objTr.Update();
-            mesh.Update(objTr.GetTransform());
+        m_Batcher.Begin(RenderPass::Geometry, editorCam.GetViewMatrix());
 
-            mesh.Draw(objTr.GetTransform(), editorCam.GetViewMatrix(), 
-                editorCam.GetProjection(), *geometryPass, false, (int)entity);
-        }
+        Frustum cameraFrustum(editorCam.GetViewProjection());
 
-        gBuffer->Unbind();
+        // positions are reconstructed from G-buffer depth with this
+        glm::mat4 invViewProj = glm::inverse(editorCam.GetViewProjection());
 
-        // Shadow Pass
-        // IMPORTANT TO DO THIS: Color will blend with BG if this is anything else but vec4(0)
-        glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
-        sBuffer->Activate();
-  
-        glCullFace(GL_FRONT);
+        glm::vec3 eye = editorCam.GetPosition();
+        float pixelScale = editorCam.GetProjection()[1][1] * static_cast<float>(_windowHeight);
 
-        // For all lights...
-        auto v = m_Registry.view<TransformComponent, DirectionLightComponent>();
-        for (auto entity : v)
+        // Cull whole entities through the BVH, then group the survivors'
+        // meshes by shared mesh + material
+        if (useFrustumCulling)
         {
-            auto [transform, light] = v.get<TransformComponent, DirectionLightComponent>(entity);
+            m_BVH.QueryFrustum(cameraFrustum, m_QueryResults);
 
-            // Update light matrices + transform
-            transform.Update();
-            light.Update(transform.GetTranslation(), transform.GetRotation());
+            for (uint32_t id : m_QueryResults)
+            {
+                entt::entity entity = static_cast<entt::entity>(id);
+                auto [objTr, mesh] = m_Registry.get<TransformComponent, MeshComponent>(entity);
 
-            shadowPass->Activate();
-            shadowPass->SetFloat("nearP", light.GetNear());
-            shadowPass->SetFloat("farP", light.GetFar());
-            shadowPass->SetFloat("usePersp", light.GetPerspectiveInUse());
-            glUseProgram(0);
+                m_Batcher.Submit(mesh, objTr.GetTransform(), (int)entity, &cameraFrustum);
+                RequestTextureResidency(mesh, eye, pixelScale);
+            }
 
-            // For all meshes...
+            m_CullStats.s_CameraEntities = static_cast<unsigned>(m_QueryResults.size());
+            m_QueryResults.clear();
+        }
+        else
+        {
             auto obj = m_Registry.view<TransformComponent, MeshComponent>();
             for (auto entity : obj)
             {
                 auto [objTr, mesh] = obj.get<TransformComponent, MeshComponent>(entity);
 
-                // Update and render them relative to the light
-                objTr.Update();
+                m_Batcher.Submit(mesh, objTr.GetTransform(), (int)entity);
+                RequestTextureResidency(mesh, eye, pixelScale);
+            }
+
+            m_CullStats.s_CameraEntities = m_BVH.GetLeafCount();
+        }
+
+        // raise/drop mip residency before the textures are sampled
+        TextureCache::Get().UpdateStreaming();
 
-                mesh.Draw(objTr.GetTransform(), light.GetViewMatrix(), light.GetProjectionMatrix(), *shadowPass, false);
+        if (ModelBuilder::Get().m_DisplayBoxes)
+        {
+            auto obj = m_Registry.view<MeshComponent>();
+            for (auto entity : obj)
+            {
+                obj.get<MeshComponent>(entity).DrawBoundingBoxes();
             }
         }
-        sBuffer->Unbind();
+
+        // ...and render each group with one instanced draw
+        geometryPass->Activate();
+        geometryPass->SetMat4("view", editorCam.GetViewMatrix());
+        geometryPass->SetMat4("projection", editorCam.GetProjection());
+
+        RenderState::Enable(GL_FRAMEBUFFER_SRGB);
+        m_Batcher.Draw(*geometryPass);
+        RenderState::Disable(GL_FRAMEBUFFER_SRGB);
+
+        m_CullStats.s_MaterialChanges = m_Batcher.GetMaterialChanges();
+        m_CullStats.s_CameraVisible = m_Batcher.GetVisibleCount();
+        m_CullStats.s_CameraCulled = m_Batcher.GetCulledCount();
+        m_CullStats.s_ShadowEntities = m_CullStats.s_ShadowVisible = m_CullStats.s_ShadowCulled = 0;
+
+        gBuffer->Unbind();
+
+        // Shadow Pass
+        RenderShadows(editorCam);
 
         // AO Pass
         glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
         aoBuffer->Activate();
 
-        glEnable(GL_CULL_FACE);
-        glCullFace(GL_BACK);
-        glEnable(GL_DEPTH_TEST);
-        glDisable(GL_BLEND);
+        RenderState::Enable(GL_CULL_FACE);
+        RenderState::CullFace(GL_BACK);
+        RenderState::Enable(GL_DEPTH_TEST);
+        RenderState::Disable(GL_BLEND);
 
         aoPass->Activate();
         aoPass->SetFloat("aoScale", aoScale);
@@ -703,13 +1228,12 @@ namespace ARIS
         // width/height of the texture, scale this later during lighting pass
         aoPass->SetInt("vWidth", 1600);
         aoPass->SetInt("vHeight", 900);
+        aoPass->SetMat4("invViewProj", invViewProj);
 
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, gTextures[0]->m_ID);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, gTextures[1]->m_ID);
-        glActiveTexture(GL_TEXTURE2);
-        glBindTexture(GL_TEXTURE_2D, gTextures[5]->m_ID);
+        RenderState::ActiveTexture(0);
+        RenderState::BindTexture(GL_TEXTURE_2D, gTextures[GNormal]->m_ID);
+        RenderState::ActiveTexture(1);
+        RenderState::BindTexture(GL_TEXTURE_2D, gTextures[GDepth]->m_ID);
 
         RenderQuad();
         aoBuffer->Unbind();
@@ -719,7 +1243,7 @@ namespace ARIS
         glClearColor(0.1f, 1.0f, 0.5f, 1.0f);
         m_SceneFBO->Activate();
 
-        m_SceneFBO->ClearAttachment(1, -1.0f, GL_FLOAT);
+        m_SceneFBO->ClearAttachment(1, 0xFFFFFFFFu);
         
         // Blur the shader using a convolution filter
         memset(kernelData->GetData().weights, 0, sizeof(glm::vec4) * 101);
@@ -760,19 +1284,30 @@ namespace ARIS
         computeBlur->Activate();
         computeBlur->SetInt("halfKernel", (kernelSize * kernelSize) / 2);
 
-        GLint srcLoc = glGetUniformLocation(computeBlur->m_ID, "src");
-        glBindImageTexture(0, sDepthMap->m_ID, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
-        glUniform1i(srcLoc, 0);
+        // src/dst are fixed to image units 0/1 by layout(binding) in the shader
 
-        GLint dstLoc = glGetUniformLocation(computeBlur->m_ID, "dst");
-        glBindImageTexture(1, blurOutput->m_ID, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
-        glUniform1i(dstLoc, 1);
+        // One cascade at a time; a non-layered binding exposes a single layer as an image2D.
+        // Cascades whose moments didn't change keep last frame's result
+        const GLuint shadowRes = sDepthMap->m_Width;
+        const bool kernelChanged = gaussianWeight != m_BlurredWeight;
+        m_BlurredWeight = gaussianWeight;
 
-        glDispatchCompute(2048 / 128, 2048, 1);
+        for (uint32_t c = 0; c < m_Cascades.GetCount(); ++c)
+        {
+            if (!m_ShadowBlurDirty[c] && !kernelChanged)
+                continue;
+
+            m_ShadowBlurDirty[c] = false;
+
+            glBindImageTexture(0, sDepthMap->m_ID, 0, GL_FALSE, c, GL_READ_ONLY, GL_RGBA32F);
+            glBindImageTexture(1, blurOutput->m_ID, 0, GL_FALSE, c, GL_WRITE_ONLY, GL_RGBA32F);
+
+            glDispatchCompute(shadowRes / 128, shadowRes, 1);
+        }
 
         glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
 
-        glUseProgram(0);
+        RenderState::UseProgram(0);
         // --------------
 
         // Run the AO compute shader
@@ -785,28 +1320,22 @@ namespace ARIS
         aoBlurX->SetInt("vWidth", 1600);
         aoBlurX->SetInt("vHeight", 900);
 
-        // Input/output
-        srcLoc = glGetUniformLocation(aoBlurX->m_ID, "src");
+        // Input/output (image units 0/1)
         glBindImageTexture(0, aoMap->m_ID, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA16F);
-        glUniform1i(srcLoc, 0);
-
-        dstLoc = glGetUniformLocation(aoBlurX->m_ID, "dst");
         glBindImageTexture(1, aoBlurOutputX->m_ID, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
-        glUniform1i(dstLoc, 1);
 
         // Normal, depth G-buffer textures
-        GLint nBufLoc = glGetUniformLocation(aoBlurX->m_ID, "normalBuf");
-        glBindImageTexture(2, gTextures[1]->m_ID, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA16F);
-        glUniform1i(nBufLoc, 2);
+        RenderState::ActiveTexture(2);
+        RenderState::BindTexture(GL_TEXTURE_2D, gTextures[GNormal]->m_ID);
 
-        glActiveTexture(GL_TEXTURE3);
-        glBindTexture(GL_TEXTURE_2D, gTextures[5]->m_ID);
+        RenderState::ActiveTexture(3);
+        RenderState::BindTexture(GL_TEXTURE_2D, gTextures[GDepth]->m_ID);
 
         // Dispatch
         glDispatchCompute(2048 / 128, 2048, 1);
         glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
 
-        glUseProgram(0);
+        RenderState::UseProgram(0);
 
         // Run the AO compute shader
         aoBlurY->Activate();
@@ -818,89 +1347,109 @@ namespace ARIS
         aoBlurY->SetInt("vWidth", 1600);
         aoBlurY->SetInt("vHeight", 900);
 
-        // Input/output
-        srcLoc = glGetUniformLocation(aoBlurY->m_ID, "src");
+        // Input/output (image units 0/1)
         glBindImageTexture(0, aoBlurOutputX->m_ID, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA16F);
-        glUniform1i(srcLoc, 0);
-
-        dstLoc = glGetUniformLocation(aoBlurY->m_ID, "dst");
         glBindImageTexture(1, aoBlurOutputXY->m_ID, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
-        glUniform1i(dstLoc, 1);
 
         // Normal, depth G-buffer textures
-        nBufLoc = glGetUniformLocation(aoBlurY->m_ID, "normalBuf");
-        glBindImageTexture(2, gTextures[1]->m_ID, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA16F);
-        glUniform1i(nBufLoc, 2);
+        RenderState::ActiveTexture(2);
+        RenderState::BindTexture(GL_TEXTURE_2D, gTextures[GNormal]->m_ID);
 
-        glActiveTexture(GL_TEXTURE3);
-        glBindTexture(GL_TEXTURE_2D, gTextures[5]->m_ID);
+        RenderState::ActiveTexture(3);
+        RenderState::BindTexture(GL_TEXTURE_2D, gTextures[GDepth]->m_ID);
 
         // Dispatch
         glDispatchCompute(2048, 2048 / 128, 1);
         glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
 
-        glUseProgram(0);
+        RenderState::UseProgram(0);
         // --------------
 
+        // Bin the visible point lights into clusters for the lighting pass
+        m_LocalLightTimer.Begin();
+
+        if (useClusteredLights)
+        {
+            m_ClusterLights.clear();
+            m_CullStats.s_LightsCulled = 0;
+
+            auto view = m_Registry.view<TransformComponent, PointLightComponent>();
+            for (auto entity : view)
+            {
+                auto [transform, light] = view.get<TransformComponent, PointLightComponent>(entity);
+
+                glm::vec3 center = transform.GetWorldTranslation();
+                if (useFrustumCulling && !cameraFrustum.Intersects(center, light.GetRange()))
+                {
+                    ++m_CullStats.s_LightsCulled;
+                    continue;
+                }
+
+                m_ClusterLights.push_back({ glm::vec4(center, light.GetRange()),
+                    glm::vec4(glm::vec3(light.GetColor()), light.GetIntensity()) });
+            }
+
+            m_CullStats.s_LightsVisible = static_cast<unsigned>(m_ClusterLights.size());
+
+            m_LightClusters.SetLights(m_ClusterLights);
+            m_LightClusters.Cull(editorCam.GetViewMatrix(), editorCam.GetProjection(),
+                editorCam.GetNearClip(), editorCam.GetFarClip());
+        }
+
         // Render the scene normally
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        glEnable(GL_CULL_FACE);
-        glCullFace(GL_BACK);
-        glEnable(GL_DEPTH_TEST);
-        glDisable(GL_BLEND);
+        RenderState::Enable(GL_CULL_FACE);
+        RenderState::CullFace(GL_BACK);
+        RenderState::Enable(GL_DEPTH_TEST);
+        RenderState::Disable(GL_BLEND);
 
         lightingPass->Activate();
 
-        // G-Buffer textures
-        for (unsigned i = 0; i < 6; ++i)
+        if (m_LightingUniforms.s_Program != lightingPass->m_ID)
         {
-            glActiveTexture(GL_TEXTURE0 + i);
-            glBindTexture(GL_TEXTURE_2D, gTextures[i]->m_ID);
+            CacheLightingUniforms();
         }
 
-        glActiveTexture(GL_TEXTURE7);
-        glBindTexture(GL_TEXTURE_2D, blurOutput->m_ID);
-
-        glActiveTexture(GL_TEXTURE8);
-        if (useSH)
-        {
-            glBindTexture(GL_TEXTURE_CUBE_MAP, outputIrradiance->m_ID);
-        }
-        else
+        // G-Buffer textures
+        for (unsigned i = 0; i <= GDepth; ++i)
         {
-            glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceTex->m_ID);
+            RenderState::ActiveTexture(i);
+            RenderState::BindTexture(GL_TEXTURE_2D, gTextures[i]->m_ID);
         }
 
-        glActiveTexture(GL_TEXTURE9);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, filteredHDR->m_ID);
+        RenderState::ActiveTexture(7);
+        RenderState::BindTexture(GL_TEXTURE_2D_ARRAY, blurOutput->m_ID);
 
-        glActiveTexture(GL_TEXTURE10);
-        glBindTexture(GL_TEXTURE_2D, brdfTex->m_ID);
+        RenderState::ActiveTexture(9);
+        RenderState::BindTexture(GL_TEXTURE_CUBE_MAP, filteredHDR->m_ID);
 
-        glActiveTexture(GL_TEXTURE11);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, hdrCubemap->m_ID);
+        RenderState::ActiveTexture(10);
+        RenderState::BindTexture(GL_TEXTURE_2D, brdfTex->m_ID);
 
+        RenderState::ActiveTexture(11);
+        RenderState::BindTexture(GL_TEXTURE_CUBE_MAP, hdrCubemap->m_ID);
 
-        glActiveTexture(GL_TEXTURE12);
+
+        RenderState::ActiveTexture(12);
 
         if (blurAO)
         {
-            glBindTexture(GL_TEXTURE_2D, aoBlurOutputXY->m_ID);
+            RenderState::BindTexture(GL_TEXTURE_2D, aoBlurOutputXY->m_ID);
         }
         else
         {
-            glBindTexture(GL_TEXTURE_2D, aoMap->m_ID);
+            RenderState::BindTexture(GL_TEXTURE_2D, aoMap->m_ID);
         }
 
         glm::mat4 matB = glm::translate(glm::mat4(1.0f), glm::vec3(0.5f))
             * glm::scale(glm::mat4(1.0f), glm::vec3(0.5f));
 
-        float near_plane = 1.0f, far_plane = 7.5f;
-        glm::mat4 lightProjection = glm::ortho(-10.0f, 10.0f, -10.0f, 10.0f, near_plane, far_plane);
-
-        glm::mat4 lightView = glm::lookAt(glm::vec3(-2.0f, 4.0f, -1.0f),
-            glm::vec3(0.0f, 0.0f, 0.0f),
-            glm::vec3(0.0f, 1.0f, 0.0f));
+        // World to shadow texture space, per cascade
+        glm::mat4 worldToLight[ShadowCascades::MaxCascades];
+        for (uint32_t c = 0; c < m_Cascades.GetCount(); ++c)
+        {
+            worldToLight[c] = matB * m_Cascades.GetViewProjection(c);
+        }
 
         // For all lights...(TODO: correct?)
         auto lView = m_Registry.view<TransformComponent, DirectionLightComponent>();
@@ -908,67 +1457,102 @@ namespace ARIS
         {
             auto [transform, light] = lView.get<TransformComponent, DirectionLightComponent>(entity);
 
-            // Update light matrices + transform
-            transform.Update();
-            light.Update(transform.GetTranslation(), transform.GetRotation());
+            // Light matrices were already updated in the shadow pass
+            const LightingUniforms& lu = m_LightingUniforms;
 
-            lightingPass->SetInt("uShadowMap", 7);
-            lightingPass->SetMat4("worldToLightMat", matB * (lightProjection * lightView));
+            lightingPass->SetInt(lu.s_ShadowMap, 7);
+            lightingPass->SetMat4Array(lu.s_WorldToLight, worldToLight, static_cast<int>(m_Cascades.GetCount()));
+            lightingPass->SetVec4(lu.s_CascadeSplits, m_Cascades.GetSplits());
+            lightingPass->SetInt(lu.s_CascadeCount, static_cast<int>(m_Cascades.GetCount()));
+            lightingPass->SetBool(lu.s_ShowCascades, showCascades);
+            lightingPass->SetMat4(lu.s_InvViewProj, invViewProj);
 
-            lightingPass->SetInt("irradianceMap", 8);
-            lightingPass->SetInt("filteredMap", 9);
-            lightingPass->SetInt("brdfTable", 10);
-            lightingPass->SetInt("envMap", 11);
+            lightingPass->SetInt(lu.s_Filtered, 9);
+            lightingPass->SetInt(lu.s_BRDF, 10);
+            lightingPass->SetInt(lu.s_EnvMap, 11);
 
-            lightingPass->SetInt("aoMap", 12);
+            lightingPass->SetInt(lu.s_AOMap, 12);
 
-            lightingPass->SetVec3("lightDir", transform.Forward());
-            lightingPass->SetVec3("lightColor", glm::vec3(light.GetColor()));
-            lightingPass->SetVec3("viewPos", editorCam.GetPosition());
+            lightingPass->SetVec3(lu.s_LightDir, transform.Forward());
+            lightingPass->SetVec3(lu.s_LightColor, glm::vec3(light.GetColor()));
+            lightingPass->SetVec3(lu.s_ViewPos, editorCam.GetPosition());
 
-            lightingPass->SetFloat("exposure", exposure);
-            lightingPass->SetBool("useSpecular", useSpecular);
-            lightingPass->SetBool("useOcclusion", useOcclusion);
-            lightingPass->SetBool("useToneMapping", useToneMapping);
+            lightingPass->SetFloat(lu.s_Exposure, exposure);
+            lightingPass->SetBool(lu.s_UseSpecular, useSpecular);
+            lightingPass->SetBool(lu.s_UseOcclusion, useOcclusion);
+            lightingPass->SetBool(lu.s_UseToneMapping, useToneMapping);
 
-            lightingPass->SetBool("useSH", useSH);
-            lightingPass->SetBool("useOldPBRMethod", useOldPBRMethod);
+            lightingPass->SetBool(lu.s_UseOldPBR, useOldPBRMethod);
 
-            lightingPass->SetInt("vWidth", sceneWidth);
-            lightingPass->SetInt("vHeight", sceneHeight);
+            lightingPass->SetBool(lu.s_UseClustered, useClusteredLights);
+            lightingPass->SetVec4(lu.s_ClusterSlices, m_LightClusters.GetSliceParams());
+            lightingPass->SetVec2(lu.s_CameraPlanes, glm::vec2(editorCam.GetNearClip(), editorCam.GetFarClip()));
+
+            lightingPass->SetInt(lu.s_Width, sceneWidth);
+            lightingPass->SetInt(lu.s_Height, sceneHeight);
 
             RenderQuad();
         }
 
         // copy depth information from the gBuffer to the default framebuffer (for the skybox, so that it doesn't overlap the FSQ)
         // (also do it for the local lights so that they're not overlapped by the skybox)
-        glBindFramebuffer(GL_READ_FRAMEBUFFER, gBuffer->GetID());
-        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_SceneFBO->GetID()); // write to scene FBO
+        RenderState::BindFramebuffer(GL_READ_FRAMEBUFFER, gBuffer->GetID());
+        RenderState::BindFramebuffer(GL_DRAW_FRAMEBUFFER, m_SceneFBO->GetID()); // write to scene FBO
         glBlitFramebuffer(0, 0, gBuffer->GetSpecs().s_Width, gBuffer->GetSpecs().s_Height,
             0, 0, m_SceneFBO->GetSpecs().s_Width, m_SceneFBO->GetSpecs().s_Height,
             GL_DEPTH_BUFFER_BIT, GL_NEAREST);
 
-        glBindFramebuffer(GL_FRAMEBUFFER, m_SceneFBO->GetID());
+        RenderState::BindFramebuffer(GL_FRAMEBUFFER, m_SceneFBO->GetID());
 
-        glEnable(GL_CULL_FACE);
-        glCullFace(GL_FRONT);
+        RenderState::Enable(GL_CULL_FACE);
+        RenderState::CullFace(GL_FRONT);
 
-        glDisable(GL_DEPTH_TEST);
+        RenderState::Disable(GL_DEPTH_TEST);
 
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_ONE, GL_ONE);
+        RenderState::Enable(GL_BLEND);
+        RenderState::BlendFunc(GL_ONE, GL_ONE);
 
-        // Render local lights
+        // Render local lights (clustered ones were shaded in the lighting pass)
+        if (useClusteredLights)
         {
+            auto view = m_Registry.view<TransformComponent, PointLightComponent>();
+            for (auto entity : view)
+            {
+                auto [transform, light] = view.get<TransformComponent, PointLightComponent>(entity);
+                light.DrawMarker(transform.GetWorldTranslation());
+            }
+        }
+        else
+        {
+            m_CullStats.s_LightsVisible = m_CullStats.s_LightsCulled = 0;
+
             auto view = m_Registry.view<TransformComponent, PointLightComponent>();
             for (auto entity : view)
             {
                 auto [transform, light] = view.get<TransformComponent, PointLightComponent>(entity);
 
-                transform.Scale(glm::vec3(light.GetRange()));
-                transform.Update();
+                // Skip volumes that are off-screen or have no geometry in range to light
+                if (useFrustumCulling)
+                {
+                    glm::vec3 center = transform.GetWorldTranslation();
+                    bool visible = cameraFrustum.Intersects(center, light.GetRange());
+
+                    if (visible)
+                    {
+                        m_BVH.QuerySphere(center, light.GetRange(), m_QueryResults);
+                        visible = !m_QueryResults.empty();
+                        m_QueryResults.clear();
+                    }
+
+                    if (!visible)
+                    {
+                        ++m_CullStats.s_LightsCulled;
+                        continue;
+                    }
+                }
+                ++m_CullStats.s_LightsVisible;
 
-                light.UpdateShader("pos", Vector3(transform.GetTranslation()),
+                light.UpdateShader("pos", Vector3(transform.GetWorldTranslation()),
                     "color", Vector4(light.GetColor()),
                     "eyePos", Vector3(editorCam.GetPosition()),
                     "range", light.GetRange(),
@@ -976,11 +1560,14 @@ namespace ARIS
                     "vWidth", sceneWidth,
                     "vHeight", sceneHeight);
 
-                light.Draw(transform.GetTranslation(), transform.GetTransform(), 
+                light.Draw(transform.GetWorldTranslation(), transform.GetTransform(), 
                     editorCam.GetViewMatrix(), editorCam.GetProjection());
             }
         }
 
+        m_LocalLightTimer.End();
+        UpdateLightSweep();
+
         RenderHDRMap(editorCam.GetViewMatrix(), editorCam.GetProjection());
 
         // Render directional lights
@@ -990,7 +1577,7 @@ namespace ARIS
             {
                 auto [transform, light] = view.get<TransformComponent, DirectionLightComponent>(entity);
 
-                light.Draw(transform.GetTranslation(), transform.Forward(), lightProjection, lightView);
+                light.Draw(transform.GetWorldTranslation(), transform.Forward(), light.GetProjectionMatrix(), light.GetViewMatrix());
             }
         }
 
@@ -1038,6 +1625,256 @@ namespace ARIS
         PostRender();
     }
 
+    void Scene::CacheLightingUniforms()
+    {
+        LightingUniforms& lu = m_LightingUniforms;
+        lu.s_Program = lightingPass->m_ID;
+
+        lu.s_ShadowMap = lightingPass->GetHandle("uShadowMap");
+        lu.s_WorldToLight = lightingPass->GetHandle("worldToLightMat");
+        lu.s_CascadeSplits = lightingPass->GetHandle("cascadeSplits");
+        lu.s_CascadeCount = lightingPass->GetHandle("cascadeCount");
+        lu.s_ShowCascades = lightingPass->GetHandle("showCascades");
+        lu.s_InvViewProj = lightingPass->GetHandle("invViewProj");
+
+        lu.s_Filtered = lightingPass->GetHandle("filteredMap");
+        lu.s_BRDF = lightingPass->GetHandle("brdfTable");
+        lu.s_EnvMap = lightingPass->GetHandle("envMap");
+        lu.s_AOMap = lightingPass->GetHandle("aoMap");
+
+        lu.s_LightDir = lightingPass->GetHandle("lightDir");
+        lu.s_LightColor = lightingPass->GetHandle("lightColor");
+        lu.s_ViewPos = lightingPass->GetHandle("viewPos");
+
+        lu.s_Exposure = lightingPass->GetHandle("exposure");
+        lu.s_UseSpecular = lightingPass->GetHandle("useSpecular");
+        lu.s_UseOcclusion = lightingPass->GetHandle("useOcclusion");
+        lu.s_UseToneMapping = lightingPass->GetHandle("useToneMapping");
+
+        lu.s_UseOldPBR = lightingPass->GetHandle("useOldPBRMethod");
+
+        lu.s_UseClustered = lightingPass->GetHandle("useClusteredLights");
+        lu.s_ClusterSlices = lightingPass->GetHandle("clusterSlices");
+        lu.s_CameraPlanes = lightingPass->GetHandle("cameraPlanes");
+
+        lu.s_Width = lightingPass->GetHandle("vWidth");
+        lu.s_Height = lightingPass->GetHandle("vHeight");
+    }
+
+    // Times the lighting pass uniform block (one directional light) three ways
+    void Scene::ProfileUniformUploads()
+    {
+        const int iterations = 1000;
+
+        const GLuint id = lightingPass->m_ID;
+        const glm::mat4 mat = glm::mat4(1.0f);
+        const glm::vec3 vec = glm::vec3(0.0f);
+        const glm::vec4 slices = glm::vec4(0.0f);
+
+        if (m_LightingUniforms.s_Program != id)
+        {
+            CacheLightingUniforms();
+        }
+
+        lightingPass->Activate();
+        glFinish();
+
+        // Before: a driver query per set
+        Timer t;
+        for (int i = 0; i < iterations; ++i)
+        {
+            glUniform1i(glGetUniformLocation(id, "uShadowMap"), 7);
+            glUniformMatrix4fv(glGetUniformLocation(id, "worldToLightMat"), 1, GL_FALSE, glm::value_ptr(mat));
+            glUniformMatrix4fv(glGetUniformLocation(id, "invViewProj"), 1, GL_FALSE, glm::value_ptr(mat));
+            glUniform1i(glGetUniformLocation(id, "filteredMap"), 9);
+            glUniform1i(glGetUniformLocation(id, "brdfTable"), 10);
+            glUniform1i(glGetUniformLocation(id, "envMap"), 11);
+            glUniform1i(glGetUniformLocation(id, "aoMap"), 12);
+            glUniform3fv(glGetUniformLocation(id, "lightDir"), 1, &vec[0]);
+            glUniform3fv(glGetUniformLocation(id, "lightColor"), 1, &vec[0]);
+            glUniform3fv(glGetUniformLocation(id, "viewPos"), 1, &vec[0]);
+            glUniform1f(glGetUniformLocation(id, "exposure"), exposure);
+            glUniform1i(glGetUniformLocation(id, "useSpecular"), useSpecular);
+            glUniform1i(glGetUniformLocation(id, "useOcclusion"), useOcclusion);
+            glUniform1i(glGetUniformLocation(id, "useToneMapping"), useToneMapping);
+            glUniform1i(glGetUniformLocation(id, "useOldPBRMethod"), useOldPBRMethod);
+            glUniform1i(glGetUniformLocation(id, "useClusteredLights"), useClusteredLights);
+            glUniform4fv(glGetUniformLocation(id, "clusterSlices"), 1, &slices[0]);
+            glUniform1i(glGetUniformLocation(id, "vWidth"), 1600);
+            glUniform1i(glGetUniformLocation(id, "vHeight"), 900);
+        }
+        glFinish();
+        m_UniformProfile[0] = t.ElapsedMillis() * 1000.0f / iterations;
+
+        // Cached table lookup by name
+        t.Reset();
+        for (int i = 0; i < iterations; ++i)
+        {
+            lightingPass->SetInt("uShadowMap", 7);
+            lightingPass->SetMat4("worldToLightMat", mat);
+            lightingPass->SetMat4("invViewProj", mat);
+            lightingPass->SetInt("filteredMap", 9);
+            lightingPass->SetInt("brdfTable", 10);
+            lightingPass->SetInt("envMap", 11);
+            lightingPass->SetInt("aoMap", 12);
+            lightingPass->SetVec3("lightDir", vec);
+            lightingPass->SetVec3("lightColor", vec);
+            lightingPass->SetVec3("viewPos", vec);
+            lightingPass->SetFloat("exposure", exposure);
+            lightingPass->SetBool("useSpecular", useSpecular);
+            lightingPass->SetBool("useOcclusion", useOcclusion);
+            lightingPass->SetBool("useToneMapping", useToneMapping);
+            lightingPass->SetBool("useOldPBRMethod", useOldPBRMethod);
+            lightingPass->SetBool("useClusteredLights", useClusteredLights);
+            lightingPass->SetVec4("clusterSlices", slices);
+            lightingPass->SetInt("vWidth", 1600);
+            lightingPass->SetInt("vHeight", 900);
+        }
+        glFinish();
+        m_UniformProfile[1] = t.ElapsedMillis() * 1000.0f / iterations;
+
+        // Pre-resolved handles (what the lighting pass uses)
+        const LightingUniforms& lu = m_LightingUniforms;
+
+        t.Reset();
+        for (int i = 0; i < iterations; ++i)
+        {
+            lightingPass->SetInt(lu.s_ShadowMap, 7);
+            lightingPass->SetMat4(lu.s_WorldToLight, mat);
+            lightingPass->SetMat4(lu.s_InvViewProj, mat);
+            lightingPass->SetInt(lu.s_Filtered, 9);
+            lightingPass->SetInt(lu.s_BRDF, 10);
+            lightingPass->SetInt(lu.s_EnvMap, 11);
+            lightingPass->SetInt(lu.s_AOMap, 12);
+            lightingPass->SetVec3(lu.s_LightDir, vec);
+            lightingPass->SetVec3(lu.s_LightColor, vec);
+            lightingPass->SetVec3(lu.s_ViewPos, vec);
+            lightingPass->SetFloat(lu.s_Exposure, exposure);
+            lightingPass->SetBool(lu.s_UseSpecular, useSpecular);
+            lightingPass->SetBool(lu.s_UseOcclusion, useOcclusion);
+            lightingPass->SetBool(lu.s_UseToneMapping, useToneMapping);
+            lightingPass->SetBool(lu.s_UseOldPBR, useOldPBRMethod);
+            lightingPass->SetBool(lu.s_UseClustered, useClusteredLights);
+            lightingPass->SetVec4(lu.s_ClusterSlices, slices);
+            lightingPass->SetInt(lu.s_Width, 1600);
+            lightingPass->SetInt(lu.s_Height, 900);
+        }
+        glFinish();
+        m_UniformProfile[2] = t.ElapsedMillis() * 1000.0f / iterations;
+
+        RenderState::UseProgram(0);
+    }
+
+    void Scene::SpawnBenchmarkLights(unsigned count)
+    {
+        BoundingBox bounds = m_BVH.GetRootBounds();
+        if (m_BVH.GetLeafCount() == 0)
+        {
+            bounds = { glm::vec3(-10.0f), glm::vec3(10.0f) };
+        }
+
+        // ranges scale with the scene so the per-cluster density stays comparable
+        float baseRange = glm::length(bounds.s_Max - bounds.s_Min) * 0.05f;
+
+        m_BenchmarkLights.reserve(m_BenchmarkLights.size() + count);
+        for (unsigned i = 0; i < count; ++i)
+        {
+            Entity e = CreateEntity("Benchmark Light");
+
+            e.GetComponent<TransformComponent>().Translate(glm::vec3(
+                RandomNum(bounds.s_Min.x, bounds.s_Max.x),
+                RandomNum(bounds.s_Min.y, bounds.s_Max.y),
+                RandomNum(bounds.s_Min.z, bounds.s_Max.z)));
+
+            auto& light = e.AddComponent<PointLightComponent>();
+            light.SetColor(glm::vec4(RandomNum(0.2f, 1.0f), RandomNum(0.2f, 1.0f), RandomNum(0.2f, 1.0f), 1.0f));
+            light.SetRange(baseRange * RandomNum(0.5f, 1.5f));
+
+            m_BenchmarkLights.push_back(e);
+        }
+    }
+
+    void Scene::ClearBenchmarkLights()
+    {
+        for (entt::entity e : m_BenchmarkLights)
+        {
+            if (m_Registry.valid(e))
+            {
+                DestroyEntity({ e, this });
+            }
+        }
+
+        m_BenchmarkLights.clear();
+    }
+
+    // Light counts measured by the sweep, each with volumes and then clustered
+    static constexpr unsigned s_SweepCounts[] = { 64, 256, 1024, 2048, 4096 };
+
+    void Scene::StartLightSweep()
+    {
+        LightSweep& sweep = m_LightSweep;
+
+        sweep = LightSweep();
+        sweep.s_Running = true;
+        sweep.s_WasClustered = useClusteredLights;
+
+        useClusteredLights = false;
+
+        ClearBenchmarkLights();
+        SpawnBenchmarkLights(s_SweepCounts[0]);
+        sweep.s_Results.push_back(glm::vec3(static_cast<float>(s_SweepCounts[0]), 0.0f, 0.0f));
+    }
+
+    void Scene::UpdateLightSweep()
+    {
+        static constexpr unsigned s_StepCount = 2 * (sizeof(s_SweepCounts) / sizeof(s_SweepCounts[0]));
+
+        // the timer lags a frame or two, and the first frames after a switch are noisy
+        static constexpr unsigned s_Warmup = 10, s_Measured = 30;
+
+        LightSweep& sweep = m_LightSweep;
+        if (!sweep.s_Running)
+        {
+            return;
+        }
+
+        if (sweep.s_Frame >= s_Warmup)
+        {
+            sweep.s_TotalMs += m_LocalLightTimer.GetMilliseconds();
+        }
+
+        if (++sweep.s_Frame < s_Warmup + s_Measured)
+        {
+            return;
+        }
+
+        // step finished: even steps are light volumes, odd ones clustered
+        glm::vec3& result = sweep.s_Results[sweep.s_Step / 2];
+        result[1 + sweep.s_Step % 2] = sweep.s_TotalMs / s_Measured;
+
+        sweep.s_Frame = 0;
+        sweep.s_TotalMs = 0.0f;
+
+        if (++sweep.s_Step == s_StepCount)
+        {
+            sweep.s_Running = false;
+            useClusteredLights = sweep.s_WasClustered;
+            ClearBenchmarkLights();
+            return;
+        }
+
+        unsigned count = s_SweepCounts[sweep.s_Step / 2];
+        useClusteredLights = sweep.s_Step % 2 == 1;
+
+        // a new count starts from the volume pass
+        if (!useClusteredLights)
+        {
+            ClearBenchmarkLights();
+            SpawnBenchmarkLights(count);
+            sweep.s_Results.push_back(glm::vec3(static_cast<float>(count), 0.0f, 0.0f));
+        }
+    }
+
     void Scene::OnImGuiRender()
     {
         ImGui::Begin("Lighting");
@@ -1050,32 +1887,58 @@ namespace ARIS
         
         ImGui::PushItemWidth(100.0f);
         ImGui::SliderInt("Gaussian Weight", &gaussianWeight, 1, 50);
+
+        int cascadeCount = static_cast<int>(m_CascadeSettings.s_Count);
+        if (ImGui::SliderInt("Cascades", &cascadeCount, 1, static_cast<int>(ShadowCascades::MaxCascades)))
+        {
+            m_CascadeSettings.s_Count = static_cast<uint32_t>(cascadeCount);
+        }
+        ImGui::SliderFloat("Shadow Distance", &m_CascadeSettings.s_Distance, 5.0f, 200.0f);
+        ImGui::SliderFloat("Split Lambda", &m_CascadeSettings.s_SplitLambda, 0.0f, 1.0f);
         ImGui::PopItemWidth();
 
+        ImGui::Checkbox("Show Cascades", &showCascades);
+        ImGui::Checkbox("Cache Static Shadows", &useShadowCache);
+        ImGui::Text("Cascades: %u re-rendered / %u composed / %u reused", 
+            m_ShadowStats.s_Rendered, m_ShadowStats.s_Composed, m_ShadowStats.s_Reused);
+        ImGui::Text("Shadow pass: %.3f ms (GPU), %zu moving casters", 
+            m_ShadowTimer.GetMilliseconds(), m_MovingCasters.size());
+        ImGui::Text("Splits: %.1f / %.1f / %.1f / %.1f", m_Cascades.GetSplits().x, m_Cascades.GetSplits().y,
+            m_Cascades.GetSplits().z, m_Cascades.GetSplits().w);
+
         ImGui::Separator();
 
         ImGui::Text("PBR / IBL");
         ImGui::Checkbox("Use Old PBR Method", &useOldPBRMethod);
-        ImGui::SameLine();
-        ImGui::Checkbox("Use SH Method", &useSH);
 
         ImGui::Checkbox("Display Irradiance Skybox", &displayIrr);
-
-        if (displayIrr && outputIrrTex)
-        {
-            ImGui::Checkbox("Display Sphere Harmonics Skybox", &displayIrrSH);
-        }
         
         if (ImGui::Button("Reload Environment", ImVec2(128.0f, 0.0f)))
         {
             GenerateIBL();
         }
-
         ImGui::SameLine();
+        ImGui::Checkbox("Cache IBL Maps", &useIBLCache);
+        ImGui::Text("IBL maps %s in %.1f ms", m_IBLFromCache ? "loaded from cache" : "baked", m_IBLBakeMs);
+
         if (ImGui::Button("Generate Harmonics", ImVec2(128.0f, 0.0f)))
         {
             GenerateSphereHarmonics();
         }
+        ImGui::SameLine();
+        ImGui::Checkbox("Harmonics From Cubemap", &shFromCubemap);
+        ImGui::Text("SH irradiance projected in %.2f ms", m_SHMs);
+
+        if (ImGui::Button("Benchmark SH", ImVec2(128.0f, 0.0f)))
+        {
+            m_SHBenchmark = SphereHarmonics::RunBenchmark(m_EnvImage);
+        }
+        if (m_SHBenchmark.s_ProjectMs > 0.0f)
+        {
+            ImGui::Text("Projection: %.2f ms, reference: %.2f ms (%.1fx)", m_SHBenchmark.s_ProjectMs,
+                m_SHBenchmark.s_ReferenceMs, m_SHBenchmark.s_ReferenceMs / m_SHBenchmark.s_ProjectMs);
+            ImGui::Text("Max error vs. reference: %.2e", m_SHBenchmark.s_MaxError);
+        }
         
         const char* maps[] = { "Hamarikyu_Bridge", "Road_to_MonumentValley", "Newport_Loft", "Sierra_Madre", "Tropical_Beach"};
         static const char* currItem = currEnvMap.c_str();
@@ -1111,15 +1974,104 @@ namespace ARIS
                 ImVec2{ 0, 1 }, ImVec2{ 1, 0 });
         }
 
-        ImGui::Text("Sphere Harmonics texture");
-        if (outputIrrTex)
+        ImGui::Separator();
+
+        ImGui::Text("Culling");
+        ImGui::Checkbox("Frustum Culling", &useFrustumCulling);
+        ImGui::Text("Camera: %u entities, %u meshes visible / %u culled", 
+            m_CullStats.s_CameraEntities, m_CullStats.s_CameraVisible, m_CullStats.s_CameraCulled);
+        ImGui::Text("Shadows: %u entities, %u meshes visible / %u culled", 
+            m_CullStats.s_ShadowEntities, m_CullStats.s_ShadowVisible, m_CullStats.s_ShadowCulled);
+        ImGui::Text("Point Lights: %u visible / %u culled", m_CullStats.s_LightsVisible, m_CullStats.s_LightsCulled);
+
+        ImGui::Text("BVH: %u leaves, height %d, cost %.2f", 
+            m_BVH.GetLeafCount(), m_BVH.GetHeight(), m_BVH.GetCost());
+        if (ImGui::Button("Rebuild BVH", ImVec2(128.0f, 0.0f)))
         {
-            ImGui::Image((void*)(intptr_t)outputIrrTex->m_ID, ImVec2 { 300, 150 },
-                ImVec2{ 0, 1 }, ImVec2{ 1, 0 });
+            m_BVH.Rebuild();
         }
 
         ImGui::Separator();
 
+        ImGui::Text("Point Lights");
+        ImGui::Checkbox("Clustered Lighting", &useClusteredLights);
+        ImGui::Text("Local light stage: %.2f ms (GPU)", m_LocalLightTimer.GetMilliseconds());
+        ImGui::Text("Clusters: %u x %u x %u, %u lights binned", LightClusters::TilesX, LightClusters::TilesY,
+            LightClusters::Slices, useClusteredLights ? m_LightClusters.GetLightCount() : 0u);
+
+        ImGui::PushItemWidth(100.0f);
+        ImGui::SliderInt("Light Count", &benchmarkLightCount, 16, 4096);
+        ImGui::PopItemWidth();
+
+        if (ImGui::Button("Spawn Lights", ImVec2(128.0f, 0.0f)))
+        {
+            SpawnBenchmarkLights(static_cast<unsigned>(benchmarkLightCount));
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Clear Lights", ImVec2(128.0f, 0.0f)))
+        {
+            ClearBenchmarkLights();
+        }
+
+        if (m_LightSweep.s_Running)
+        {
+            ImGui::Text("Sweeping... (%u benchmark lights)", static_cast<unsigned>(m_BenchmarkLights.size()));
+        }
+        else if (ImGui::Button("Sweep Light Counts", ImVec2(128.0f, 0.0f)))
+        {
+            StartLightSweep();
+        }
+
+        for (const glm::vec3& r : m_LightSweep.s_Results)
+        {
+            ImGui::Text("%5d lights: volumes %.2f ms, clustered %.2f ms", static_cast<int>(r.x), r.y, r.z);
+        }
+
+        ImGui::Separator();
+
+        const RenderState::Counters& rs = RenderState::GetFrameCounters();
+        ImGui::Text("State Changes (last frame)");
+        ImGui::Text("Programs: %u, VAOs: %u, Textures: %u", rs.s_Programs, rs.s_VertexArrays, rs.s_Textures);
+        ImGui::Text("Buffers: %u, Framebuffers: %u, Viewports: %u", rs.s_Buffers, rs.s_Framebuffers, rs.s_Viewports);
+        ImGui::Text("Enable/Disable/Funcs: %u", rs.s_States);
+        ImGui::Text("Redundant binds skipped: %u", rs.s_Skipped);
+        ImGui::Text("G-Buffer material changes: %u", m_CullStats.s_MaterialChanges);
+
+        ImGui::Separator();
+
+        ImGui::Text("Transform Update");
+        int threads = m_TransformSystem.GetThreadCount();
+        if (ImGui::SliderInt("Threads", &threads, 1, omp_get_max_threads()))
+        {
+            m_TransformSystem.SetThreadCount(threads);
+        }
+        ImGui::Text("Changed this frame: %u", static_cast<unsigned>(m_TransformSystem.GetChanged().size()));
+
+        if (ImGui::Button("Benchmark 100k", ImVec2(128.0f, 0.0f)))
+        {
+            Model* sphere = ModelBuilder::CreateSphere(1.0f, 16);
+            m_TransformBenchmark = TransformSystem::Benchmark(*sphere, 100000, omp_get_max_threads());
+            delete sphere;
+        }
+        for (size_t i = 0; i < m_TransformBenchmark.size(); ++i)
+        {
+            ImGui::Text("%d threads: %.2f ms (%.2fx)", static_cast<int>(i + 1), m_TransformBenchmark[i], 
+                m_TransformBenchmark[0] / m_TransformBenchmark[i]);
+        }
+
+        ImGui::Separator();
+
+        ImGui::Text("Uniform Uploads (per frame)");
+        if (ImGui::Button("Profile Uniforms", ImVec2(128.0f, 0.0f)))
+        {
+            ProfileUniformUploads();
+        }
+        ImGui::Text("Uncached: %.2f us", m_UniformProfile[0]);
+        ImGui::Text("Cached Names: %.2f us", m_UniformProfile[1]);
+        ImGui::Text("Handles: %.2f us", m_UniformProfile[2]);
+
+        ImGui::Separator();
+
         ImGui::Text("Ambient Occlusion");
         ImGui::Checkbox("Blur Occlusion", &blurAO);
 
@@ -1147,72 +2099,65 @@ namespace ARIS
         int sceneWidth = m_SceneFBO->GetSpecs().s_Width;
         int sceneHeight = m_SceneFBO->GetSpecs().s_Height;
 
-        glDisable(GL_CULL_FACE);
-        glCullFace(GL_BACK);
-        glEnable(GL_DEPTH_TEST);
-        glDisable(GL_BLEND);
+        RenderState::Disable(GL_CULL_FACE);
+        RenderState::CullFace(GL_BACK);
+        RenderState::Enable(GL_DEPTH_TEST);
+        RenderState::Disable(GL_BLEND);
 
         // change depth function so depth test passes when values are equal to depth buffer's content
-        glDepthFunc(GL_LEQUAL);
+        RenderState::DepthFunc(GL_LEQUAL);
 
         skyboxShader->Activate();
 
         skyboxShader->SetMat4("view", glm::mat4(glm::mat3(view)));
         skyboxShader->SetMat4("projection", proj);
 
-        glBindVertexArray(cubeVAO);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, skybox->m_ID);
+        RenderState::BindVertexArray(cubeVAO);
+        RenderState::ActiveTexture(0);
+        RenderState::BindTexture(GL_TEXTURE_CUBE_MAP, skybox->m_ID);
 
         glDrawArrays(GL_TRIANGLES, 0, 36);
-        glBindVertexArray(0);
-        glDepthFunc(GL_LESS); // set depth function back to default
+        RenderState::BindVertexArray(0);
+        RenderState::DepthFunc(GL_LESS); // set depth function back to default
 
-        glUseProgram(0);
+        RenderState::UseProgram(0);
 
-        glDepthFunc(GL_LESS);
+        RenderState::DepthFunc(GL_LESS);
     }
 
     void Scene::RenderQuad()
     {
-        glBindVertexArray(quadVAO);
+        RenderState::BindVertexArray(quadVAO);
         glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-        glBindVertexArray(0);
+        RenderState::BindVertexArray(0);
     }
 
     void Scene::RenderHDRMap(glm::mat4 view, glm::mat4 proj)
     {
-        glDisable(GL_CULL_FACE);
-        glCullFace(GL_BACK);
-        glEnable(GL_DEPTH_TEST);
-        glDisable(GL_BLEND);
+        RenderState::Disable(GL_CULL_FACE);
+        RenderState::CullFace(GL_BACK);
+        RenderState::Enable(GL_DEPTH_TEST);
+        RenderState::Disable(GL_BLEND);
 
         // change depth function so depth test passes when values are equal to depth buffer's content
-        glDepthFunc(GL_LEQUAL);
+        RenderState::DepthFunc(GL_LEQUAL);
 
         hdrEnvironment->Activate();
 
         hdrEnvironment->SetMat4("projection", proj);
         hdrEnvironment->SetMat4("view", view);
 
-        glActiveTexture(GL_TEXTURE0);
-
-        glBindTexture(GL_TEXTURE_CUBE_MAP, hdrCubemap->m_ID);
-
-        if (displayIrr && !displayIrrSH)
-        {
-            glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceTex->m_ID);
-        }
-        else if (displayIrrSH && outputIrrTex)
-        {
-            glBindTexture(GL_TEXTURE_CUBE_MAP, outputIrradiance->m_ID);
-        }
+        RenderState::ActiveTexture(0);
 
+        RenderState::BindTexture(GL_TEXTURE_CUBE_MAP, hdrCubemap->m_ID);
 
         hdrEnvironment->SetInt("environmentMap", 0);
 
-        glBindVertexArray(cubeVAO);
+        // irradiance is evaluated from the SH coefficients instead of sampled
+        hdrEnvironment->SetBool("displayIrradiance", displayIrr);
+
+        RenderState::BindVertexArray(cubeVAO);
         glDrawArrays(GL_TRIANGLES, 0, 36);
-        glBindVertexArray(0);
+        RenderState::BindVertexArray(0);
     }
 }
\ No newline at end of file
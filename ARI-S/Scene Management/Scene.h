@@ -13,12 +13,21 @@
 #include "Texture.h"
 #include "Shader.h"
 #include "UniformMemory.hpp"
+#include "InstanceBatcher.h"
+#include "Culling/BVH.h"
+#include "Culling/LightClusters.h"
+#include "ShadowCascades.h"
+#include "GpuTimer.hpp"
+#include "IBL/SphereHarmonics.hpp"
+#include "IBL/IBLCache.h"
+#include "TransformSystem.h"
 
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm.hpp>
 #include <gtc/matrix_transform.hpp>
 #include <gtx/transform.hpp>
 #include <vector>
+#include <cfloat>
 
 #include "entt.hpp"
 
@@ -41,6 +50,24 @@ namespace ARIS
         Entity FindEntityByName(std::string_view name);
         Entity FindEntityByUUID(UUID uuid);
 
+        bool IsValid(entt::entity e) const { return m_Registry.valid(e); }
+
+        // Parent child under parent (a null parent detaches it). keepWorld re-expresses
+        // the child's local transform so it stays in place; otherwise it's kept as-is.
+        void SetParent(Entity child, Entity parent, bool keepWorld = true);
+
+        // Swap in assets that finished loading in the background (see AssetLoader);
+        // they're released if the entity or its mesh is gone by then
+        void AssignModel(entt::entity e, Model* model);
+        void AssignTexture(entt::entity e, std::shared_ptr<Texture> tex);
+        Entity GetParent(Entity e);
+
+        // Nearest mesh entity hit by a ray (entt::null on a miss)
+        entt::entity Raycast(const glm::vec3& origin, const glm::vec3& dir, float maxDist = FLT_MAX);
+
+        // Raycast through a viewport position given in NDC ([-1, 1] on both axes)
+        entt::entity PickEntity(const EditorCamera& cam, const glm::vec2& ndc);
+
         int Init();
 
         void UpdateEditor(DeltaTime dt, EditorCamera& edCam);
@@ -93,6 +120,37 @@ namespace ARIS
         void GenerateIBL();
         void GenerateSphereHarmonics();
 
+        void DetachFromParent(entt::entity e);
+
+        // Recompute world matrices/bounds of dirty transforms (and their descendants)
+        void UpdateTransforms();
+
+        void UpdateBVH();
+
+        // Directional shadow pass. Each cascade keeps its static casters cached and
+        // only re-renders them when the cascade's signature changes; casters that
+        // are still moving are drawn on top of the cached layer every frame
+        void RenderShadows(EditorCamera& editorCam);
+        void DrawShadowCasters(const std::vector<uint32_t>& entities, const Frustum& frustum);
+
+        // Report how large a visible entity's textures are on screen to the texture streamer
+        // pixelScale - projection[1][1] * viewport height
+        void RequestTextureResidency(const MeshComponent& mesh, const glm::vec3& eye, float pixelScale);
+        void OnMeshConstructed(entt::registry& registry, entt::entity e);
+        void OnMeshDestroyed(entt::registry& registry, entt::entity e);
+
+        void CacheLightingUniforms();
+        void ProfileUniformUploads();
+
+        // Benchmark point lights, scattered over the scene's bounds
+        void SpawnBenchmarkLights(unsigned count);
+        void ClearBenchmarkLights();
+
+        // Time the local light stage over a range of light counts, a few dozen
+        // frames each; UpdateLightSweep advances it by a frame
+        void StartLightSweep();
+        void UpdateLightSweep();
+
         GLuint cubeVAO, cubeVBO;
         void RenderSkybox(glm::mat4 view, glm::mat4 proj);
         void RenderHDRMap(glm::mat4 view, glm::mat4 proj);
@@ -102,6 +160,112 @@ namespace ARIS
 
         LocalLight localLights[MAX_LIGHTS];
 
+        InstanceBatcher m_Batcher, m_ShadowBatcher;
+
+        TransformSystem m_TransformSystem;
+
+        // Update times (ms) per thread count from the last 100k-entity benchmark
+        std::vector<float> m_TransformBenchmark;
+
+        // SIMD projection vs. the double-precision reference, on the current environment
+        SphereHarmonics::Benchmark m_SHBenchmark;
+
+        // CPU time of the last irradiance projection + UBO upload
+        float m_SHMs = 0.0f;
+
+        // Bake parameters of the IBL maps, and how the last ones were produced
+        IBLSettings m_IBLSettings;
+        float m_IBLBakeMs = 0.0f;
+        bool m_IBLFromCache = false;
+
+        // Every MeshComponent's world bounds; refit as entities move
+        BVH m_BVH;
+        std::vector<uint32_t> m_QueryResults;
+        std::vector<std::pair<float, uint32_t>> m_RayResults;
+
+        // Point lights binned for the clustered lighting path, and the GPU time of
+        // the whole local light stage (binning, lighting pass, light volumes)
+        LightClusters m_LightClusters;
+        std::vector<ClusterLight> m_ClusterLights;
+        GpuTimer m_LocalLightTimer;
+
+        std::vector<entt::entity> m_BenchmarkLights;
+
+        // Shadow cascades of the directional light; sDepthMap/blurOutput hold one layer each
+        ShadowCascades m_Cascades;
+        CascadeSettings m_CascadeSettings;
+
+        // What a cascade's static layer was last rendered with
+        struct ShadowCache
+        {
+            glm::mat4 s_ViewProj = glm::mat4(0.0f);
+
+            // static caster ids and meshes
+            size_t s_Signature = 0;
+
+            bool s_Valid = false;
+            bool s_HadDynamic = false;
+        } m_ShadowCache[ShadowCascades::MaxCascades];
+
+        // Casters that moved within the last few frames (entity -> frame it last moved)
+        std::unordered_map<uint32_t, uint32_t> m_MovingCasters;
+        std::vector<uint32_t> m_StaticCasters, m_DynamicCasters;
+        uint32_t m_ShadowFrame = 0;
+
+        // Cascades whose moments changed since they were last blurred
+        bool m_ShadowBlurDirty[ShadowCascades::MaxCascades] = {};
+        int m_BlurredWeight = 0;
+
+        // Per-frame cascade counts: static layer re-rendered, composed, reused as is
+        struct ShadowStats
+        {
+            unsigned s_Rendered = 0, s_Composed = 0, s_Reused = 0;
+        } m_ShadowStats;
+        GpuTimer m_ShadowTimer;
+
+        // Light count sweep: every count is measured with light volumes, then clustered
+        struct LightSweep
+        {
+            bool s_Running = false;
+            bool s_WasClustered = false;
+            unsigned s_Step = 0, s_Frame = 0;
+            float s_TotalMs = 0.0f;
+
+            // x = light count, y = volumes (ms), z = clustered (ms)
+            std::vector<glm::vec3> s_Results;
+        } m_LightSweep;
+
+        // Per-frame counts after frustum culling (shadow counts summed over cascades).
+        // Entity counts come from the BVH, mesh counts from the per-mesh test after it.
+        struct CullingStats
+        {
+            unsigned s_CameraEntities = 0, s_ShadowEntities = 0;
+            unsigned s_CameraVisible = 0, s_CameraCulled = 0;
+            unsigned s_ShadowVisible = 0, s_ShadowCulled = 0;
+            unsigned s_LightsVisible = 0, s_LightsCulled = 0;
+            unsigned s_MaterialChanges = 0;
+        } m_CullStats;
+
+        // Lighting pass uniforms, re-resolved whenever the program is rebuilt
+        struct LightingUniforms
+        {
+            GLuint s_Program = 0;
+
+            UniformHandle s_ShadowMap, s_WorldToLight;
+            UniformHandle s_CascadeSplits, s_CascadeCount, s_ShowCascades;
+            UniformHandle s_InvViewProj;
+            UniformHandle s_Filtered, s_BRDF, s_EnvMap, s_AOMap;
+            UniformHandle s_LightDir, s_LightColor, s_ViewPos;
+            UniformHandle s_Exposure, s_UseSpecular, s_UseOcclusion, s_UseToneMapping;
+            UniformHandle s_UseOldPBR;
+            UniformHandle s_UseClustered, s_ClusterSlices, s_CameraPlanes;
+            UniformHandle s_Width, s_Height;
+        } m_LightingUniforms;
+
+        // Average cost of one frame's lighting uniform uploads (microseconds):
+        // uncached glGetUniformLocation, cached name lookup, pre-resolved handles
+        float m_UniformProfile[3] = { 0.0f, 0.0f, 0.0f };
+
         UniformBuffer<World>* matrixData;
         UniformBuffer<BlurKernel>* kernelData;
         UniformBuffer<Discrepancy>* hammersleyData;
@@ -116,13 +280,17 @@ namespace ARIS
         Shader* skyboxShader;
 
         // PBS + IBL
-        Shader * hdrMapping, * hdrEnvironment, * irradiance,  * mapFilter, * brdf;
+        Shader * hdrMapping, * hdrEnvironment, * mapFilter, * brdf;
 
-        // Deferred
+        // Deferred; colour targets in the geometry pass' output order, then depth.
+        // Position isn't stored, it's reconstructed from depth (see invViewProj)
+        enum GBufferTarget { GNormal = 0, GAlbedo, GMetalRough, GEntityID, GDepth };
         std::vector<Texture*> gTextures;
 
-        // Shadows
+        // Shadows; sStaticMoments caches each cascade's static casters, and sShadowDepth
+        // holds their depth plus a scratch layer (the last) for composing moving casters
         Texture* sDepthMap, * blurOutput;
+        Texture* sStaticMoments, * sShadowDepth;
 
         // AO
         Texture* aoMap, * aoBlurOutputX, * aoBlurOutputXY;
@@ -131,8 +299,10 @@ namespace ARIS
         Texture* skybox;
 
         // PBS + IBL
-        Texture* hdrTexture, * hdrCubemap, *filteredHDR, *irradianceTex, *brdfTex;
-        Texture* outputIrradiance, *outputIrrTex;
+        Texture* hdrTexture, * hdrCubemap, *filteredHDR, *brdfTex;
+
+        // Environment map decoded once; shared by the texture upload and the SH projection
+        ImageData m_EnvImage;
 
         // G-Buffer
         Framebuffer* gBuffer;
@@ -145,8 +315,5 @@ namespace ARIS
 
         std::unordered_map<std::string, Framebuffer*> m_Framebuffers;
         std::unordered_map<std::string, Texture*> m_DisplayTextures;
-
-        // Environment map buffer
-        Framebuffer* captureBuffer;
     };
 }
@@ -3,6 +3,7 @@
 
 #include "Entity.h"
 #include "ModelBuilder.h"
+#include "AssetLoader.h"
 
 #include <yaml-cpp/yaml.h>
 
@@ -126,7 +127,7 @@ namespace ARIS
 		return out;
 	}
 
-	static void SerializeEntity(YAML::Emitter& out, Entity e)
+	static void SerializeEntity(YAML::Emitter& out, Entity e, Scene* scene)
 	{
 		out << YAML::BeginMap; // Entity
 		out << YAML::Key << "Entity" << YAML::Value << e.GetUUID();
@@ -155,6 +156,20 @@ namespace ARIS
 			out << YAML::EndMap;
 		}
 
+		if (e.HasComponent<RelationshipComponent>())
+		{
+			Entity parent = scene->GetParent(e);
+			if (parent)
+			{
+				out << YAML::Key << "RelationshipComponent";
+				out << YAML::BeginMap;
+
+				out << YAML::Key << "Parent" << YAML::Value << parent.GetUUID();
+
+				out << YAML::EndMap;
+			}
+		}
+
 		if (e.HasComponent<MeshComponent>())
 		{
 			out << YAML::Key << "MeshComponent";
@@ -258,7 +273,7 @@ namespace ARIS
 				return;
 			}
 
-			SerializeEntity(out, e);
+			SerializeEntity(out, e, m_Scene.get());
 		});
 		out << YAML::EndSeq;
 		out << YAML::EndMap;
@@ -289,6 +304,9 @@ namespace ARIS
 		auto entities = data["Entities"];
 		if (entities)
 		{
+			// Parents may be listed after their children, so link once everything exists
+			std::vector<std::pair<Entity, uint64_t>> parentLinks;
+
 			for (auto e : entities)
 			{
 				uint64_t uuid = e["Entity"].as<uint64_t>();
@@ -309,6 +327,13 @@ namespace ARIS
 					t.m_Translation = tc["Translation"].as<glm::vec3>();
 					t.m_Rotation = tc["Rotation"].as<glm::vec3>();
 					t.m_Scale = tc["Scale"].as<glm::vec3>();
+					t.MarkDirty();
+				}
+
+				auto rc = e["RelationshipComponent"];
+				if (rc)
+				{
+					parentLinks.push_back({ deserializedEntity, rc["Parent"].as<uint64_t>() });
 				}
 
 				auto mc = e["MeshComponent"];
@@ -327,7 +352,16 @@ namespace ARIS
 					std::string roughTex = mc["Roughness Path"].as<std::string>();
 					std::string metalRoughTex = mc["Metal/Roughness Path"].as<std::string>();
 
-					t.m_Model = ModelBuilder::Get().LoadModel(path);
+					// Assets stream in on worker threads; the entity shows a placeholder until then
+					Scene* scene = m_Scene.get();
+					entt::entity handle = deserializedEntity;
+
+					t.SetModel(ModelBuilder::Get().CreatePlaceholder(path));
+					AssetLoader::Get().LoadModel(path, scene, 
+						[scene, handle](Model* model) { scene->AssignModel(handle, model); });
+
+					auto assignTexture = [scene, handle](std::shared_ptr<Texture> tex) { scene->AssignTexture(handle, tex); };
+
 					t.SetName(name);
 					t.m_Metalness = metal;
 					t.m_Roughness = rough;
@@ -335,12 +369,7 @@ namespace ARIS
 
 					if (diffTex != "N/A")
 					{
-						t.m_DiffuseTex = new Texture(diffTex, GL_LINEAR, GL_REPEAT, false, aiTextureType_DIFFUSE);
-						
-						for (Mesh& m : t.m_Model->m_Meshes)
-						{
-							m.m_Textures.push_back(*t.m_DiffuseTex);
-						}
+						AssetLoader::Get().LoadTexture(diffTex, aiTextureType_DIFFUSE, scene, assignTexture);
 					}
 					//else
 					//{
@@ -357,12 +386,7 @@ namespace ARIS
 
 					if (normTex != "N/A")
 					{
-						t.m_NormalTex = new Texture(normTex, GL_LINEAR, GL_REPEAT, false, aiTextureType_NORMALS);
-
-						for (Mesh& m : t.m_Model->m_Meshes)
-						{
-							m.m_Textures.push_back(*t.m_NormalTex);
-						}
+						AssetLoader::Get().LoadTexture(normTex, aiTextureType_NORMALS, scene, assignTexture);
 					}
 					//else
 					//{
@@ -379,12 +403,7 @@ namespace ARIS
 
 					if (metTex != "N/A")
 					{
-						t.m_MetallicTex = new Texture(metTex, GL_LINEAR, GL_REPEAT, false, aiTextureType_METALNESS);
-
-						for (Mesh& m : t.m_Model->m_Meshes)
-						{
-							m.m_Textures.push_back(*t.m_MetallicTex);
-						}
+						AssetLoader::Get().LoadTexture(metTex, aiTextureType_METALNESS, scene, assignTexture);
 					}
 					//else
 					//{
@@ -401,12 +420,7 @@ namespace ARIS
 
 					if (roughTex != "N/A")
 					{
-						t.m_RoughnessTex = new Texture(roughTex, GL_LINEAR, GL_REPEAT, false, aiTextureType_DIFFUSE_ROUGHNESS);
-
-						for (Mesh& m : t.m_Model->m_Meshes)
-						{
-							m.m_Textures.push_back(*t.m_RoughnessTex);
-						}
+						AssetLoader::Get().LoadTexture(roughTex, aiTextureType_DIFFUSE_ROUGHNESS, scene, assignTexture);
 					}
 					//else
 					//{
@@ -423,12 +437,7 @@ namespace ARIS
 
 					if (metalRoughTex != "N/A")
 					{
-						t.m_MetalRoughTex = new Texture(metalRoughTex, GL_LINEAR, GL_REPEAT, false, aiTextureType_UNKNOWN);
-
-						for (Mesh& m : t.m_Model->m_Meshes)
-						{
-							m.m_Textures.push_back(Texture(metalRoughTex, GL_LINEAR, GL_REPEAT, false, aiTextureType_UNKNOWN));
-						}
+						AssetLoader::Get().LoadTexture(metalRoughTex, aiTextureType_UNKNOWN, scene, assignTexture);
 					}
 					//else
 					//{
@@ -478,6 +487,12 @@ namespace ARIS
 					//t.ReloadShader();
 				}
 			}
+
+			// Serialized transforms are already local to the parent
+			for (auto& [child, parentID] : parentLinks)
+			{
+				m_Scene->SetParent(child, m_Scene->FindEntityByUUID(parentID), false);
+			}
 		}
 
 		return true;
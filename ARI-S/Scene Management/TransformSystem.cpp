@@ -0,0 +1,141 @@
+#include <arpch.h>
+#include "TransformSystem.h"
+
+#include "TransformComponent.hpp"
+#include "RelationshipComponent.hpp"
+#include "MeshComponent.hpp"
+#include "Timer.h"
+
+#include <omp.h>
+
+namespace ARIS
+{
+	// Roots handed to a worker at a time; small enough to balance deep hierarchies
+	static constexpr int s_ChunkSize = 256;
+
+	TransformSystem::TransformSystem()
+		: m_ThreadCount(omp_get_max_threads())
+	{
+	}
+
+	void TransformSystem::Update(entt::registry& registry)
+	{
+		// Fetch the pools up front; workers only read/write existing components
+		auto& transforms = registry.storage<TransformComponent>();
+		auto& relations = registry.storage<RelationshipComponent>();
+		auto& meshes = registry.storage<MeshComponent>();
+
+		int threads = std::max(1, std::min(m_ThreadCount, omp_get_max_threads()));
+
+		m_ThreadChanged.resize(threads);
+		m_ThreadStacks.resize(threads);
+		for (std::vector<entt::entity>& changed : m_ThreadChanged)
+		{
+			changed.clear();
+		}
+
+		const entt::entity* entities = transforms.data();
+		const int count = static_cast<int>(transforms.size());
+
+		#pragma omp parallel num_threads(threads)
+		{
+			std::vector<entt::entity>& changed = m_ThreadChanged[omp_get_thread_num()];
+			std::vector<std::pair<entt::entity, bool>>& stack = m_ThreadStacks[omp_get_thread_num()];
+
+			#pragma omp for schedule(dynamic, s_ChunkSize)
+			for (int i = 0; i < count; ++i)
+			{
+				entt::entity root = entities[i];
+				if (relations.contains(root) && relations.get(root).s_Parent != entt::null)
+					continue;
+
+				// Parents resolve before their children; a node is recomputed
+				// if it's dirty or anything above it was
+				stack.push_back({ root, false });
+
+				while (!stack.empty())
+				{
+					auto [entity, parentChanged] = stack.back();
+					stack.pop_back();
+
+					TransformComponent& transform = transforms.get(entity);
+					const RelationshipComponent* rel = relations.contains(entity) ? &relations.get(entity) : nullptr;
+
+					bool dirty = parentChanged || transform.IsDirty();
+					if (dirty)
+					{
+						if (rel && rel->s_Parent != entt::null)
+							transform.Update(transforms.get(rel->s_Parent).GetTransform());
+						else
+							transform.Update();
+
+						if (meshes.contains(entity))
+							meshes.get(entity).Update(transform.GetTransform());
+
+						changed.push_back(entity);
+					}
+
+					if (!rel)
+						continue;
+
+					for (entt::entity child = rel->s_FirstChild; child != entt::null;
+						child = relations.get(child).s_NextSibling)
+					{
+						stack.push_back({ child, dirty });
+					}
+				}
+			}
+		}
+
+		m_Changed.clear();
+		for (const std::vector<entt::entity>& changed : m_ThreadChanged)
+		{
+			m_Changed.insert(m_Changed.end(), changed.begin(), changed.end());
+		}
+	}
+
+	std::vector<float> TransformSystem::Benchmark(const Model& model, unsigned count, int maxThreads)
+	{
+		const int iterations = 5;
+
+		// Flat synthetic scene, every entity sharing one model
+		entt::registry registry;
+		for (unsigned i = 0; i < count; ++i)
+		{
+			entt::entity e = registry.create();
+
+			TransformComponent& t = registry.emplace<TransformComponent>(e);
+			t.Translate(glm::vec3(rand() % 1000, rand() % 1000, rand() % 1000) * 0.1f);
+			t.Rotate(glm::vec3(rand() % 628, rand() % 628, rand() % 628) * 0.01f);
+
+			registry.emplace<MeshComponent>(e, model);
+		}
+
+		auto view = registry.view<TransformComponent>();
+
+		std::vector<float> results;
+		TransformSystem system;
+
+		for (int threads = 1; threads <= maxThreads; ++threads)
+		{
+			system.SetThreadCount(threads);
+
+			float total = 0.0f;
+			for (int i = 0; i < iterations; ++i)
+			{
+				for (auto e : view)
+				{
+					view.get<TransformComponent>(e).MarkDirty();
+				}
+
+				Timer timer;
+				system.Update(registry);
+				total += timer.ElapsedMillis();
+			}
+
+			results.push_back(total / iterations);
+		}
+
+		return results;
+	}
+}
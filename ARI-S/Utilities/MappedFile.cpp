@@ -0,0 +1,96 @@
+#include <arpch.h>
+#include "MappedFile.h"
+
+namespace ARIS
+{
+	MappedFile::MappedFile(const std::string& path)
+	{
+		Open(path);
+	}
+
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+	bool MappedFile::Open(const std::string& path)
+	{
+		Close();
+
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping == nullptr)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (view == nullptr)
+		{
+			CloseHandle(mapping);
+			CloseHandle(file);
+			return false;
+		}
+
+		m_File = file;
+		m_Mapping = mapping;
+		m_Data = static_cast<const uint8_t*>(view);
+		m_Size = static_cast<size_t>(size.QuadPart);
+
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (m_Data)
+		{
+			UnmapViewOfFile(m_Data);
+		}
+		if (m_Mapping)
+		{
+			CloseHandle(m_Mapping);
+		}
+		if (m_File)
+		{
+			CloseHandle(m_File);
+		}
+
+		m_Data = nullptr;
+		m_Size = 0;
+		m_Mapping = nullptr;
+		m_File = nullptr;
+	}
+
+	uint64_t MappedFile::HashContents(const std::string& path)
+	{
+		MappedFile file(path);
+		if (!file.IsOpen())
+		{
+			return 0;
+		}
+
+		uint64_t hash = 0xcbf29ce484222325ull;
+		const uint8_t* data = file.GetData();
+		for (size_t i = 0; i < file.GetSize(); ++i)
+		{
+			hash ^= data[i];
+			hash *= 0x100000001b3ull;
+		}
+
+		return hash;
+	}
+}
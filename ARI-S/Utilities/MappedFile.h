@@ -0,0 +1,41 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <string>
+#include <cstdint>
+
+namespace ARIS
+{
+	// Read-only memory mapping of a whole file. Pages are faulted in by the OS
+	// as they're touched, so nothing is copied until the data is used.
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		MappedFile(const std::string& path);
+		~MappedFile();
+
+		MappedFile(const MappedFile& other) = delete;
+		MappedFile& operator=(const MappedFile& other) = delete;
+
+		bool Open(const std::string& path);
+		void Close();
+
+		bool IsOpen() const { return m_Data != nullptr; }
+
+		const uint8_t* GetData() const { return m_Data; }
+		size_t GetSize() const { return m_Size; }
+
+		// FNV-1a over a file's contents (0 if it can't be read); used to validate derived caches
+		static uint64_t HashContents(const std::string& path);
+
+	private:
+		const uint8_t* m_Data = nullptr;
+		size_t m_Size = 0;
+
+		void* m_File = nullptr;
+		void* m_Mapping = nullptr;
+	};
+}
+
+#endif